@@ -0,0 +1,232 @@
+#include "allocTracker.h"
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    std::atomic<bool> tracking{ false };
+    std::atomic<unsigned long long> process_allocations{ 0 };
+    std::atomic<unsigned long long> process_allocated{ 0 };
+    std::atomic<long long> process_live{ 0 };
+    std::atomic<long long> process_peak{ 0 };
+
+    // trivial so operator new never runs thread local constructors
+    class threadUsage {
+    public:
+        unsigned long long allocations;
+        unsigned long long allocated;
+        long long live;
+        long long peak;
+    };
+    thread_local threadUsage local = { 0, 0, 0, 0 };
+
+    // malloc backed so the block registry never calls back into operator new
+    template <typename T>
+    class mallocAllocator {
+    public:
+        typedef T value_type;
+
+        mallocAllocator() = default;
+        template <typename U> mallocAllocator(const mallocAllocator<U>&) {}
+
+        T* allocate(std::size_t n)
+        {
+            void* p = std::malloc(n * sizeof(T));
+            if (p == nullptr) throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+        void deallocate(T* p, std::size_t) { std::free(p); }
+
+        template <typename U> bool operator==(const mallocAllocator<U>&) const { return true; }
+        template <typename U> bool operator!=(const mallocAllocator<U>&) const { return false; }
+    };
+
+    // sizes of blocks counted since enable(), only those lower live bytes when freed, blocks allocated
+    // before enable() or by a module with its own operator new are freed here without touching the counters
+    class countedBlocks {
+    public:
+        std::mutex mutex;
+        std::unordered_map<void*, long long, std::hash<void*>, std::equal_to<void*>, mallocAllocator<std::pair<void* const, long long>>> sizes;
+    };
+    const size_t block_shards = 64;
+    countedBlocks* blocks = nullptr; // made by enable() and never destroyed, frees come until the process exits
+
+    countedBlocks& shardOf(void* p)
+    {
+        return blocks[(reinterpret_cast<std::uintptr_t>(p) >> 4) % block_shards];
+    }
+
+    size_t usableSize(void* p)
+    {
+#ifdef _WIN32
+        return _msize(p);
+#elif defined(__APPLE__)
+        return malloc_size(p);
+#else
+        return malloc_usable_size(p);
+#endif
+    }
+
+    void counted(void* p)
+    {
+        const long long size = static_cast<long long>(usableSize(p));
+        countedBlocks& shard = shardOf(p);
+        try {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.sizes[p] = size;
+        }
+        catch (std::bad_alloc&) {
+            return; // left uncounted, its free will not be subtracted either
+        }
+        local.allocations += 1;
+        local.allocated += size;
+        local.live += size;
+        if (local.live > local.peak) local.peak = local.live;
+
+        process_allocations.fetch_add(1, std::memory_order_relaxed);
+        process_allocated.fetch_add(size, std::memory_order_relaxed);
+        const long long live = process_live.fetch_add(size, std::memory_order_relaxed) + size;
+        long long peak = process_peak.load(std::memory_order_relaxed);
+        while (live > peak && !process_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+    }
+
+    void uncounted(void* p)
+    {
+        long long size = 0;
+        {
+            countedBlocks& shard = shardOf(p);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto found = shard.sizes.find(p);
+            if (found == shard.sizes.end()) return;
+            size = found->second;
+            shard.sizes.erase(found);
+        }
+        local.live -= size;
+        process_live.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    void* allocate(std::size_t size)
+    {
+        if (size == 0) size = 1;
+        void* p;
+        while ((p = std::malloc(size)) == nullptr) {
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) throw std::bad_alloc();
+            handler();
+        }
+        if (tracking.load(std::memory_order_relaxed)) counted(p);
+        return p;
+    }
+
+    void deallocate(void* p)
+    {
+        if (p == nullptr) return;
+        if (tracking.load(std::memory_order_relaxed)) uncounted(p);
+        std::free(p);
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); }
+    catch (std::bad_alloc&) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); }
+    catch (std::bad_alloc&) { return nullptr; }
+}
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+
+void alloc_tracker::enable()
+{
+    static std::once_flag registry_made;
+    std::call_once(registry_made, [] {
+        void* memory = std::malloc(sizeof(countedBlocks) * block_shards);
+        if (memory == nullptr) throw std::bad_alloc();
+        countedBlocks* shards = static_cast<countedBlocks*>(memory);
+        for (size_t i = 0; i < block_shards; ++i) new (shards + i) countedBlocks();
+        blocks = shards;
+    });
+    tracking = true;
+}
+
+bool alloc_tracker::enabled()
+{
+    return tracking.load(std::memory_order_relaxed);
+}
+
+alloc_tracker::mark alloc_tracker::begin()
+{
+    mark m;
+    m.allocations = local.allocations;
+    m.allocated = local.allocated;
+    m.live = local.live;
+    m.outer_peak = local.peak;
+    local.peak = local.live;
+    return m;
+}
+
+alloc_tracker::usage alloc_tracker::end(const mark& m)
+{
+    usage u;
+    u.allocations = local.allocations - m.allocations;
+    u.allocated = local.allocated - m.allocated;
+    u.peak = local.peak > m.live ? static_cast<unsigned long long>(local.peak - m.live) : 0;
+    if (m.outer_peak > local.peak) local.peak = m.outer_peak;
+    return u;
+}
+
+alloc_tracker::usage alloc_tracker::process()
+{
+    usage u;
+    u.allocations = process_allocations.load(std::memory_order_relaxed);
+    u.allocated = process_allocated.load(std::memory_order_relaxed);
+    const long long peak = process_peak.load(std::memory_order_relaxed);
+    u.peak = peak > 0 ? static_cast<unsigned long long>(peak) : 0;
+    return u;
+}
+
+unsigned long long alloc_tracker::residentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+    return 0;
+#else
+    // second field of statm is resident pages
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) return 0;
+    unsigned long long size = 0, resident = 0;
+    const int read = std::fscanf(statm, "%llu %llu", &size, &resident);
+    std::fclose(statm);
+    if (read != 2) return 0;
+    return resident * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+#endif
+}
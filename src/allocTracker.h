@@ -0,0 +1,38 @@
+#pragma once
+
+// heap use counted by the replaced global operator new and delete, off until enable() so an allocation
+// costs one extra branch, once enabled every allocation updates counters of its thread and the process
+// and registers its block under one of 64 locks, so freeing blocks allocated before enable() leaves the counters alone,
+// bytes are usable sizes reported by the allocator, memory freed by another thread counts against that thread,
+// aligned allocations are not counted, neither are allocations of modules with their own operator new:
+// on windows the bundled assimp dll allocates through its runtime, so import memory is missing there,
+// on linux the shared library calls these operators and is counted
+class alloc_tracker {
+public:
+    // state of the calling thread when a measurement began, measurements nest
+    class mark {
+    public:
+        unsigned long long allocations = 0;
+        unsigned long long allocated = 0;
+        long long live = 0;
+        long long outer_peak = 0;
+    };
+
+    class usage {
+    public:
+        unsigned long long allocations = 0;
+        unsigned long long allocated = 0; // bytes, freed or not
+        unsigned long long peak = 0; // largest growth of live bytes, over the measurement or since enable()
+    };
+
+    alloc_tracker() = delete;
+
+    static void enable(); // before other threads allocate
+    static bool enabled();
+
+    static mark begin();
+    static usage end(const mark& m);
+    static usage process(); // every thread since enable()
+
+    static unsigned long long residentBytes(); // current resident set, 0 where unknown
+};
@@ -1,25 +1,211 @@
 #include "assimpReader.h"
 #include <assimp/Importer.hpp>
+#include <assimp/DefaultLogger.hpp>
+#include <assimp/LogStream.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <cstdlib>
+#include "mappedIOSystem.h"
+#include "profiler.h"
+
+namespace {
+
+    std::mutex stats_mutex;
+    assimp::importerStats stats;
+
+    // constructing an importer registers every loader and post processing step,
+    // so each thread builds one on first use and keeps it until it exits
+    class threadImporter {
+    public:
+        std::unique_ptr<Assimp::Importer> importer;
+
+        ~threadImporter()
+        {
+            if (!importer) return;
+            const auto start{ std::chrono::steady_clock::now() };
+            importer.reset();
+            const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stats.teardown_seconds += elapsed_seconds.count();
+        }
+    };
+
+    thread_local threadImporter thread_importer;
+
+    // with AI_CONFIG_GLOB_MEASURE_TIME assimp wraps every post processing step in START / END `postprocess`
+    // debug messages and the step logs "<name> begin" in between, messages come on the importing thread
+    class stepTimes : public Assimp::LogStream {
+    public:
+        void write(const char* message) override
+        {
+            thread_local std::string step;
+            thread_local double cpu_start = 0.0;
+
+            std::string text(message);
+            const size_t prefix = text.find(": "); // "Debug, T0: "
+            if (prefix != std::string::npos) text = text.substr(prefix + 2);
+            while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) text.pop_back();
+
+            if (text.rfind("START `postprocess`", 0) == 0) {
+                step.clear();
+                cpu_start = profiler::threadCpuSeconds();
+            }
+            else if (text.rfind("END", 0) == 0 && text.find("`postprocess`") != std::string::npos) {
+                const size_t dt = text.find("dt= ");
+                if (dt == std::string::npos) return;
+                profiler::add(profiler::phase::post_process, step.empty() ? "unnamed step" : step, std::atof(text.c_str() + dt + 4), profiler::threadCpuSeconds() - cpu_start);
+            }
+            else if (step.empty() && text.size() > 6 && text.compare(text.size() - 6, 6, " begin") == 0) {
+                step = text.substr(0, text.size() - 6);
+            }
+        }
+    };
+
+    // assimp reports step times only as log text, so this stays opt in: the default logger is process wide,
+    // debug verbosity makes every import log more, and message wording may change between assimp versions,
+    // created once and left for assimp to tear down, a logger someone else installed is left alone
+    void measureSteps(Assimp::Importer& importer)
+    {
+        static std::once_flag logger_created;
+        std::call_once(logger_created, [] {
+            if (!Assimp::DefaultLogger::isNullLogger()) return;
+            Assimp::DefaultLogger::create(nullptr, Assimp::Logger::DEBUGGING, 0);
+            Assimp::DefaultLogger::get()->attachStream(new stepTimes(), Assimp::Logger::Debugging); // logger takes ownership
+        });
+        importer.SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
+    }
+
+    // properties are set again on every use, earlier inputs may have left other ones
+    Assimp::Importer& getImporter(const assimp::importSettings& settings)
+    {
+        if (!thread_importer.importer) {
+            const auto start{ std::chrono::steady_clock::now() };
+            thread_importer.importer.reset(new Assimp::Importer());
+            const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            ++stats.created;
+            stats.startup_seconds += elapsed_seconds.count();
+        }
+        else {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            ++stats.reused;
+        }
+
+        Assimp::Importer& importer = *thread_importer.importer;
+        importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, (settings.flags & aiProcess_RemoveComponent) ? settings.removed_components : 0);
+        // handler type is checked instead of IsDefaultIOHandler, ReadFileFromMemory puts the default one back as a custom one
+        const bool mapped = dynamic_cast<assimp::mappedIOSystem*>(importer.GetIOHandler()) != nullptr;
+        if (settings.mapped_io && !mapped) importer.SetIOHandler(new assimp::mappedIOSystem()); // importer takes ownership
+        else if (!settings.mapped_io && mapped) importer.SetIOHandler(nullptr); // back to default io
+        if (settings.measure_steps && profiler::enabled()) measureSteps(importer);
+        else importer.SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, false);
+        return importer;
+    }
+}
 
 bool assimp::readFile(const std::string& pFile, std::function<void(const aiScene*)> process_scene, const unsigned int& pFlags)
 {
-    // Create an instance of the Importer class
-    Assimp::Importer importer;
+    return readFile(pFile, process_scene, importSettings(pFlags));
+}
+
+bool assimp::readFile(const std::string& pFile, std::function<void(const aiScene*)> process_scene, const importSettings& settings)
+{
+    Assimp::Importer& importer = getImporter(settings);
 
     // And have it read the given file with some example postprocessing
     // Usually - if speed is not the most important aspect for you - you'll
     // probably to request more postprocessing than we do in this example.
-    const aiScene* scene = importer.ReadFile(pFile, pFlags);
+    profiler::scope import(profiler::phase::import, "assimp");
+    import.set_source(pFile);
+    const auto start{ std::chrono::steady_clock::now() };
+    const aiScene* scene = importer.ReadFile(pFile, settings.flags);
+    const auto end{ std::chrono::steady_clock::now() };
+    import.stop();
+    if (settings.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (" << (settings.mapped_io ? "memory mapped io" : "default io") << ")\n";
+    }
 
     // If the import failed, report it
     if (nullptr == scene) {
-        printf("%s\n", importer.GetErrorString());
+        std::cout << importer.GetErrorString() << std::endl;
         return false;
     }
 
     // Now we can access the file's contents.
-    process_scene(scene);
+    try {
+        process_scene(scene);
+    }
+    catch (...) {
+        importer.FreeScene();
+        throw;
+    }
 
-    // We're done. Everything will be cleaned up by the importer destructor
+    // importer stays for the next file, only the scene goes
+    importer.FreeScene();
     return true;
 }
+
+aiScene* assimp::importFile(const std::string& pFile, const importSettings& settings)
+{
+    Assimp::Importer& importer = getImporter(settings);
+
+    profiler::scope import(profiler::phase::import, "assimp");
+    import.set_source(pFile);
+    const auto start{ std::chrono::steady_clock::now() };
+    const aiScene* scene = importer.ReadFile(pFile, settings.flags);
+    const auto end{ std::chrono::steady_clock::now() };
+    import.stop();
+    if (settings.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (" << (settings.mapped_io ? "memory mapped io" : "default io") << ")\n";
+    }
+
+    if (nullptr == scene) {
+        std::cout << importer.GetErrorString() << std::endl;
+        return nullptr;
+    }
+
+    // scene outlives the importer
+    return importer.GetOrphanedScene();
+}
+
+bool assimp::readMemory(const void* pBuffer, const size_t& pLength, const std::string& pHint, std::function<void(const aiScene*)> process_scene, const importSettings& settings)
+{
+    Assimp::Importer& importer = getImporter(settings);
+
+    // importer wraps the buffer in its own MemoryIOSystem and puts the previous handler back afterwards
+    profiler::scope import(profiler::phase::import, "assimp");
+    import.set_source(pHint);
+    const auto start{ std::chrono::steady_clock::now() };
+    const aiScene* scene = importer.ReadFileFromMemory(pBuffer, pLength, settings.flags, pHint.c_str());
+    const auto end{ std::chrono::steady_clock::now() };
+    import.stop();
+    if (settings.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (memory buffer)\n";
+    }
+
+    if (nullptr == scene) {
+        std::cout << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    try {
+        process_scene(scene);
+    }
+    catch (...) {
+        importer.FreeScene();
+        throw;
+    }
+    importer.FreeScene();
+    return true;
+}
+
+assimp::importerStats assimp::getImporterStats()
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return stats;
+}
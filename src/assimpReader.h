@@ -26,6 +26,7 @@ namespace assimp {
         private:
             void setData(const T& bone_id, const U& weight, const unsigned int& index);
         };
+        meshWeights() = default;
         meshWeights(const aiMesh* mesh);
         std::vector<vertex> vertices;
     };
@@ -46,12 +47,48 @@ namespace assimp {
         std::vector<bone> bones;
     };
 
+    class importSettings {
+    public:
+        unsigned int flags =
+            aiProcess_CalcTangentSpace |
+            aiProcess_Triangulate |
+            aiProcess_JoinIdenticalVertices |
+            aiProcess_SortByPType;
+        int removed_components = 0; // aiComponent flags for aiProcess_RemoveComponent
+        bool mapped_io = true; // read source files through mappedIOSystem instead of assimp default stdio
+        bool report_time = false;
+        bool measure_steps = false; // post processing step times for profiler, through assimp's process wide debug log
+
+        importSettings() = default;
+        importSettings(const unsigned int& flags, const int& removed_components = 0);
+    };
+
+    // importers are made once per thread and reused, stats cover every thread so far,
+    // teardown only counts threads that already exited
+    class importerStats {
+    public:
+        size_t created = 0;
+        size_t reused = 0;
+        double startup_seconds = 0.0;
+        double teardown_seconds = 0.0;
+    };
+
 	bool readFile(const std::string& pFile, std::function<void(const aiScene*)> process_scene, const unsigned int& pFlags =
         aiProcess_CalcTangentSpace |
         aiProcess_Triangulate |
         aiProcess_JoinIdenticalVertices |
         aiProcess_SortByPType);
 
+    bool readFile(const std::string& pFile, std::function<void(const aiScene*)> process_scene, const importSettings& settings);
+
+    // caller owns returned scene, nullptr if import failed (error is reported)
+    aiScene* importFile(const std::string& pFile, const importSettings& settings);
+
+    // pHint is the file extension of the data in memory, importers are chosen by it
+    bool readMemory(const void* pBuffer, const size_t& pLength, const std::string& pHint, std::function<void(const aiScene*)> process_scene, const importSettings& settings);
+
+    importerStats getImporterStats();
+
 // ========== DEFINITIONS ==========
 
     template<typename T, typename U, unsigned int MAX>
@@ -105,6 +142,10 @@ namespace assimp {
         }
     }
 
+    inline importSettings::importSettings(const unsigned int& flags, const int& removed_components) :
+        flags(flags), removed_components(removed_components)
+    {}
+
     inline skeleton::bone::bone()
     {}
 
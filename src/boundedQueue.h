@@ -0,0 +1,108 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// blocking fifo of limited capacity between two pipeline stages, producers wait while it is full
+// and consumers while it is empty, after close() consumers drain what is left and stop
+template <typename T>
+class bounded_queue {
+public:
+    // depth is sampled on every push
+    class stats {
+    public:
+        size_t capacity = 0;
+        size_t pushes = 0;
+        size_t max_depth = 0;
+        size_t depth_sum = 0;
+        size_t full_waits = 0;
+        size_t empty_waits = 0;
+
+        double average_depth() const;
+    };
+
+    bounded_queue(const size_t& capacity);
+    bounded_queue(const bounded_queue& other) = delete;
+
+    bool push(T&& item); // false if queue was closed
+    bool pop(T& item); // false once queue is closed and empty
+    void close();
+
+    stats get_stats() const;
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    std::deque<T> items;
+    bool closed = false;
+    stats st;
+};
+
+// ========== DEFINITIONS ==========
+
+template <typename T>
+double bounded_queue<T>::stats::average_depth() const
+{
+    return pushes == 0 ? 0.0 : static_cast<double>(depth_sum) / pushes;
+}
+
+template <typename T>
+bounded_queue<T>::bounded_queue(const size_t& capacity)
+{
+    st.capacity = capacity == 0 ? 1 : capacity;
+}
+
+template <typename T>
+bool bounded_queue<T>::push(T&& item)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!closed && items.size() >= st.capacity) {
+        ++st.full_waits;
+        not_full.wait(lock, [this] { return closed || items.size() < st.capacity; });
+    }
+    if (closed) return false;
+
+    items.push_back(std::move(item));
+    ++st.pushes;
+    st.depth_sum += items.size();
+    if (items.size() > st.max_depth) st.max_depth = items.size();
+    lock.unlock();
+    not_empty.notify_one();
+    return true;
+}
+
+template <typename T>
+bool bounded_queue<T>::pop(T& item)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!closed && items.empty()) {
+        ++st.empty_waits;
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+    }
+    if (items.empty()) return false;
+
+    item = std::move(items.front());
+    items.pop_front();
+    lock.unlock();
+    not_full.notify_one();
+    return true;
+}
+
+template <typename T>
+void bounded_queue<T>::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    not_full.notify_all();
+    not_empty.notify_all();
+}
+
+template <typename T>
+typename bounded_queue<T>::stats bounded_queue<T>::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return st;
+}
@@ -0,0 +1,247 @@
+#include "compileCache.h"
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include "mappedFile.h"
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // FNV-1a and a variant of it with another offset basis and extra mixing make a 128 bit digest
+    class digest {
+    public:
+        unsigned long long a = 14695981039346656037ull;
+        unsigned long long b = 0x6c62272e07bb0142ull;
+
+        void update(const char* data, const size_t& size)
+        {
+            for (size_t i = 0; i < size; ++i) {
+                a = (a ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+                b = (b ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+                b ^= b >> 29;
+            }
+        }
+
+        // size first so parts can not shift into each other
+        void part(const char* data, const size_t& size)
+        {
+            const unsigned long long siz = size;
+            update(reinterpret_cast<const char*>(&siz), sizeof(siz));
+            update(data, size);
+        }
+
+        std::string hex() const
+        {
+            std::ostringstream ss;
+            ss << std::hex << std::setfill('0') << std::setw(16) << a << std::setw(16) << b;
+            return ss.str();
+        }
+    };
+
+    // clone shares blocks on copy on write filesystems, no data is copied
+    bool cloneFile(const std::string& from, const std::string& to)
+    {
+#ifdef __linux__
+        int src = open(from.c_str(), O_RDONLY);
+        if (src == -1) return false;
+        int dst = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (dst == -1) {
+            close(src);
+            return false;
+        }
+        const bool cloned = ioctl(dst, FICLONE, src) == 0;
+        close(src);
+        close(dst);
+        if (!cloned) unlink(to.c_str());
+        return cloned;
+#else
+        return false;
+#endif
+    }
+
+    // other processes evict and store while the directory is scanned, entries gone meanwhile
+    // are skipped and an unreadable directory ends its scan instead of throwing
+    template<typename Iterator, typename Visit>
+    void scan(const std::filesystem::path& path, Visit visit)
+    {
+        std::error_code ec;
+        for (Iterator it(path, ec), end; !ec && it != end; it.increment(ec)) visit(*it);
+    }
+
+    // 0 for anything but a regular file that still exists
+    unsigned long long fileSize(const std::filesystem::directory_entry& entry)
+    {
+        std::error_code ec;
+        if (!entry.is_regular_file(ec)) return 0;
+        const std::uintmax_t size = entry.file_size(ec);
+        return ec ? 0 : size;
+    }
+}
+
+compile_cache::compile_cache(const std::string& directory, const unsigned long long& max_bytes, const bool& hardlinks) :
+    directory(directory), max_bytes(max_bytes), hardlinks(hardlinks)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(directory) / "tmp", ec);
+    if (ec) throw std::runtime_error("could not create cache directory: " + directory + ": " + ec.message());
+
+    scan<std::filesystem::recursive_directory_iterator>(directory, [&](const std::filesystem::directory_entry& entry) { st.bytes += fileSize(entry); });
+    if (st.bytes > max_bytes) evict(); // limit may be lower than in earlier runs
+}
+
+std::string compile_cache::key(const std::string& salt, const std::vector<std::string>& files)
+{
+    digest d;
+    d.part(salt.data(), salt.size());
+    for (const std::string& file : files) {
+        mapped_file mf(file);
+        d.part(mf.data(), mf.size());
+    }
+    return d.hex();
+}
+
+std::string compile_cache::entryPath(const std::string& key) const
+{
+    return (std::filesystem::path(directory) / key.substr(0, 2) / key).string();
+}
+
+bool compile_cache::lookup(const std::string& key, std::vector<cachedOutput>& outputs)
+{
+    const std::filesystem::path entry = entryPath(key);
+    std::ifstream names((entry / "outputs").string(), std::ios::in | std::ios::binary);
+    bool hit = static_cast<bool>(names);
+    std::vector<cachedOutput> found;
+    std::string name;
+    while (hit && std::getline(names, name)) {
+        const std::filesystem::path blob = entry / std::to_string(found.size());
+        std::error_code ec;
+        if (std::filesystem::exists(blob, ec)) found.emplace_back(name, blob.string());
+        else hit = false; // another process is evicting it
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hit) {
+        ++st.misses;
+        return false;
+    }
+    ++st.hits;
+    std::error_code ec;
+    std::filesystem::last_write_time(entry / "outputs", std::filesystem::file_time_type::clock::now(), ec);
+    outputs = found;
+    return true;
+}
+
+void compile_cache::store(const std::string& key, const std::vector<std::pair<std::string, std::string>>& outputs)
+{
+    const std::filesystem::path entry = entryPath(key);
+    std::filesystem::path temporary;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        temporary = std::filesystem::path(directory) / "tmp" / (key + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "." + std::to_string(temporary_count++));
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(temporary, ec);
+    if (ec) throw std::runtime_error("could not create cache entry: " + temporary.string() + ": " + ec.message());
+
+    unsigned long long bytes = 0;
+    {
+        std::ofstream names((temporary / "outputs").string(), std::ios::out | std::ios::binary);
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            std::ofstream blob((temporary / std::to_string(i)).string(), std::ios::out | std::ios::binary);
+            blob.write(outputs[i].second.data(), outputs[i].second.size());
+            names << outputs[i].first << '\n';
+            bytes += outputs[i].second.size() + outputs[i].first.size() + 1;
+            if (!blob) {
+                std::filesystem::remove_all(temporary, ec);
+                throw std::runtime_error("could not write cache entry: " + temporary.string());
+            }
+        }
+        if (!names) {
+            std::filesystem::remove_all(temporary, ec);
+            throw std::runtime_error("could not write cache entry: " + temporary.string());
+        }
+    }
+
+    // an entry another process stored meanwhile wins, its outputs are the same
+    std::filesystem::create_directories(entry.parent_path(), ec);
+    std::filesystem::rename(temporary, entry, ec);
+    if (ec) {
+        std::filesystem::remove_all(temporary, ec);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++st.stores;
+    st.bytes += bytes;
+    if (st.bytes > max_bytes) evict();
+}
+
+void compile_cache::restore(const cachedOutput& output) const
+{
+    std::error_code ec;
+    std::filesystem::remove(output.first, ec);
+    if (cloneFile(output.second, output.first)) return;
+    if (hardlinks) {
+        std::filesystem::create_hard_link(output.second, output.first, ec);
+        if (!ec) return;
+    }
+    std::filesystem::copy_file(output.second, output.first, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) throw std::runtime_error("could not restore cached output: " + output.first + ": " + ec.message());
+}
+
+// whole directory is rescanned so entries of other processes count too, oldest entries go
+// until a tenth of the limit is free so stores right after do not scan again
+void compile_cache::evict()
+{
+    class entryInfo {
+    public:
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        unsigned long long bytes = 0;
+    };
+
+    std::vector<entryInfo> entries;
+    unsigned long long total = 0;
+    std::error_code ec;
+    scan<std::filesystem::directory_iterator>(directory, [&](const std::filesystem::directory_entry& shard) {
+        std::error_code shard_ec;
+        if (!shard.is_directory(shard_ec) || shard.path().filename() == "tmp") return;
+        scan<std::filesystem::directory_iterator>(shard.path(), [&](const std::filesystem::directory_entry& entry) {
+            entryInfo info;
+            info.path = entry.path();
+            std::error_code used_ec;
+            info.used = std::filesystem::last_write_time(entry.path() / "outputs", used_ec);
+            if (used_ec) info.used = std::filesystem::file_time_type::min();
+            scan<std::filesystem::directory_iterator>(entry.path(), [&](const std::filesystem::directory_entry& file) { info.bytes += fileSize(file); });
+            total += info.bytes;
+            entries.push_back(info);
+        });
+    });
+
+    std::sort(entries.begin(), entries.end(), [](const entryInfo& a, const entryInfo& b) { return a.used < b.used; });
+    const unsigned long long target = max_bytes - max_bytes / 10;
+    for (const entryInfo& info : entries) {
+        if (total <= target) break;
+        std::filesystem::remove_all(info.path, ec);
+        if (ec) continue;
+        total -= info.bytes;
+        ++st.evictions;
+    }
+    st.bytes = total;
+}
+
+compile_cache::stats compile_cache::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return st;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+
+// content addressed store of compiled outputs, an entry holds every output one compile produced
+// and is found by a key made from everything that decides those outputs, entries are evicted
+// least recently used first once the directory grows past its size limit, processes may share it
+class compile_cache {
+public:
+    class stats {
+    public:
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stores = 0;
+        size_t evictions = 0;
+        unsigned long long bytes = 0; // entry sizes known to this process
+    };
+
+    // output name and where its cached copy is
+    typedef std::pair<std::string, std::string> cachedOutput;
+
+    compile_cache(const std::string& directory, const unsigned long long& max_bytes, const bool& hardlinks);
+    compile_cache(const compile_cache& other) = delete;
+
+    // 128 bit hex digest of salt and contents of files, not meant to resist crafted collisions
+    static std::string key(const std::string& salt, const std::vector<std::string>& files);
+
+    // false on miss, a hit counts as a use for eviction
+    bool lookup(const std::string& key, std::vector<cachedOutput>& outputs);
+    // outputs are names and data, entry appears at once or not at all
+    void store(const std::string& key, const std::vector<std::pair<std::string, std::string>>& outputs);
+    // cached copy is cloned where the filesystem can, hard linked if asked to and copied otherwise
+    void restore(const cachedOutput& output) const;
+
+    stats get_stats() const;
+
+private:
+    std::string directory;
+    unsigned long long max_bytes;
+    bool hardlinks;
+
+    mutable std::mutex mutex;
+    stats st;
+    size_t temporary_count = 0;
+
+    std::string entryPath(const std::string& key) const;
+    void evict();
+};
@@ -0,0 +1,259 @@
+#include "compileStats.h"
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include "profiler.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+    std::atomic<bool> collecting{ false };
+    std::mutex stats_mutex;
+    std::vector<compile_stats::inputInfo> inputs;
+    std::map<std::string, size_t> input_index;
+    std::map<std::string, unsigned long long> buffer_bytes;
+    std::map<std::string, unsigned long long> field_bytes;
+    std::chrono::steady_clock::time_point started;
+    std::time_t started_at = 0;
+
+    // caller holds stats_mutex
+    compile_stats::inputInfo& findInput(const std::string& path)
+    {
+        auto found = input_index.find(path);
+        if (found == input_index.end()) {
+            found = input_index.emplace(path, inputs.size()).first;
+            inputs.emplace_back();
+            inputs.back().path = path;
+        }
+        return inputs[found->second];
+    }
+}
+
+void compile_stats::enable()
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    started = std::chrono::steady_clock::now();
+    started_at = std::time(nullptr);
+    collecting = true;
+}
+
+void compile_stats::disable()
+{
+    collecting = false;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    inputs.clear();
+    input_index.clear();
+    buffer_bytes.clear();
+    field_bytes.clear();
+}
+
+bool compile_stats::enabled()
+{
+    return collecting.load(std::memory_order_relaxed);
+}
+
+void compile_stats::addInput(const std::string& path)
+{
+    if (!enabled()) return;
+    std::error_code ec;
+    const unsigned long long bytes = std::filesystem::is_regular_file(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    findInput(path).bytes = ec ? 0 : bytes;
+}
+
+void compile_stats::addScene(const std::string& path, const aiScene* scene)
+{
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    inputInfo& input = findInput(path);
+    if (input.imported) return;
+    input.imported = true;
+
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        meshInfo info;
+        info.name = mesh->mName.C_Str();
+        info.vertices = mesh->mNumVertices;
+        info.faces = mesh->mNumFaces;
+        info.bones = mesh->mNumBones;
+        for (unsigned int f = 0; f < mesh->mNumFaces; ++f) info.indices += mesh->mFaces[f].mNumIndices;
+        input.meshes.push_back(info);
+    }
+    for (unsigned int i = 0; i < scene->mNumAnimations; ++i) {
+        const aiAnimation* animation = scene->mAnimations[i];
+        animationInfo info;
+        info.name = animation->mName.C_Str();
+        info.channels = animation->mNumChannels;
+        for (unsigned int c = 0; c < animation->mNumChannels; ++c) {
+            const aiNodeAnim* channel = animation->mChannels[c];
+            info.keyframes += channel->mNumPositionKeys + channel->mNumRotationKeys + channel->mNumScalingKeys;
+        }
+        input.animations.push_back(info);
+    }
+    for (unsigned int i = 0; i < scene->mNumSkeletons; ++i) {
+        skeletonInfo info;
+        info.name = scene->mSkeletons[i]->mName.C_Str();
+        info.bones = scene->mSkeletons[i]->mNumBones;
+        input.skeletons.push_back(info);
+    }
+}
+
+void compile_stats::addMeshes(const std::string& path, const std::vector<meshInfo>& meshes)
+{
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    inputInfo& input = findInput(path);
+    if (input.imported) return;
+    input.imported = true;
+    input.meshes = meshes;
+}
+
+void compile_stats::addBufferBytes(const char* counting_type, const unsigned long long& bytes)
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    buffer_bytes[counting_type] += bytes;
+}
+
+void compile_stats::addFieldBytes(const char* type, const unsigned long long& bytes)
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    field_bytes[type] += bytes;
+}
+
+// written whole to a temporary file and renamed so dashboards never read half a report
+void compile_stats::writeJson(const std::string& path, const std::string& version, const std::vector<cacheInfo>& caches)
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    const std::chrono::duration<double> wall{ std::chrono::steady_clock::now() - started };
+    const std::string temporary = path + ".tmp";
+    std::ofstream out(temporary, std::ios::out | std::ios::binary);
+    if (!out) throw std::runtime_error("cannot open file: " + temporary);
+
+    out << "{\n";
+    out << "  \"version\": " << quoted(version) << ",\n";
+    out << "  \"started\": " << static_cast<long long>(started_at) << ",\n";
+    out << "  \"wall_seconds\": " << wall.count() << ",\n";
+    out << "  \"peak_memory_bytes\": " << peakMemory() << ",\n";
+
+    out << "  \"inputs\": [";
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const inputInfo& input = inputs[i];
+        out << (i == 0 ? "\n" : ",\n") << "    { \"path\": " << quoted(input.path) << ", \"bytes\": " << input.bytes << ",\n";
+        out << "      \"meshes\": [";
+        for (size_t m = 0; m < input.meshes.size(); ++m) {
+            const meshInfo& mesh = input.meshes[m];
+            out << (m == 0 ? "" : ", ") << "{ \"name\": " << quoted(mesh.name) << ", \"vertices\": " << mesh.vertices << ", \"faces\": " << mesh.faces
+                << ", \"indices\": " << mesh.indices << ", \"bones\": " << mesh.bones << " }";
+        }
+        out << "],\n      \"animations\": [";
+        for (size_t a = 0; a < input.animations.size(); ++a) {
+            const animationInfo& animation = input.animations[a];
+            out << (a == 0 ? "" : ", ") << "{ \"name\": " << quoted(animation.name) << ", \"channels\": " << animation.channels << ", \"keyframes\": " << animation.keyframes << " }";
+        }
+        out << "],\n      \"skeletons\": [";
+        for (size_t s = 0; s < input.skeletons.size(); ++s) {
+            const skeletonInfo& skeleton = input.skeletons[s];
+            out << (s == 0 ? "" : ", ") << "{ \"name\": " << quoted(skeleton.name) << ", \"bones\": " << skeleton.bones << " }";
+        }
+        out << "] }";
+    }
+    out << "\n  ],\n";
+
+    auto write_bytes = [&](const char* name, const std::map<std::string, unsigned long long>& bytes) {
+        out << "  \"" << name << "\": {";
+        bool first = true;
+        for (const auto& b : bytes) {
+            out << (first ? " " : ", ") << quoted(b.first) << ": " << b.second;
+            first = false;
+        }
+        out << " },\n";
+    };
+    write_bytes("buffer_bytes", buffer_bytes);
+    write_bytes("field_type_bytes", field_bytes);
+
+    const std::vector<profiler::record> records = profiler::get_records();
+    out << "  \"phases\": {";
+    bool first = true;
+    for (const profiler::phase& p : { profiler::phase::format_parse, profiler::phase::import, profiler::phase::post_process, profiler::phase::weights, profiler::phase::fields, profiler::phase::emission, profiler::phase::write }) {
+        profiler::record total;
+        for (const profiler::record& r : records) {
+            if (r.p != p) continue;
+            total.calls += r.calls;
+            total.wall += r.wall;
+            total.cpu += r.cpu;
+        }
+        if (total.calls == 0) continue;
+        out << (first ? "\n" : ",\n") << "    " << quoted(profiler::name(p)) << ": { \"calls\": " << total.calls << ", \"wall_seconds\": " << total.wall << ", \"cpu_seconds\": " << total.cpu << " }";
+        first = false;
+    }
+    out << "\n  },\n";
+
+    out << "  \"outputs\": [";
+    first = true;
+    for (const profiler::record& r : records) {
+        if (r.p != profiler::phase::write) continue;
+        if (r.label == profiler::other_outputs) out << (first ? "\n" : ",\n") << "    { \"path\": null, \"count\": " << r.calls << ", \"bytes\": " << r.bytes << ", \"write_seconds\": " << r.wall << " }";
+        else out << (first ? "\n" : ",\n") << "    { \"path\": " << quoted(r.label) << ", \"bytes\": " << r.bytes << ", \"write_seconds\": " << r.wall << " }";
+        first = false;
+    }
+    out << "\n  ],\n";
+
+    out << "  \"caches\": [";
+    for (size_t i = 0; i < caches.size(); ++i) {
+        const cacheInfo& c = caches[i];
+        out << (i == 0 ? "\n" : ",\n") << "    { \"name\": " << quoted(c.name) << ", \"hits\": " << c.hits << ", \"misses\": " << c.misses
+            << ", \"stores\": " << c.stores << ", \"evictions\": " << c.evictions << " }";
+    }
+    out << "\n  ]\n}\n";
+    out.close();
+    if (!out) throw std::runtime_error("could not write stats: " + temporary);
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) throw std::runtime_error("could not write stats: " + path + ": " + ec.message());
+}
+
+std::string compile_stats::quoted(const std::string& text)
+{
+    static const char* hex = "0123456789abcdef";
+    std::string out = "\"";
+    for (const char& c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            out += "\\u00";
+            out += hex[(c >> 4) & 0xf];
+            out += hex[c & 0xf];
+        }
+        else out += c;
+    }
+    return out + "\"";
+}
+
+unsigned long long compile_stats::peakMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<unsigned long long>(usage.ru_maxrss) * 1024; // kilobytes on linux
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <assimp/scene.h>
+
+// what one run compiled, written as json for build dashboards: inputs with their sizes and object
+// counts, emitted bytes by buffer counting type and by field type, phase times from profiler, peak memory
+// and cache counters, off until enable(), every call is safe from any thread
+class compile_stats {
+public:
+    class meshInfo {
+    public:
+        std::string name;
+        size_t vertices = 0;
+        size_t faces = 0;
+        size_t indices = 0;
+        size_t bones = 0;
+    };
+
+    class animationInfo {
+    public:
+        std::string name;
+        size_t channels = 0;
+        size_t keyframes = 0; // position, rotation and scale keys together
+    };
+
+    class skeletonInfo {
+    public:
+        std::string name;
+        size_t bones = 0;
+    };
+
+    class inputInfo {
+    public:
+        std::string path;
+        unsigned long long bytes = 0;
+        bool imported = false; // set once the first scene of this input was recorded
+        std::vector<meshInfo> meshes;
+        std::vector<animationInfo> animations;
+        std::vector<skeletonInfo> skeletons;
+    };
+
+    // counters of one compile_cache, filled in by the caller
+    class cacheInfo {
+    public:
+        std::string name;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stores = 0;
+        size_t evictions = 0;
+    };
+
+    compile_stats() = delete;
+
+    static void enable();
+    static void disable(); // also drops everything collected
+    static bool enabled();
+
+    static void addInput(const std::string& path);
+    // only the first scene of an input counts, inputs compiled against several file units import it again
+    static void addScene(const std::string& path, const aiScene* scene);
+    static void addMeshes(const std::string& path, const std::vector<meshInfo>& meshes); // same rule, for sources read without a scene
+    static void addBufferBytes(const char* counting_type, const unsigned long long& bytes);
+    static void addFieldBytes(const char* type, const unsigned long long& bytes);
+
+    static void writeJson(const std::string& path, const std::string& version, const std::vector<cacheInfo>& caches);
+
+    static unsigned long long peakMemory(); // bytes, 0 where unknown
+    static std::string quoted(const std::string& text); // json string literal
+};
@@ -0,0 +1,466 @@
+#include "glbReader.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// ========== JSON ==========
+
+    class jsonValue {
+    public:
+        enum class kind { null, boolean, number, string, array, object };
+        kind k = kind::null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<jsonValue> array; // array elements or object member values
+        std::vector<std::string> keys; // object member names
+
+        const jsonValue* find(const std::string& key) const
+        {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (keys[i] == key) return &array[i];
+            }
+            return nullptr;
+        }
+
+        const jsonValue& at(const std::string& key) const
+        {
+            const jsonValue* v = find(key);
+            if (v == nullptr) throw std::runtime_error("glTF json has no member: " + key);
+            return *v;
+        }
+
+        size_t get_size_t(const std::string& key, const size_t& default_value) const
+        {
+            const jsonValue* v = find(key);
+            return v ? static_cast<size_t>(v->number) : default_value;
+        }
+    };
+
+    class jsonParser {
+    public:
+        jsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+        jsonValue parse()
+        {
+            jsonValue v = parseValue();
+            skipSpaces();
+            return v;
+        }
+
+    private:
+        const char* p;
+        const char* end;
+
+        void skipSpaces()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+        }
+
+        char next()
+        {
+            skipSpaces();
+            if (p >= end) throw std::runtime_error("unexpected end of glTF json");
+            return *p;
+        }
+
+        void expect(const char* word)
+        {
+            size_t len = strlen(word);
+            if (static_cast<size_t>(end - p) < len || memcmp(p, word, len) != 0) throw std::runtime_error("invalid glTF json");
+            p += len;
+        }
+
+        jsonValue parseValue()
+        {
+            jsonValue v;
+            char c = next();
+            if (c == '{') {
+                v.k = jsonValue::kind::object;
+                ++p;
+                if (next() == '}') ++p;
+                else while (true) {
+                    if (next() != '"') throw std::runtime_error("invalid glTF json");
+                    std::string key = parseString();
+                    if (next() != ':') throw std::runtime_error("invalid glTF json");
+                    ++p;
+                    v.keys.push_back(key);
+                    v.array.push_back(parseValue());
+                    c = next();
+                    ++p;
+                    if (c == '}') break;
+                    if (c != ',') throw std::runtime_error("invalid glTF json");
+                }
+            }
+            else if (c == '[') {
+                v.k = jsonValue::kind::array;
+                ++p;
+                if (next() == ']') ++p;
+                else while (true) {
+                    v.array.push_back(parseValue());
+                    c = next();
+                    ++p;
+                    if (c == ']') break;
+                    if (c != ',') throw std::runtime_error("invalid glTF json");
+                }
+            }
+            else if (c == '"') {
+                v.k = jsonValue::kind::string;
+                v.string = parseString();
+            }
+            else if (c == 't') {
+                expect("true");
+                v.k = jsonValue::kind::boolean;
+                v.boolean = true;
+            }
+            else if (c == 'f') {
+                expect("false");
+                v.k = jsonValue::kind::boolean;
+            }
+            else if (c == 'n') expect("null");
+            else {
+                v.k = jsonValue::kind::number;
+                std::string number;
+                while (p < end && (isdigit(static_cast<unsigned char>(*p)) || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E')) number += *p++;
+                if (number.empty()) throw std::runtime_error("invalid glTF json");
+                v.number = std::stod(number);
+            }
+            return v;
+        }
+
+        std::string parseString()
+        {
+            std::string s;
+            ++p; // opening quote
+            while (p < end && *p != '"') {
+                if (*p != '\\') {
+                    s += *p++;
+                    continue;
+                }
+                if (++p >= end) break;
+                switch (*p++)
+                {
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u': {
+                    if (end - p < 4) throw std::runtime_error("invalid glTF json");
+                    unsigned int code = std::stoul(std::string(p, p + 4), nullptr, 16);
+                    p += 4;
+                    if (code < 0x80) s += static_cast<char>(code);
+                    else if (code < 0x800) {
+                        s += static_cast<char>(0xC0 | (code >> 6));
+                        s += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    else {
+                        s += static_cast<char>(0xE0 | (code >> 12));
+                        s += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        s += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: s += p[-1]; break; // " \ /
+                }
+            }
+            if (p >= end) throw std::runtime_error("unterminated string in glTF json");
+            ++p; // closing quote
+            return s;
+        }
+    };
+
+// ========== HELPERS ==========
+
+    const uint32_t glb_magic = 0x46546C67; // "glTF"
+    const uint32_t chunk_json = 0x4E4F534A;
+    const uint32_t chunk_bin = 0x004E4942;
+
+    // steps that views honor or that do not change glTF triangle lists
+    const unsigned int handled_steps =
+        aiProcess_Triangulate |
+        aiProcess_JoinIdenticalVertices |
+        aiProcess_SortByPType |
+        aiProcess_RemoveComponent |
+        aiProcess_ValidateDataStructure |
+        aiProcess_FlipUVs |
+        aiProcess_LimitBoneWeights |
+        aiProcess_GenNormals |
+        aiProcess_GenSmoothNormals |
+        aiProcess_CalcTangentSpace;
+
+    uint32_t readUint32(const char* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+
+    size_t componentSize(const unsigned int& component_type)
+    {
+        switch (component_type)
+        {
+        case 5120: case 5121: return 1;
+        case 5122: case 5123: return 2;
+        case 5125: case 5126: return 4;
+        default: throw std::runtime_error("unknown accessor component type: " + std::to_string(component_type));
+        }
+    }
+
+    unsigned int componentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        throw std::runtime_error("unsupported accessor type: " + type);
+    }
+
+    bool keeps(const assimp::importSettings& settings, const int& component)
+    {
+        return !((settings.flags & aiProcess_RemoveComponent) && (settings.removed_components & component));
+    }
+}
+
+// ========== ACCESSOR VIEW ==========
+
+bool glb_reader::accessorView::valid() const
+{
+    return data != nullptr;
+}
+
+float glb_reader::accessorView::get(const size_t& i, const unsigned int& component) const
+{
+    if (component >= components) return 0.0f;
+    const char* p = data + i * stride + component * componentSize(component_type);
+    switch (component_type)
+    {
+    case 5120: { int8_t v; memcpy(&v, p, 1); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+    case 5121: { uint8_t v; memcpy(&v, p, 1); return normalized ? v / 255.0f : v; }
+    case 5122: { int16_t v; memcpy(&v, p, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+    case 5123: { uint16_t v; memcpy(&v, p, 2); return normalized ? v / 65535.0f : v; }
+    case 5125: { uint32_t v; memcpy(&v, p, 4); return static_cast<float>(v); }
+    default: { float v; memcpy(&v, p, 4); return v; }
+    }
+}
+
+unsigned int glb_reader::accessorView::get_unsigned(const size_t& i, const unsigned int& component) const
+{
+    if (component >= components) return 0;
+    const char* p = data + i * stride + component * componentSize(component_type);
+    switch (component_type)
+    {
+    case 5121: { uint8_t v; memcpy(&v, p, 1); return v; }
+    case 5123: { uint16_t v; memcpy(&v, p, 2); return v; }
+    case 5125: { uint32_t v; memcpy(&v, p, 4); return v; }
+    default: return static_cast<unsigned int>(get(i, component));
+    }
+}
+
+// ========== MESH VIEW ==========
+
+size_t glb_reader::meshView::get_vertex_count() const
+{
+    return positions.count;
+}
+
+size_t glb_reader::meshView::get_face_count() const
+{
+    return (indices.valid() ? indices.count : positions.count) / 3;
+}
+
+unsigned int glb_reader::meshView::get_index(const size_t& face, const unsigned int& corner) const
+{
+    if (!indices.valid()) return static_cast<unsigned int>(face * 3 + corner);
+    return indices.get_unsigned(face * 3 + corner, 0);
+}
+
+float glb_reader::meshView::get_uv(const unsigned int& channel, const size_t& vertex, const unsigned int& component) const
+{
+    float v = texcoords[channel].get(vertex, component);
+    return (component == 1 && flip_v) ? 1.0f - v : v;
+}
+
+float glb_reader::meshView::get_color(const unsigned int& channel, const size_t& vertex, const unsigned int& component) const
+{
+    if (component == 3 && colors[channel].components == 3) return 1.0f;
+    return colors[channel].get(vertex, component);
+}
+
+float glb_reader::meshView::get_bitangent(const size_t& vertex, const unsigned int& component) const
+{
+    // cross(normal, tangent) * handedness, same as assimp glTF2 importer
+    const unsigned int a = (component + 1) % 3, b = (component + 2) % 3;
+    float v = normals.get(vertex, a) * tangents.get(vertex, b) - normals.get(vertex, b) * tangents.get(vertex, a);
+    return v * tangents.get(vertex, 3);
+}
+
+int glb_reader::meshView::get_bone_id(const size_t& vertex, const unsigned int& slot) const
+{
+    int id;
+    float weight;
+    sortedInfluence(vertex, slot, id, weight);
+    return id;
+}
+
+float glb_reader::meshView::get_bone_weight(const size_t& vertex, const unsigned int& slot) const
+{
+    int id;
+    float weight;
+    sortedInfluence(vertex, slot, id, weight);
+    return weight;
+}
+
+void glb_reader::meshView::sortedInfluence(const size_t& vertex, const unsigned int& slot, int& id, float& weight) const
+{
+    std::array<std::pair<float, int>, 4> influences;
+    for (unsigned int i = 0; i < 4; ++i) {
+        influences[i].first = weights.get(vertex, i);
+        influences[i].second = influences[i].first > 0.0f ? static_cast<int>(joints.get_unsigned(vertex, i)) : -1;
+    }
+    std::stable_sort(influences.begin(), influences.end(), [](const std::pair<float, int>& l, const std::pair<float, int>& r) { return l.first > r.first; });
+    id = slot < 4 ? influences[slot].second : -1;
+    weight = slot < 4 && id >= 0 ? influences[slot].first : 0.0f;
+}
+
+// ========== GLB FILE ==========
+
+glb_reader::glbFile::glbFile(const std::string& filename, const assimp::importSettings& settings) : file(filename)
+{
+    // out of range json lookups and number conversions throw logic errors, they mean a malformed file too
+    try {
+        parse(settings);
+    }
+    catch (std::logic_error& e) {
+        throw std::runtime_error(std::string("malformed glb file: ") + e.what());
+    }
+}
+
+void glb_reader::glbFile::parse(const assimp::importSettings& settings)
+{
+    if (settings.flags & ~handled_steps) throw std::runtime_error("requested post processing needs assimp");
+
+    const char* data = file.data();
+    const size_t size = file.size();
+    if (size < 20 || readUint32(data) != glb_magic) throw std::runtime_error("not a binary glTF file");
+    if (readUint32(data + 4) != 2) throw std::runtime_error("only glTF 2.0 is supported");
+
+    // chunks
+    const char* json_begin = nullptr;
+    const char* json_end = nullptr;
+    const char* bin = nullptr;
+    size_t bin_size = 0;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const size_t chunk_size = readUint32(data + offset);
+        const uint32_t chunk_type = readUint32(data + offset + 4);
+        if (offset + 8 + chunk_size > size) throw std::runtime_error("glb chunk exceeds file size");
+        if (chunk_type == chunk_json && json_begin == nullptr) {
+            json_begin = data + offset + 8;
+            json_end = json_begin + chunk_size;
+        }
+        else if (chunk_type == chunk_bin && bin == nullptr) {
+            bin = data + offset + 8;
+            bin_size = chunk_size;
+        }
+        offset += 8 + chunk_size;
+    }
+    if (json_begin == nullptr) throw std::runtime_error("glb file has no json chunk");
+    const jsonValue root = jsonParser(json_begin, json_end).parse();
+
+    // views into the binary chunk only, buffers with uri would need external files
+    auto makeView = [&](const size_t& accessor_index) {
+        const jsonValue& accessor = root.at("accessors").array.at(accessor_index);
+        if (accessor.find("sparse")) throw std::runtime_error("sparse accessors are not supported");
+        const jsonValue& buffer_view = root.at("bufferViews").array.at(static_cast<size_t>(accessor.at("bufferView").number));
+        const size_t buffer = buffer_view.get_size_t("buffer", 0);
+        if (buffer != 0 || root.at("buffers").array.at(buffer).find("uri")) throw std::runtime_error("external buffers are not supported");
+
+        accessorView view;
+        view.count = static_cast<size_t>(accessor.at("count").number);
+        view.component_type = static_cast<unsigned int>(accessor.at("componentType").number);
+        view.components = componentCount(accessor.at("type").string);
+        const jsonValue* normalized = accessor.find("normalized");
+        view.normalized = normalized && normalized->boolean;
+        const size_t element_size = view.components * componentSize(view.component_type);
+        view.stride = buffer_view.get_size_t("byteStride", element_size);
+
+        const size_t view_offset = buffer_view.get_size_t("byteOffset", 0);
+        const size_t view_length = static_cast<size_t>(buffer_view.at("byteLength").number);
+        const size_t accessor_offset = accessor.get_size_t("byteOffset", 0);
+        if (view_offset + view_length > bin_size) throw std::runtime_error("buffer view exceeds binary chunk");
+        if (view.count != 0 && accessor_offset + (view.count - 1) * view.stride + element_size > view_length) throw std::runtime_error("accessor exceeds buffer view");
+        view.data = bin + view_offset + accessor_offset;
+        return view;
+    };
+
+    const jsonValue* meshes_json = root.find("meshes");
+    if (meshes_json == nullptr) return;
+    for (size_t m = 0; m < meshes_json->array.size(); ++m) {
+        const jsonValue& mesh = meshes_json->array[m];
+        const jsonValue* name = mesh.find("name");
+        const std::string mesh_name = name ? name->string : "mesh_" + std::to_string(m);
+        const std::vector<jsonValue>& primitives = mesh.at("primitives").array;
+
+        for (size_t p = 0; p < primitives.size(); ++p) {
+            const jsonValue& primitive = primitives[p];
+            if (primitive.get_size_t("mode", 4) != 4) throw std::runtime_error("only triangle list primitives are supported");
+
+            meshView view;
+            view.name = primitives.size() > 1 ? mesh_name + "-" + std::to_string(p) : mesh_name;
+            view.flip_v = !(settings.flags & aiProcess_FlipUVs);
+            const jsonValue& attributes = primitive.at("attributes");
+            for (size_t a = 0; a < attributes.keys.size(); ++a) {
+                const std::string& semantic = attributes.keys[a];
+                const size_t accessor = static_cast<size_t>(attributes.array[a].number);
+                if (semantic == "POSITION") view.positions = makeView(accessor);
+                else if (semantic == "NORMAL") view.normals = makeView(accessor);
+                else if (semantic == "TANGENT") view.tangents = makeView(accessor);
+                else if (semantic == "JOINTS_0") view.joints = makeView(accessor);
+                else if (semantic == "WEIGHTS_0") view.weights = makeView(accessor);
+                else if (semantic == "JOINTS_1" || semantic == "WEIGHTS_1") throw std::runtime_error("more than 4 bone influences are not supported");
+                else if (semantic.compare(0, 9, "TEXCOORD_") == 0 || semantic.compare(0, 6, "COLOR_") == 0) {
+                    const bool uv = semantic[0] == 'T';
+                    const size_t channel = std::stoul(semantic.substr(uv ? 9 : 6));
+                    if (uv && channel < view.texcoords.size()) view.texcoords[channel] = makeView(accessor);
+                    else if (!uv && channel < view.colors.size()) view.colors[channel] = makeView(accessor);
+                }
+            }
+            if (!view.positions.valid()) throw std::runtime_error("primitive has no positions");
+            if (primitive.find("indices")) view.indices = makeView(static_cast<size_t>(primitive.at("indices").number));
+
+            std::vector<const accessorView*> vertex_attributes = { &view.normals, &view.tangents, &view.joints, &view.weights };
+            for (const accessorView& a : view.texcoords) vertex_attributes.push_back(&a);
+            for (const accessorView& a : view.colors) vertex_attributes.push_back(&a);
+            for (const accessorView* a : vertex_attributes) {
+                if (a->valid() && a->count != view.positions.count) throw std::runtime_error("attribute count does not match vertex count");
+            }
+
+            // removed components
+            if (!keeps(settings, aiComponent_NORMALS)) view.normals = accessorView();
+            if (!keeps(settings, aiComponent_TANGENTS_AND_BITANGENTS)) view.tangents = accessorView();
+            if (!keeps(settings, aiComponent_TEXCOORDS)) view.texcoords.fill(accessorView());
+            if (!keeps(settings, aiComponent_COLORS)) view.colors.fill(accessorView());
+            if (!keeps(settings, aiComponent_BONEWEIGHTS)) {
+                view.joints = accessorView();
+                view.weights = accessorView();
+            }
+
+            // generated data needs assimp
+            if ((settings.flags & (aiProcess_GenNormals | aiProcess_GenSmoothNormals)) && !view.normals.valid()) throw std::runtime_error("normals would have to be generated");
+            if ((settings.flags & aiProcess_CalcTangentSpace) && !view.tangents.valid() && keeps(settings, aiComponent_TANGENTS_AND_BITANGENTS)) throw std::runtime_error("tangents would have to be generated");
+
+            meshes.push_back(view);
+        }
+    }
+}
+
+bool glb_reader::isGlb(const std::string& filename)
+{
+    std::string ext = filename.substr(filename.find_last_of('.') + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == "glb";
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+
+#include <assimp/mesh.h>
+#include "assimpReader.h"
+#include "mappedFile.h"
+
+// binary glTF reader that leaves vertex data in the mapped file
+// and exposes every primitive as strided views over it, no aiScene is built
+namespace glb_reader {
+
+    // typed strided window into the binary chunk, glTF is little endian
+    class accessorView {
+    public:
+        const char* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        unsigned int components = 0;
+        unsigned int component_type = 0; // GL enum: 5120 byte ... 5126 float
+        bool normalized = false;
+
+        bool valid() const;
+        float get(const size_t& i, const unsigned int& component) const; // missing components read as 0
+        unsigned int get_unsigned(const size_t& i, const unsigned int& component) const;
+    };
+
+    // one primitive, assimp imports every primitive as separate aiMesh
+    class meshView {
+    public:
+        std::string name;
+        accessorView positions;
+        accessorView normals;
+        accessorView tangents; // xyz + handedness in w
+        accessorView joints;
+        accessorView weights;
+        accessorView indices; // not valid for non indexed primitives
+        std::array<accessorView, AI_MAX_NUMBER_OF_TEXTURECOORDS> texcoords;
+        std::array<accessorView, AI_MAX_NUMBER_OF_COLOR_SETS> colors;
+        bool flip_v = true; // assimp flips glTF texture coordinates on import, aiProcess_FlipUVs flips them back
+
+        size_t get_vertex_count() const;
+        size_t get_face_count() const;
+        unsigned int get_index(const size_t& face, const unsigned int& corner) const;
+        float get_uv(const unsigned int& channel, const size_t& vertex, const unsigned int& component) const;
+        float get_color(const unsigned int& channel, const size_t& vertex, const unsigned int& component) const;
+        float get_bitangent(const size_t& vertex, const unsigned int& component) const;
+
+        // influences sorted by weight like assimp::meshWeights, unused slots have id -1 and weight 0
+        int get_bone_id(const size_t& vertex, const unsigned int& slot) const;
+        float get_bone_weight(const size_t& vertex, const unsigned int& slot) const;
+
+    private:
+        void sortedInfluence(const size_t& vertex, const unsigned int& slot, int& id, float& weight) const;
+    };
+
+    class glbFile {
+    public:
+        std::vector<meshView> meshes;
+
+        // throws std::runtime_error if the file is not a self contained glb this reader handles
+        glbFile(const std::string& filename, const assimp::importSettings& settings);
+        glbFile(const glbFile& other) = delete;
+
+    private:
+        mapped_file file;
+
+        void parse(const assimp::importSettings& settings);
+    };
+
+    bool isGlb(const std::string& filename);
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <string_view>
+#include <stdexcept>
+
+// read only keyword lookup built at compile time: a seed is searched for so that mixing every keyword hash
+// with it lands in its own slot, a lookup is then one hash and one string comparison and nothing runs at startup,
+// tables have to be constexpr so a failed search is a build error and never a dynamic initializer
+template <typename T, size_t N>
+class keyword_table {
+public:
+    class entry {
+    public:
+        std::string_view key;
+        T value;
+    };
+
+    // throws std::logic_error (a compile error in constant evaluation) on empty or repeated keywords
+    // or when no seed below max_seed works
+    constexpr keyword_table(const entry (&entries)[N]);
+
+    constexpr const T* find(const std::string_view& key) const; // nullptr if key is not a keyword
+    constexpr bool contains(const std::string_view& key) const;
+
+private:
+    static_assert(N < 255, "slot indices are stored in one byte");
+
+    // at least eight slots per keyword make a seed work with probability about 1/4 for 39 keywords,
+    // keywords are hashed once and the search gives up after 16 seeds: for 39 keywords even a failing
+    // search is under 80k operations by gcc's count, inside the 100k steps msvc allows by default
+    static constexpr size_t slots = [] {
+        size_t s = 1;
+        while (s < 8 * N) s *= 2;
+        return s;
+    }();
+    static constexpr unsigned int max_seed = 16;
+
+    std::array<entry, N> entries;
+    std::array<unsigned char, slots> index; // entry index + 1, 0 marks empty slot
+    unsigned int seed = 0;
+
+    static constexpr unsigned int hash(const std::string_view& key);
+    static constexpr size_t slot(const unsigned int& hash, const unsigned int& seed);
+};
+
+// enum keyed table stored as an array in enumerator order, enumerators left out map to T()
+template <typename E, typename T, size_t N>
+class enum_table {
+public:
+    class entry {
+    public:
+        E key;
+        T value;
+    };
+
+    template <size_t M>
+    constexpr enum_table(const entry (&entries)[M]);
+
+    constexpr const T& operator[](const E& key) const;
+
+private:
+    std::array<T, N> values;
+};
+
+// ========== DEFINITIONS ==========
+
+template <typename T, size_t N>
+constexpr keyword_table<T, N>::keyword_table(const entry (&entries)[N]) : entries{}, index{}
+{
+    unsigned int hashes[N] = {};
+    for (size_t i = 0; i < N; ++i) {
+        if (entries[i].key.empty()) throw std::logic_error("empty keyword");
+        hashes[i] = hash(entries[i].key);
+        this->entries[i] = entries[i];
+    }
+
+    // a slot holds seed * 256 + entry index while that seed is tried, so nothing is cleared between seeds,
+    // repeated keywords collide under every seed and are told apart from other collisions here
+    unsigned int taken[slots] = {};
+    for (seed = 1; seed < max_seed; ++seed) {
+        bool perfect = true;
+        for (size_t i = 0; i < N && perfect; ++i) {
+            const size_t s = slot(hashes[i], seed);
+            if (taken[s] / 256 == seed) {
+                if (entries[taken[s] % 256].key == entries[i].key) throw std::logic_error("repeated keyword");
+                perfect = false;
+            }
+            else taken[s] = seed * 256 + static_cast<unsigned int>(i);
+        }
+        if (!perfect) continue;
+        for (size_t i = 0; i < N; ++i) index[slot(hashes[i], seed)] = static_cast<unsigned char>(i + 1);
+        return;
+    }
+    throw std::logic_error("no perfect hash seed found, raise slots or max_seed");
+}
+
+template <typename T, size_t N>
+constexpr const T* keyword_table<T, N>::find(const std::string_view& key) const
+{
+    const unsigned char found = index[slot(hash(key), seed)];
+    if (found == 0 || entries[found - 1].key != key) return nullptr;
+    return &entries[found - 1].value;
+}
+
+template <typename T, size_t N>
+constexpr bool keyword_table<T, N>::contains(const std::string_view& key) const
+{
+    return find(key) != nullptr;
+}
+
+// FNV-1a
+template <typename T, size_t N>
+constexpr unsigned int keyword_table<T, N>::hash(const std::string_view& key)
+{
+    unsigned int h = 2166136261u;
+    for (const char& c : key) h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    return h;
+}
+
+// seed is mixed in with a multiply and the high bits folded down, only low bits pick the slot
+template <typename T, size_t N>
+constexpr size_t keyword_table<T, N>::slot(const unsigned int& hash, const unsigned int& seed)
+{
+    unsigned int h = (hash ^ (seed * 2654435761u)) * 2246822519u;
+    h ^= h >> 15;
+    return h & (slots - 1);
+}
+
+template <typename E, typename T, size_t N>
+template <size_t M>
+constexpr enum_table<E, T, N>::enum_table(const entry (&entries)[M]) : values{}
+{
+    for (size_t i = 0; i < M; ++i) {
+        const size_t slot = static_cast<size_t>(entries[i].key);
+        if (slot >= N) throw std::logic_error("enumerator out of table range");
+        values[slot] = entries[i].value;
+    }
+}
+
+template <typename E, typename T, size_t N>
+constexpr const T& enum_table<E, T, N>::operator[](const E& key) const
+{
+    return values[static_cast<size_t>(key)];
+}
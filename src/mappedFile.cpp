@@ -0,0 +1,89 @@
+#include "mappedFile.h"
+#include <stdexcept>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(const std::string& filename)
+{
+    file_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE) throw std::runtime_error("could not open file: " + filename);
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        throw std::runtime_error("could not read size of file: " + filename);
+    }
+    siz = static_cast<size_t>(file_size.QuadPart);
+    if (siz == 0) return; // empty files can not be mapped
+
+    mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_handle == NULL) {
+        CloseHandle(file_handle);
+        throw std::runtime_error("could not map file: " + filename);
+    }
+    ptr = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (ptr == nullptr) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        throw std::runtime_error("could not map file: " + filename);
+    }
+}
+
+mapped_file::~mapped_file()
+{
+    if (ptr != nullptr) UnmapViewOfFile(ptr);
+    if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+    if (file_handle != nullptr && file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& filename)
+{
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) throw std::runtime_error("could not open file: " + filename);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("could not read size of file: " + filename);
+    }
+    siz = static_cast<size_t>(st.st_size);
+    if (siz == 0) return; // empty files can not be mapped
+
+    void* p = mmap(nullptr, siz, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("could not map file: " + filename);
+    }
+    madvise(p, siz, MADV_SEQUENTIAL);
+    ptr = static_cast<const char*>(p);
+}
+
+mapped_file::~mapped_file()
+{
+    if (ptr != nullptr) munmap(const_cast<char*>(ptr), siz);
+    if (fd != -1) close(fd);
+}
+
+#endif // _WIN32
+
+const char* mapped_file::data() const
+{
+    return ptr;
+}
+
+size_t mapped_file::size() const
+{
+    return siz;
+}
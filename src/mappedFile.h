@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+
+// read only memory mapping of a whole file
+class mapped_file {
+public:
+    mapped_file(const std::string& filename);
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file(mapped_file&& other) = delete;
+    ~mapped_file();
+
+    const char* data() const;
+    size_t size() const;
+
+private:
+    const char* ptr = nullptr;
+    size_t siz = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
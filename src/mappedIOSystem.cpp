@@ -0,0 +1,90 @@
+#include "mappedIOSystem.h"
+#include <cstring>
+#include <fstream>
+
+assimp::mappedIOStream::mappedIOStream(const std::string& filename) : file(new mapped_file(filename))
+{
+}
+
+size_t assimp::mappedIOStream::Read(void* pvBuffer, size_t pSize, size_t pCount)
+{
+    if (pSize == 0 || pCount == 0) return 0;
+    size_t available = (file->size() - pos) / pSize;
+    if (pCount > available) pCount = available;
+    memcpy(pvBuffer, file->data() + pos, pSize * pCount);
+    pos += pSize * pCount;
+    return pCount;
+}
+
+size_t assimp::mappedIOStream::Write(const void*, size_t, size_t)
+{
+    return 0;
+}
+
+aiReturn assimp::mappedIOStream::Seek(size_t pOffset, aiOrigin pOrigin)
+{
+    size_t target;
+    switch (pOrigin)
+    {
+    case aiOrigin_SET:
+        target = pOffset;
+        break;
+    case aiOrigin_CUR:
+        target = pos + pOffset;
+        break;
+    case aiOrigin_END:
+        if (pOffset > file->size()) return aiReturn_FAILURE;
+        target = file->size() - pOffset;
+        break;
+    default:
+        return aiReturn_FAILURE;
+    }
+    if (target > file->size()) return aiReturn_FAILURE;
+    pos = target;
+    return aiReturn_SUCCESS;
+}
+
+size_t assimp::mappedIOStream::Tell() const
+{
+    return pos;
+}
+
+size_t assimp::mappedIOStream::FileSize() const
+{
+    return file->size();
+}
+
+void assimp::mappedIOStream::Flush()
+{
+}
+
+bool assimp::mappedIOSystem::Exists(const char* pFile) const
+{
+    std::ifstream f(pFile, std::ios::in | std::ios::binary);
+    return static_cast<bool>(f);
+}
+
+char assimp::mappedIOSystem::getOsSeparator() const
+{
+#ifdef _WIN32
+    return '\\';
+#else
+    return '/';
+#endif
+}
+
+Assimp::IOStream* assimp::mappedIOSystem::Open(const char* pFile, const char* pMode)
+{
+    if (strchr(pMode, 'w') != nullptr || strchr(pMode, 'a') != nullptr) return nullptr;
+    try {
+        return new mappedIOStream(pFile);
+    }
+    catch (std::runtime_error&) {
+        return nullptr;
+    }
+}
+
+void assimp::mappedIOSystem::Close(Assimp::IOStream* pFile)
+{
+    delete pFile;
+}
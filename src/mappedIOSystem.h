@@ -0,0 +1,34 @@
+#pragma once
+#include <memory>
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+#include "mappedFile.h"
+
+namespace assimp {
+
+    // serves assimp reads straight from a memory mapping of the source file
+    class mappedIOStream : public Assimp::IOStream {
+    public:
+        mappedIOStream(const std::string& filename);
+
+        size_t Read(void* pvBuffer, size_t pSize, size_t pCount) override;
+        size_t Write(const void* pvBuffer, size_t pSize, size_t pCount) override;
+        aiReturn Seek(size_t pOffset, aiOrigin pOrigin) override;
+        size_t Tell() const override;
+        size_t FileSize() const override;
+        void Flush() override;
+
+    private:
+        std::unique_ptr<mapped_file> file;
+        size_t pos = 0;
+    };
+
+    // read only, opening files for writing fails
+    class mappedIOSystem : public Assimp::IOSystem {
+    public:
+        bool Exists(const char* pFile) const override;
+        char getOsSeparator() const override;
+        Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override;
+        void Close(Assimp::IOStream* pFile) override;
+    };
+}
@@ -2,195 +2,74 @@
 #include <iostream>
 #include <sstream>
 #include <map>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <cstring>
+#include <cctype>
 #include <assimpReader.h>
 #include <NotImplemented.h>
+#include "meshDecoder.h"
+#include "nativeReader.h"
+#include "plyFormat.h"
+#include "outputImporter.h"
+#include "transcoder.h"
+#include "threadPool.h"
+#include "boundedQueue.h"
+#include "compileCache.h"
+#include "mappedFile.h"
+#include "sceneFile.h"
+#include "profiler.h"
+#include "compileStats.h"
+#include "tracer.h"
+#include "perfCounters.h"
+#include "allocTracker.h"
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+namespace {
+
+    // stream buffer over a fixed block of memory, lets code emitting to files fill part of a region
+    class regionBuffer : public std::streambuf {
+    public:
+        regionBuffer(char* begin, const size_t& size) { setp(begin, begin + size); }
+        bool full() const { return pptr() == epptr(); }
+    };
+
+    // lengths in cache keys keep neighbouring parts from running into each other
+    void appendSize(std::string& key, const size_t& size)
+    {
+        const unsigned long long siz = size;
+        key.append(reinterpret_cast<const char*>(&siz), sizeof(siz));
+    }
+}
 
-std::string mesh_compiler::version = "v2.1.0";
+std::string mesh_compiler::version = "v2.2.0";
 
 // ========== DEFINES AND MAPS ==========
 
-std::map<std::string, mesh_compiler::value> mesh_compiler::preambleMap = {
-    {"buffu", value::buffers_per_unit },
-    {"buffs", value::buffer_size },
-    {"entryu", value::entries_per_unit },
-    {"entryb", value::entries_per_buffer },
-    {"entrys", value::entry_size },
-    {"fieldu", value::fields_per_unit },
-    {"fieldb", value::fields_per_buffer },
-    {"fielde", value::fields_per_entry },
-    {"fields", value::field_size },
-};
-
-std::map<std::string, mesh_compiler::value> mesh_compiler::fieldsMap = {
-    { "i", value::indice},
-    { "indice", value::indice},
-
-    { "v", value::vertex},
-    { "vert", value::vertex},
-    { "vertex", value::vertex},
-    { "n", value::normal},
-    { "normal", value::normal},
-    { "tc", value::uv},
-    { "tex_coord", value::uv},
-    { "texture_coordinate", value::uv},
-    { "uv", value::uv },
-    { "t", value::tangent },
-    { "tangent", value::tangent },
-    { "b", value::bitangent },
-    { "bitangent", value::bitangent},
-    { "vertex_color", value::vertex_color },
-    { "bone_id", value::bone_id },
-    { "bone_weight", value::bone_weight },
-
-    { "off_matr", value::offset_matrix },
-    { "off_matrix", value::offset_matrix },
-    { "offset_matr", value::offset_matrix },
-    { "offset_matrix", value::offset_matrix },
-
-    { "position_key", value::position_key },
-    { "rotation_key", value::rotation_key },
-    { "scale_key", value::scale_key },
-    { "position_key_timestamp", value::position_key_timestamp },
-    { "rotation_key_timestamp", value::rotation_key_timestamp },
-    { "scale_key_timestamp", value::scale_key_timestamp },
-    { "position_key_time", value::position_key_timestamp },
-    { "rotation_key_time", value::rotation_key_timestamp },
-    { "scale_key_time", value::scale_key_timestamp },
-    { "position_timestamp", value::position_key_timestamp },
-    { "rotation_timestamp", value::rotation_key_timestamp },
-    { "scale_timestamp", value::scale_key_timestamp },
-    { "position_time", value::position_key_timestamp },
-    { "rotation_time", value::rotation_key_timestamp },
-    { "scale_time", value::scale_key_timestamp },
-
-    { "duration", value::duration },
-    { "ticks_per_second", value::ticks_per_second }
-};
-
-std::map<std::string, mesh_compiler::type> mesh_compiler::typesMap = {
-    {"char", mc_char},
-    {"short", mc_short},
-    {"int", mc_int},
-    {"long", mc_long},
-    {"long_long", mc_long_long},
-    {"int2", mc_short},
-    {"int4", mc_int},
-    {"int8", mc_long},
-    {"int16", mc_long_long},
-    {"unsigned_short", mc_unsigned_short},
-    {"unsigned_int", mc_unsigned_int},
-    {"unsigned_long", mc_unsigned_long},
-    {"unsigned_long_long", mc_unsigned_long_long},
-    {"unsigned_int2", mc_unsigned_short},
-    {"unsigned_int4", mc_unsigned_int},
-    {"unsigned_int8", mc_unsigned_long},
-    {"unsigned_int16", mc_unsigned_long_long},
-    {"ushort", mc_unsigned_short},
-    {"uint", mc_unsigned_int},
-    {"ulong", mc_unsigned_long},
-    {"uint2", mc_unsigned_short},
-    {"uint4", mc_unsigned_int},
-    {"uint8", mc_unsigned_long},
-    {"uint16", mc_unsigned_long_long},
-    {"float", mc_float},
-    {"float4", mc_float},
-    {"double", mc_double},
-    {"float8", mc_double},
-    {"long_double", mc_long_double},
-    {"float16", mc_long_double}
-};
-
-std::map<mesh_compiler::type, unsigned short> mesh_compiler::typeSizesMap = {
-    {mc_char, sizeof(char)},
-    {mc_short, sizeof(short)},
-    {mc_int, sizeof(int)},
-    {mc_long, sizeof(long)},
-    {mc_long_long, sizeof(long long)},
-    {mc_unsigned_short, sizeof(unsigned short)},
-    {mc_unsigned_int, sizeof(unsigned int)},
-    {mc_unsigned_long, sizeof(unsigned long)},
-    {mc_unsigned_long_long, sizeof(unsigned long long)},
-    {mc_float, sizeof(float)},
-    {mc_double, sizeof(double)},
-    {mc_long_double, sizeof(long double)}
-};
-
-std::map<mesh_compiler::type, std::string> mesh_compiler::typeNamesMap = {
-    {mc_none, "null"},
-    {mc_unit, "unit"},
-    {mc_char, "char"},
-    {mc_short, "int2"},
-    {mc_int, "int4"},
-    {mc_long, "int8"},
-    {mc_long_long, "int16"},
-    {mc_unsigned_short, "uint2"},
-    {mc_unsigned_int, "uint4"},
-    {mc_unsigned_long, "uint8"},
-    {mc_unsigned_long_long, "uint16"},
-    {mc_float, "float4"},
-    {mc_double, "float8"},
-    {mc_long_double, "float16"}
-};
-std::map<mesh_compiler::value, std::string> mesh_compiler::valueNamesMap = {
-    { value::null, "null"},
-
-    { value::constant, "const"},
-    { value::other_unit, "other_unit"},
-
-    { value::indice, "indice" },
-    { value::vertex, "vertex"},
-    { value::normal, "normal"},
-    { value::tangent, "tangent"},
-    { value::bitangent, "bitangent"},
-    { value::uv, "uv" },
-    { value::vertex_color, "vertex_color"},
-    { value::bone_id, "bone_id"},
-    { value::bone_weight, "bone_weight"},
-
-    { value::offset_matrix, "offset_matrix"},
-
-    { value::position_key, "position_key"},
-    { value::rotation_key, "rotation_key"},
-    { value::scale_key, "scale_key"},
-    { value::position_key_timestamp, "position_key_timestamp"},
-    { value::rotation_key_timestamp, "rotation_key_timestamp"},
-    { value::scale_key_timestamp, "scale_key_timestamp"},
-
-    { value::duration, "duration"},
-    { value::ticks_per_second, "ticks_per_second"},
-
-    { value::unit_size, "units" },
-    { value::buffer_size, "buffs" },
-    { value::buffers_per_unit, "buffu" },
-    { value::entry_size, "entrys" },
-    { value::entries_per_unit, "entryu" },
-    { value::entries_per_buffer, "entryb" },
-    { value::field_size, "fields"},
-    { value::fields_per_unit, "fieldu" },
-    { value::fields_per_buffer, "fieldb"},
-    { value::fields_per_entry, "fielde" }
-};
-std::map<mesh_compiler::counting_type, std::string> mesh_compiler::countingTypeNamesMap = {
-    {counting_type::null, "null"},
-    {counting_type::per_indice, "per_indice"},
-    {counting_type::per_vertex, "per_vertex"},
-    {counting_type::per_mesh_bone, "per_mesh_bone"},
-    {counting_type::per_mesh, "per_mesh"},
-    {counting_type::per_bone, "per_bone"},
-    {counting_type::per_skeleton, "per_skeleton"},
-    {counting_type::per_position_keyframe, "per_position_keyframe"},
-    {counting_type::per_rotation_keyframe, "per_rotation_keyframe"},
-    {counting_type::per_scale_keyframe, "per_scale_keyframe"},
-    {counting_type::per_animation_channel, "per_animation_channel"},
-    {counting_type::per_animation, "per_animation"},
-};
-
-std::map<char, unsigned short> suffixesMap = {
-    {'0', 0}, {'1', 1}, {'2', 2}, {'3', 3}, {'4', 4}, {'5', 5}, {'6', 6}, {'7', 7},
-    {'x', 0}, {'y', 1}, {'z', 2},
-    {'r', 0}, {'g', 1}, {'b', 2}, {'a', 3},
-    {'u', 0}, {'v', 1}, {'w', 2}
-};
+// keyword and enum tables are constexpr members in meshCompiler.h
+
+namespace {
+    // component index of a field suffix character, -1 for characters that are not suffixes
+    constexpr std::array<short, 256> suffixesMap = [] {
+        std::array<short, 256> suffixes{};
+        for (short& suffix : suffixes) suffix = -1;
+        for (char c = '0'; c <= '7'; ++c) suffixes[c] = c - '0';
+        suffixes['x'] = 0; suffixes['y'] = 1; suffixes['z'] = 2;
+        suffixes['r'] = 0; suffixes['g'] = 1; suffixes['b'] = 2; suffixes['a'] = 3;
+        suffixes['u'] = 0; suffixes['v'] = 1; suffixes['w'] = 2;
+        return suffixes;
+    }();
+}
 
 mesh_compiler::type mesh_compiler::getDefaultValueType(const value& v)
 {
@@ -464,31 +343,9 @@ void mesh_compiler::copyConstantToMemory(void* dst, const type& t, const std::st
 
 // ========== EXCEPTIONS ==========
 
-std::map<mesh_compiler::formatInterpreterException::error_code, std::string> mesh_compiler::formatInterpreterException::errorMessagesMap = {
-    {formatInterpreterException::error_code::unknown_statement, "unknown statement"},
-    {formatInterpreterException::error_code::no_suffix, "field suffix not provided"},
-    {formatInterpreterException::error_code::invalid_suffix, "invalid field suffix"},
-    {formatInterpreterException::error_code::wrong_suffixes_amount, "wrong amount of suffixes"},
-    {formatInterpreterException::error_code::no_const_value, "constant value not provided"},
-    {formatInterpreterException::error_code::invalid_const_value, "invalid const value"},
-    {formatInterpreterException::error_code::invalid_type_specifier, "invalid type specifier"},
-    {formatInterpreterException::error_code::byte_base_in_count_type, "given byte base in count type"},
-    {formatInterpreterException::error_code::field_spec_in_preamble, "attempted field specification in preamble"},
-    {formatInterpreterException::error_code::unsupported_type, "unsupported type"},
-    {formatInterpreterException::error_code::conflicting_buffer_fields, "confilcting types detected in single buffer"},
-    {formatInterpreterException::error_code::conflicting_unit_fields, "confilcting types detected in single unit"},
-    {formatInterpreterException::error_code::constants_only, "detected buffer of only constants - unknown buffer size"},
-    {formatInterpreterException::error_code::no_unit_name, "unit name unspecified"},
-    {formatInterpreterException::error_code::no_file_name, "file name unspecified"},
-    {formatInterpreterException::error_code::unit_redefinition, "unit redefinition"},
-    {formatInterpreterException::error_code::name_keyword_collision, "unit name collides with keyword"},
-    {formatInterpreterException::error_code::no_end, "end key word expected"},
-    {formatInterpreterException::error_code::unknown, "unknown error"}
-};
-
 mesh_compiler::formatInterpreterException::formatInterpreterException(const error_code& error_code, const std::string& message) : type(error_code), msg(message), filled(false)
 {
-    if (errorMessagesMap.find(type) == errorMessagesMap.end()) type = formatInterpreterException::error_code::unknown;
+    if (static_cast<size_t>(type) > static_cast<size_t>(formatInterpreterException::error_code::unknown)) type = formatInterpreterException::error_code::unknown;
 }
 
 mesh_compiler::formatInterpreterException::formatInterpreterException(const error_code& error_code, const unsigned int& line_number, const std::string& processed_word, const std::string& message) : formatInterpreterException(error_code, message)
@@ -498,18 +355,18 @@ mesh_compiler::formatInterpreterException::formatInterpreterException(const erro
 
 std::string mesh_compiler::formatInterpreterException::make_message(const error_code& error_code, const unsigned int& line_number, const std::string& processed_word, const std::string& message)
 {
-    return "format compilation error: " + errorMessagesMap[error_code] + ": " + processed_word + " in line " + std::to_string(line_number) + ". " + message;
+    return std::string("format compilation error: ") + errorMessagesMap[error_code] + ": " + processed_word + " in line " + std::to_string(line_number) + ". " + message;
 }
 
 void mesh_compiler::formatInterpreterException::fillInfo(const unsigned int& line_number, const std::string& processed_word)
 {
-    this->msg = "format compilation error: " + errorMessagesMap[type] + ": " + processed_word + " in line " + std::to_string(line_number) + ". " + this->msg;
+    this->msg = std::string("format compilation error: ") + errorMessagesMap[type] + ": " + processed_word + " in line " + std::to_string(line_number) + ". " + this->msg;
     this->filled = true;
 }
 
 const char* mesh_compiler::formatInterpreterException::what() throw()
 {
-    if (!filled) this->msg = "format compilation error: " + errorMessagesMap[type] + ": info not filled";
+    if (!filled) this->msg = std::string("format compilation error: ") + errorMessagesMap[type] + ": info not filled";
     return this->msg.c_str();
 }
 
@@ -554,6 +411,29 @@ size_t mesh_compiler::compileField::get_size() const
     return typeSizesMap[stype];
 }
 
+size_t mesh_compiler::compileField::get_size(const compileBuffer& buffer) const
+{
+    if (vtype == value::field_size) return get_size() * buffer.fields.size();
+    return get_size();
+}
+
+size_t mesh_compiler::compileField::get_size(const compileUnit& unit) const
+{
+    switch (vtype)
+    {
+    case value::constant:
+    case value::buffers_per_unit:
+    case value::entries_per_unit:
+    case value::fields_per_unit:
+        return get_size();
+    default:
+        size_t siz = 0;
+        for (const compileBuffer& cb : unit.buffers)
+            siz += get_size(cb);
+        return siz;
+    }
+}
+
 std::string mesh_compiler::compileField::get_otherUnitName() const
 {
     if (this->vtype != value::other_unit) throw std::logic_error("attempted to get unit name when value type was not other unit");
@@ -562,12 +442,12 @@ std::string mesh_compiler::compileField::get_otherUnitName() const
 
 void mesh_compiler::compileField::print(const int& indent) const
 {
-    for (int i = 0; i < indent; ++i) printf(" ");
+    for (int i = 0; i < indent; ++i) std::cout << " ";
     std::cout << "FIELD: " << typeNamesMap[stype] << ":" << valueNamesMap[vtype] << ":";
     for (const char& c : data) std::cout << c;
 }
 
-void mesh_compiler::compileField::put(std::ofstream& file, const compileBuffer& buffer) const
+void mesh_compiler::compileField::put(std::ostream& file, const compileBuffer& buffer) const
 {
     // size
     switch (this->vtype)
@@ -596,12 +476,12 @@ void mesh_compiler::compileField::put(std::ofstream& file, const compileBuffer&
         writeConst(file, buffer.fields.size() * buffer.count, this->stype);
         break;
     default:
-        throw std::logic_error("flag could not be handled with this function call, flag: " + valueNamesMap[this->vtype]);
+        throw std::logic_error(std::string("flag could not be handled with this function call, flag: ") + valueNamesMap[this->vtype]);
         break;
     }
 }
 
-void mesh_compiler::compileField::put(std::ofstream& file, const std::vector<compileBuffer>& buffers) const
+void mesh_compiler::compileField::put(std::ostream& file, const std::vector<compileBuffer>& buffers) const
 {
     switch (this->vtype)
     {
@@ -619,12 +499,12 @@ void mesh_compiler::compileField::put(std::ofstream& file, const std::vector<com
         }
         break;
     default:
-        throw std::logic_error("flag could not be handled with this function call, flag: " + valueNamesMap[this->vtype]);
+        throw std::logic_error(std::string("flag could not be handled with this function call, flag: ") + valueNamesMap[this->vtype]);
         break;
     }
 }
 
-void mesh_compiler::compileField::put(std::ofstream& file, const compileUnit& unit) const
+void mesh_compiler::compileField::put(std::ostream& file, const compileUnit& unit) const
 {
     switch (this->vtype)
     {
@@ -656,6 +536,14 @@ bool mesh_compiler::compileField::operator!=(const compileField& other) const
     return !(*this == other);
 }
 
+void mesh_compiler::compileField::appendKey(std::string& key) const
+{
+    key += static_cast<char>(stype);
+    key += static_cast<char>(vtype);
+    appendSize(key, data.size());
+    key.append(data.data(), data.size());
+}
+
 size_t mesh_compiler::compileBuffer::get_entry_size() const
 {
     size_t siz = 0;
@@ -669,9 +557,35 @@ size_t mesh_compiler::compileBuffer::get_size() const
     return get_entry_size() * count;
 }
 
+// kinds of the fields in field order, names the buffer in profiles and traces
+std::string mesh_compiler::compileBuffer::get_field_kinds() const
+{
+    std::string kinds;
+    for (const compileField& field : fields) {
+        const char* kind = nullptr;
+        switch (field.vtype)
+        {
+        case value::indice: kind = "indice"; break;
+        case value::vertex: kind = "vertex"; break;
+        case value::normal:
+        case value::tangent:
+        case value::bitangent: kind = "normal"; break;
+        case value::uv: kind = "uv"; break;
+        case value::vertex_color: kind = "color"; break;
+        case value::bone_id:
+        case value::bone_weight: kind = "bone"; break;
+        default: break;
+        }
+        if (kind == nullptr || (" " + kinds + " ").find(std::string(" ") + kind + " ") != std::string::npos) continue;
+        if (!kinds.empty()) kinds += ' ';
+        kinds += kind;
+    }
+    return kinds.empty() ? "other" : kinds;
+}
+
 void mesh_compiler::compileBuffer::print(const int& indent) const
 {
-    for (int i = 0; i < indent; ++i) printf(" ");
+    for (int i = 0; i < indent; ++i) std::cout << " ";
     std::cout << "BUFFER: preamble: ";
     for (const compileField& f : preamble) {
         f.print();
@@ -699,6 +613,15 @@ bool mesh_compiler::compileBuffer::operator!=(const compileBuffer& other) const
     return !(*this == other);
 }
 
+void mesh_compiler::compileBuffer::appendKey(std::string& key) const
+{
+    key += static_cast<char>(count_type);
+    appendSize(key, preamble.size());
+    for (const compileField& field : preamble) field.appendKey(key);
+    appendSize(key, fields.size());
+    for (const compileField& field : fields) field.appendKey(key);
+}
+
 size_t mesh_compiler::compileUnit::get_size() const
 {
     size_t siz = 0;
@@ -706,6 +629,193 @@ size_t mesh_compiler::compileUnit::get_size() const
     return siz;
 }
 
+// entry counts of every buffer for one object, put() and measure() both start here
+void mesh_compiler::compileUnit::fillCounts(const aiNodeAnim* animation_channel)
+{
+    if (this->count_type != counting_type::per_animation_channel) throw meshCompilerException("invalid compilation unit for this object");
+    for (compileBuffer& buffer : this->buffers) {
+        if (buffer.count_type == counting_type::per_position_keyframe) buffer.count = animation_channel->mNumPositionKeys;
+        else if (buffer.count_type == counting_type::per_rotation_keyframe) buffer.count = animation_channel->mNumRotationKeys;
+        else if (buffer.count_type == counting_type::per_scale_keyframe) buffer.count = animation_channel->mNumScalingKeys;
+        else {
+            throw std::logic_error(std::string("invalid counting type for this animation object") + countingTypeNamesMap[buffer.count_type]);
+        }
+    }
+}
+
+void mesh_compiler::compileUnit::fillCounts(const aiSkeleton* skeleton)
+{
+    if (this->count_type != counting_type::per_skeleton) throw meshCompilerException("invalid compilation unit for this object");
+    for (compileBuffer& buffer : this->buffers) {
+        if (buffer.count_type == counting_type::per_bone) buffer.count = skeleton->mNumBones;
+        else {
+            throw std::logic_error(std::string("invalid counting type for scene object") + countingTypeNamesMap[buffer.count_type]);
+        }
+    }
+}
+
+void mesh_compiler::compileUnit::fillCounts(const aiAnimation* animation)
+{
+    if (this->count_type != counting_type::per_animation) throw meshCompilerException("invalid compilation unit for this object");
+    for (compileBuffer& buffer : this->buffers) {
+        if (buffer.count_type == counting_type::per_animation_channel) buffer.count = animation->mNumChannels;
+        else {
+            throw std::logic_error(std::string("invalid counting type for this animation object") + countingTypeNamesMap[buffer.count_type]);
+        }
+    }
+}
+
+void mesh_compiler::compileUnit::fillCounts(const aiMesh* mesh)
+{
+    if (this->count_type != counting_type::per_mesh) throw meshCompilerException("invalid compilation unit for this object");
+    for (compileBuffer& buffer : this->buffers) {
+        if (buffer.count_type == counting_type::per_indice) buffer.count = mesh->mNumFaces;
+        else if (buffer.count_type == counting_type::per_vertex) buffer.count = mesh->mNumVertices;
+        else if (buffer.count_type == counting_type::per_mesh_bone) buffer.count = mesh->mNumBones;
+        else {
+            throw std::logic_error(std::string("invalid counting type for scene object") + countingTypeNamesMap[buffer.count_type]);
+        }
+    }
+}
+
+void mesh_compiler::compileUnit::fillCounts(const glb_reader::meshView& mesh)
+{
+    if (this->count_type != counting_type::per_mesh) throw meshCompilerException("invalid compilation unit for this object");
+    for (compileBuffer& buffer : this->buffers) {
+        if (buffer.count_type == counting_type::per_indice) buffer.count = mesh.get_face_count();
+        else if (buffer.count_type == counting_type::per_vertex) buffer.count = mesh.get_vertex_count();
+        else {
+            throw std::logic_error(std::string("invalid counting type for glb mesh view") + countingTypeNamesMap[buffer.count_type]);
+        }
+    }
+}
+
+void mesh_compiler::compileUnit::fillCounts(const aiScene* scene)
+{
+    if (this->count_type != counting_type::per_scene) throw meshCompilerException("invalid compilation unit for this object");
+    for (compileBuffer& buffer : this->buffers) {
+        if (buffer.count_type == counting_type::per_mesh) buffer.count = scene->mNumMeshes;
+        else if (buffer.count_type == counting_type::per_skeleton) buffer.count = scene->mNumSkeletons;
+        else if (buffer.count_type == counting_type::per_animation) buffer.count = scene->mNumAnimations;
+        else {
+            throw std::logic_error(std::string("invalid counting type for this mesh") + countingTypeNamesMap[buffer.count_type]);
+        }
+    }
+}
+
+// bytes about to be emitted by this unit, nested units count their own when they are put
+void mesh_compiler::compileUnit::countBytes() const
+{
+    if (!compile_stats::enabled()) return;
+    for (const compileField& field : preamble) {
+        if (field.vtype != value::other_unit) compile_stats::addFieldBytes(typeNamesMap[field.stype], field.get_size(*this));
+    }
+    for (const compileBuffer& buffer : buffers) {
+        size_t preamble_size = 0;
+        for (const compileField& field : buffer.preamble) {
+            if (field.vtype == value::other_unit) continue;
+            compile_stats::addFieldBytes(typeNamesMap[field.stype], field.get_size(buffer));
+            preamble_size += field.get_size(buffer);
+        }
+        for (const compileField& field : buffer.fields) {
+            if (field.vtype != value::other_unit) compile_stats::addFieldBytes(typeNamesMap[field.stype], field.get_size() * buffer.count);
+        }
+        compile_stats::addBufferBytes(countingTypeNamesMap[buffer.count_type], preamble_size + buffer.get_size());
+    }
+}
+
+// size of what put() emits for one object, from entry counts and field sizes only, units nested in the
+// preamble are measured on the same object, units nested as buffer fields on the object of each entry
+template <typename Same, typename Nested>
+size_t mesh_compiler::compileUnit::measureUnit(std::ostream& report, const int& indent, const std::string& object, Same same, Nested nested)
+{
+    std::ostringstream details;
+    size_t preamble_size = 0;
+    size_t unit_size = 0;
+    for (const compileField& field : preamble) {
+        if (field.vtype == value::other_unit) unit_size += same((*unitsMap)[field.get_otherUnitName()], details, indent + 1);
+        else preamble_size += field.get_size(*this);
+    }
+    unit_size += preamble_size;
+
+    for (const compileBuffer& buffer : buffers) {
+        std::ostringstream nested_details;
+        size_t buffer_preamble_size = 0;
+        size_t buffer_size = 0;
+        for (const compileField& field : buffer.preamble) {
+            if (field.vtype == value::other_unit) buffer_size += same((*unitsMap)[field.get_otherUnitName()], nested_details, indent + 2);
+            else buffer_preamble_size += field.get_size(buffer);
+        }
+        buffer_size += buffer_preamble_size + buffer.get_size();
+        for (size_t j = 0; j < buffer.count; ++j) {
+            for (const compileField& field : buffer.fields) {
+                if (field.vtype == value::other_unit) buffer_size += nested((*unitsMap)[field.get_otherUnitName()], buffer.count_type, j, nested_details, indent + 2);
+            }
+        }
+        details << std::string(2 * (indent + 1), ' ') << "buffer " << countingTypeNamesMap[buffer.count_type] << ": " << buffer.count << " entries of "
+            << buffer.get_entry_size() << " bytes, preamble " << buffer_preamble_size << " bytes, " << buffer_size << " bytes\n" << nested_details.str();
+        unit_size += buffer_size;
+    }
+
+    report << std::string(2 * indent, ' ') << name << " (" << object << "): preamble " << preamble_size << " bytes, " << unit_size << " bytes\n" << details.str();
+    return unit_size;
+}
+
+size_t mesh_compiler::compileUnit::measure(std::ostream& report, const aiNodeAnim* animation_channel, const int& indent)
+{
+    fillCounts(animation_channel);
+    return measureUnit(report, indent, animation_channel->mNodeName.C_Str(),
+        [&](compileUnit& unit, std::ostream& out, const int& i) { return unit.measure(out, animation_channel, i); },
+        [](compileUnit&, const counting_type&, const size_t&, std::ostream&, const int&) -> size_t { throw std::logic_error("invalid value"); });
+}
+
+size_t mesh_compiler::compileUnit::measure(std::ostream& report, const aiSkeleton* skeleton, const int& indent)
+{
+    fillCounts(skeleton);
+    return measureUnit(report, indent, skeleton->mName.C_Str(),
+        [&](compileUnit& unit, std::ostream& out, const int& i) { return unit.measure(out, skeleton, i); },
+        [](compileUnit&, const counting_type&, const size_t&, std::ostream&, const int&) -> size_t { throw std::logic_error("invalid value"); });
+}
+
+size_t mesh_compiler::compileUnit::measure(std::ostream& report, const aiAnimation* animation, const int& indent)
+{
+    fillCounts(animation);
+    return measureUnit(report, indent, animation->mName.C_Str(),
+        [&](compileUnit& unit, std::ostream& out, const int& i) { return unit.measure(out, animation, i); },
+        [&](compileUnit& unit, const counting_type&, const size_t& j, std::ostream& out, const int& i) { return unit.measure(out, animation->mChannels[j], i); });
+}
+
+size_t mesh_compiler::compileUnit::measure(std::ostream& report, const aiMesh* mesh, const int& indent)
+{
+    fillCounts(mesh);
+    return measureUnit(report, indent, mesh->mName.C_Str(),
+        [&](compileUnit& unit, std::ostream& out, const int& i) { return unit.measure(out, mesh, i); },
+        [](compileUnit&, const counting_type&, const size_t&, std::ostream&, const int&) -> size_t { throw std::logic_error("invalid value"); });
+}
+
+size_t mesh_compiler::compileUnit::measure(std::ostream& report, const glb_reader::meshView& mesh, const int& indent)
+{
+    fillCounts(mesh);
+    return measureUnit(report, indent, mesh.name,
+        [&](compileUnit& unit, std::ostream& out, const int& i) { return unit.measure(out, mesh, i); },
+        [](compileUnit&, const counting_type&, const size_t&, std::ostream&, const int&) -> size_t { throw std::logic_error("invalid value"); });
+}
+
+size_t mesh_compiler::compileUnit::measure(std::ostream& report, const aiScene* scene, const int& indent)
+{
+    fillCounts(scene);
+    return measureUnit(report, indent, scene->mName.C_Str(),
+        [&](compileUnit& unit, std::ostream& out, const int& i) { return unit.measure(out, scene, i); },
+        [&](compileUnit& unit, const counting_type& ct, const size_t& j, std::ostream& out, const int& i) -> size_t {
+            switch (ct) {
+            case counting_type::per_mesh: return unit.measure(out, scene->mMeshes[j], i);
+            case counting_type::per_skeleton: return unit.measure(out, scene->mSkeletons[j], i);
+            case counting_type::per_animation: return unit.measure(out, scene->mAnimations[j], i);
+            default: return 0;
+            }
+        });
+}
+
 size_t mesh_compiler::compileUnit::get_entries_count() const
 {
     size_t siz = 0;
@@ -720,9 +830,46 @@ size_t mesh_compiler::compileUnit::get_fields_count() const
     return siz;
 }
 
+bool mesh_compiler::compileUnit::uses(const value& v) const
+{
+    for (const compileField& field : preamble) {
+        if (field.vtype == v) return true;
+        if (field.vtype == value::other_unit && (*unitsMap)[field.get_otherUnitName()].uses(v)) return true;
+    }
+    for (const compileBuffer& buffer : buffers) {
+        for (const compileField& field : buffer.preamble) {
+            if (field.vtype == v) return true;
+            if (field.vtype == value::other_unit && (*unitsMap)[field.get_otherUnitName()].uses(v)) return true;
+        }
+        for (const compileField& field : buffer.fields) {
+            if (field.vtype == v) return true;
+            if (field.vtype == value::other_unit && (*unitsMap)[field.get_otherUnitName()].uses(v)) return true;
+        }
+    }
+    return false;
+}
+
+bool mesh_compiler::compileUnit::uses(const counting_type& ct) const
+{
+    if (count_type == ct) return true;
+    for (const compileField& field : preamble) {
+        if (field.vtype == value::other_unit && (*unitsMap)[field.get_otherUnitName()].uses(ct)) return true;
+    }
+    for (const compileBuffer& buffer : buffers) {
+        if (buffer.count_type == ct) return true;
+        for (const compileField& field : buffer.preamble) {
+            if (field.vtype == value::other_unit && (*unitsMap)[field.get_otherUnitName()].uses(ct)) return true;
+        }
+        for (const compileField& field : buffer.fields) {
+            if (field.vtype == value::other_unit && (*unitsMap)[field.get_otherUnitName()].uses(ct)) return true;
+        }
+    }
+    return false;
+}
+
 void mesh_compiler::compileUnit::print(const int& indent) const
 {
-    for (int i = 0; i < indent; ++i) printf(" ");
+    for (int i = 0; i < indent; ++i) std::cout << " ";
     std::cout << "UNIT: preamble: ";
     for (const compileField& f : preamble) f.print();
     std::cout << "\n";
@@ -735,18 +882,13 @@ void mesh_compiler::compileUnit::clear()
     this->buffers.clear();
 }
 
-void mesh_compiler::compileUnit::put(std::ofstream& file, const aiNodeAnim* animation_channel)
+void mesh_compiler::compileUnit::put(std::ostream& file, const aiNodeAnim* animation_channel)
 {
-    if (this->count_type != counting_type::per_animation_channel) throw meshCompilerException("invalid compilation unit for this object");
-    // fill counts
-    for (compileBuffer& buffer : this->buffers) {
-        if (buffer.count_type == counting_type::per_position_keyframe) buffer.count = animation_channel->mNumPositionKeys;
-        else if (buffer.count_type == counting_type::per_rotation_keyframe) buffer.count = animation_channel->mNumRotationKeys;
-        else if (buffer.count_type == counting_type::per_scale_keyframe) buffer.count = animation_channel->mNumScalingKeys;
-        else {
-            throw std::logic_error("invalid counting type for this animation object" + countingTypeNamesMap[buffer.count_type]);
-        }
-    }
+    fillCounts(animation_channel);
+    countBytes();
+    tracer::span trace("put", name);
+    trace.arg("object", animation_channel->mNodeName.C_Str());
+    trace.arg("entries", get_entries_count());
 
     // preamble
     for (const compileField& field : this->preamble) {
@@ -811,16 +953,13 @@ void mesh_compiler::compileUnit::put(std::ofstream& file, const aiNodeAnim* anim
     }
 }
 
-void mesh_compiler::compileUnit::put(std::ofstream& file, const aiSkeleton* skeleton)
+void mesh_compiler::compileUnit::put(std::ostream& file, const aiSkeleton* skeleton)
 {
-    if (this->count_type != counting_type::per_skeleton) throw meshCompilerException("invalid compilation unit for this object");
-    // fill counts
-    for (compileBuffer& buffer : this->buffers) {
-        if (buffer.count_type == counting_type::per_bone) buffer.count = skeleton->mNumBones;
-        else {
-            throw std::logic_error("invalid counting type for scene object" + countingTypeNamesMap[buffer.count_type]);
-        }
-    }
+    fillCounts(skeleton);
+    countBytes();
+    tracer::span trace("put", name);
+    trace.arg("object", skeleton->mName.C_Str());
+    trace.arg("entries", get_entries_count());
 
     // preamble
     for (const compileField& field : this->preamble) {
@@ -857,16 +996,13 @@ void mesh_compiler::compileUnit::put(std::ofstream& file, const aiSkeleton* skel
     }
 }
 
-void mesh_compiler::compileUnit::put(std::ofstream& file, const aiAnimation* animation)
+void mesh_compiler::compileUnit::put(std::ostream& file, const aiAnimation* animation)
 {
-    if (this->count_type != counting_type::per_animation) throw meshCompilerException("invalid compilation unit for this object");
-    // fill counts
-    for (compileBuffer& buffer : this->buffers) {
-        if (buffer.count_type == counting_type::per_animation_channel) buffer.count = animation->mNumChannels;
-        else {
-            throw std::logic_error("invalid counting type for this animation object" + countingTypeNamesMap[buffer.count_type]);
-        }
-    }
+    fillCounts(animation);
+    countBytes();
+    tracer::span trace("put", name);
+    trace.arg("object", animation->mName.C_Str());
+    trace.arg("entries", get_entries_count());
 
     // preamble
     for (const compileField& field : this->preamble) {
@@ -909,24 +1045,66 @@ void mesh_compiler::compileUnit::put(std::ofstream& file, const aiAnimation* ani
     }
 }
 
-void mesh_compiler::compileUnit::put(std::ofstream& file, const aiMesh* mesh)
+// entries of large per_vertex and per_indice buffers are split into ranges emitted by emit_pool workers,
+// entry size is fixed so every range has a known place in a preallocated window and output matches serial emission
+template <typename Emit>
+void mesh_compiler::compileUnit::putRanges(std::ostream& file, const compileBuffer& buffer, Emit emit_entries) const
 {
-    assimp::meshWeights<int, float, MAX_BONE_INFLUENCE> mw(mesh);
-    put(file, mesh, mw);
+    const size_t min_range = 16384; // entries, smaller ranges cost more to hand off than they save
+    const size_t window_bytes = 64 << 20; // caps memory held besides the source
+    const size_t entry_size = buffer.get_entry_size();
+    const size_t ranges = emit_pool == nullptr ? 1 : std::min<size_t>(emit_pool->size(), buffer.count / min_range);
+    const std::string kinds = profiler::enabled() || tracer::enabled() ? buffer.get_field_kinds() : "";
+    if (ranges < 2 || entry_size == 0 || (buffer.count_type != counting_type::per_vertex && buffer.count_type != counting_type::per_indice)) {
+        profiler::scope fields(profiler::phase::fields, kinds);
+        emit_entries(file, 0, buffer.count);
+        return;
+    }
+
+    const size_t window_entries = std::max(ranges * min_range, window_bytes / entry_size);
+    std::vector<char> window(std::min(window_entries, buffer.count) * entry_size);
+    std::vector<std::exception_ptr> errors(ranges);
+    for (size_t begin = 0; begin < buffer.count; begin += window_entries) {
+        const size_t count = std::min(window_entries, buffer.count - begin);
+        emit_pool->run(ranges, [&](size_t r) {
+            const size_t first = count * r / ranges;
+            const size_t last = count * (r + 1) / ranges;
+            try {
+                profiler::scope fields(profiler::phase::fields, kinds);
+                regionBuffer region(window.data() + first * entry_size, (last - first) * entry_size);
+                std::ostream out(&region);
+                emit_entries(out, begin + first, begin + last);
+                if (!out || !region.full()) throw std::logic_error("emitted range does not match entry size");
+            }
+            catch (...) {
+                errors[r] = std::current_exception();
+            }
+        });
+        for (const std::exception_ptr& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+        file.write(window.data(), count * entry_size);
+    }
 }
 
-void mesh_compiler::compileUnit::put(std::ofstream& file, const aiMesh* mesh, const assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>& mw)
+void mesh_compiler::compileUnit::put(std::ostream& file, const aiMesh* mesh)
 {
-    if (this->count_type != counting_type::per_mesh) throw meshCompilerException("invalid compilation unit for this object");
-    // fill counts
-    for (compileBuffer& buffer : this->buffers) {
-        if (buffer.count_type == counting_type::per_indice) buffer.count = mesh->mNumFaces;
-        else if (buffer.count_type == counting_type::per_vertex) buffer.count = mesh->mNumVertices;
-        else if (buffer.count_type == counting_type::per_mesh_bone) buffer.count = mesh->mNumBones;
-        else {
-            throw std::logic_error("invalid counting type for scene object" + countingTypeNamesMap[buffer.count_type]);
-        }
+    if (uses(value::bone_id) || uses(value::bone_weight)) {
+        profiler::scope weights(profiler::phase::weights);
+        assimp::meshWeights<int, float, MAX_BONE_INFLUENCE> mw(mesh);
+        weights.stop();
+        put(file, mesh, mw);
     }
+    else put(file, mesh, assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>());
+}
+
+void mesh_compiler::compileUnit::put(std::ostream& file, const aiMesh* mesh, const assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>& mw)
+{
+    fillCounts(mesh);
+    countBytes();
+    tracer::span trace("put", name);
+    trace.arg("object", mesh->mName.C_Str());
+    trace.arg("entries", get_entries_count());
 
     // preamble
     for (const compileField& field : this->preamble) {
@@ -944,62 +1122,133 @@ void mesh_compiler::compileUnit::put(std::ofstream& file, const aiMesh* mesh, co
         }
 
         // fields
-        for (unsigned int j = 0; j < buffer.count; ++j) {
-            for (const compileField& field : buffer.fields) {
-                switch (field.vtype)
-                {
-                case value::constant:
-                    file.write(field.data.data(), typeSizesMap[field.stype]);
-                    break;
-                case value::indice:
-                    writeConst(file, mesh->mFaces[j].mIndices[field.data[0]], field.stype);
-                    break;
-                case value::vertex:
-                    writeConst(file, mesh->mVertices[j][field.data[0]], field.stype);
-                    break;
-                case value::normal:
-                    writeConst(file, mesh->mNormals[j][field.data[0]], field.stype);
-                    break;
-                case value::uv:
-                    writeConst(file, mesh->mTextureCoords[field.data[0]][j][field.data[1]], field.stype);
-                    break;
-                case value::tangent:
-                    writeConst(file, mesh->mTangents[j][field.data[0]], field.stype);
-                    break;
-                case value::bitangent:
-                    writeConst(file, mesh->mBitangents[j][field.data[0]], field.stype);
-                    break;
-                case value::vertex_color:
-                    writeConst(file, mesh->mColors[field.data[0]][j][field.data[1]], field.stype);
-                    break;
-                case value::bone_id:
-                    writeConst(file, mw.vertices[j].bone_ids[field.data[0]], field.stype);
-                    break;
-                case value::bone_weight:
-                    writeConst(file, mw.vertices[j].weights[field.data[0]], field.stype);
-                    break;
-                default:
-                    throw std::logic_error("invalid value");
-                    break;
-                }
+        putRanges(file, buffer, [&](std::ostream& out, const size_t& first, const size_t& last) { putEntries(out, buffer, mesh, mw, first, last); });
+    }
+}
+
+void mesh_compiler::compileUnit::putEntries(std::ostream& file, const compileBuffer& buffer, const aiMesh* mesh, const assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>& mw, const size_t& first, const size_t& last) const
+{
+    for (size_t j = first; j < last; ++j) {
+        for (const compileField& field : buffer.fields) {
+            switch (field.vtype)
+            {
+            case value::constant:
+                file.write(field.data.data(), typeSizesMap[field.stype]);
+                break;
+            case value::indice:
+                writeConst(file, mesh->mFaces[j].mIndices[field.data[0]], field.stype);
+                break;
+            case value::vertex:
+                writeConst(file, mesh->mVertices[j][field.data[0]], field.stype);
+                break;
+            case value::normal:
+                writeConst(file, mesh->mNormals[j][field.data[0]], field.stype);
+                break;
+            case value::uv:
+                writeConst(file, mesh->mTextureCoords[field.data[0]][j][field.data[1]], field.stype);
+                break;
+            case value::tangent:
+                writeConst(file, mesh->mTangents[j][field.data[0]], field.stype);
+                break;
+            case value::bitangent:
+                writeConst(file, mesh->mBitangents[j][field.data[0]], field.stype);
+                break;
+            case value::vertex_color:
+                writeConst(file, mesh->mColors[field.data[0]][j][field.data[1]], field.stype);
+                break;
+            case value::bone_id:
+                writeConst(file, mw.vertices[j].bone_ids[field.data[0]], field.stype);
+                break;
+            case value::bone_weight:
+                writeConst(file, mw.vertices[j].weights[field.data[0]], field.stype);
+                break;
+            default:
+                throw std::logic_error("invalid value");
+                break;
             }
         }
     }
 }
 
-void mesh_compiler::compileUnit::put(std::ofstream& file, const aiScene* scene)
+void mesh_compiler::compileUnit::put(std::ostream& file, const glb_reader::meshView& mesh)
 {
-    if (this->count_type != counting_type::per_scene) throw meshCompilerException("invalid compilation unit for this object");
+    fillCounts(mesh);
+    countBytes();
+    tracer::span trace("put", name);
+    trace.arg("object", mesh.name);
+    trace.arg("entries", get_entries_count());
 
-    // fill counts
-    for (compileBuffer& buffer : this->buffers) {
-        if (buffer.count_type == counting_type::per_mesh) buffer.count = scene->mNumMeshes;
-        else if (buffer.count_type == counting_type::per_skeleton) buffer.count = scene->mNumSkeletons;
-        else if (buffer.count_type == counting_type::per_animation) buffer.count = scene->mNumAnimations;
-        else {
-            throw std::logic_error("invalid counting type for this mesh" + countingTypeNamesMap[buffer.count_type]);
+    // preamble
+    for (const compileField& field : this->preamble) {
+        if (field.vtype == value::other_unit) (*unitsMap)[field.get_otherUnitName()].put(file, mesh);
+        else field.put(file, *this);
+    }
+
+    // buffers
+    for (const compileBuffer& buffer : this->buffers) {
+
+        // buffer preamble
+        for (const compileField& field : buffer.preamble) {
+            if (field.vtype == value::other_unit) (*unitsMap)[field.get_otherUnitName()].put(file, mesh);
+            else field.put(file, buffer);
+        }
+
+        // fields
+        putRanges(file, buffer, [&](std::ostream& out, const size_t& first, const size_t& last) { putEntries(out, buffer, mesh, first, last); });
+    }
+}
+
+void mesh_compiler::compileUnit::putEntries(std::ostream& file, const compileBuffer& buffer, const glb_reader::meshView& mesh, const size_t& first, const size_t& last) const
+{
+    for (size_t j = first; j < last; ++j) {
+        for (const compileField& field : buffer.fields) {
+            switch (field.vtype)
+            {
+            case value::constant:
+                file.write(field.data.data(), typeSizesMap[field.stype]);
+                break;
+            case value::indice:
+                writeConst(file, mesh.get_index(j, field.data[0]), field.stype);
+                break;
+            case value::vertex:
+                writeConst(file, mesh.positions.get(j, field.data[0]), field.stype);
+                break;
+            case value::normal:
+                writeConst(file, mesh.normals.get(j, field.data[0]), field.stype);
+                break;
+            case value::uv:
+                writeConst(file, mesh.get_uv(field.data[0], j, field.data[1]), field.stype);
+                break;
+            case value::tangent:
+                writeConst(file, mesh.tangents.get(j, field.data[0]), field.stype);
+                break;
+            case value::bitangent:
+                writeConst(file, mesh.get_bitangent(j, field.data[0]), field.stype);
+                break;
+            case value::vertex_color:
+                writeConst(file, mesh.get_color(field.data[0], j, field.data[1]), field.stype);
+                break;
+            case value::bone_id:
+                writeConst(file, mesh.get_bone_id(j, field.data[0]), field.stype);
+                break;
+            case value::bone_weight:
+                writeConst(file, mesh.get_bone_weight(j, field.data[0]), field.stype);
+                break;
+            default:
+                throw std::logic_error("invalid value");
+                break;
+            }
         }
     }
+}
+
+void mesh_compiler::compileUnit::put(std::ostream& file, const aiScene* scene)
+{
+    fillCounts(scene);
+    countBytes();
+    tracer::span trace("put", name);
+    trace.arg("object", scene->mName.C_Str());
+    trace.arg("entries", get_entries_count());
 
     // preamble
     for (const compileField& field : this->preamble) {
@@ -1056,13 +1305,23 @@ bool mesh_compiler::compileUnit::operator!=(const compileUnit& other) const
     return !(*this == other);
 }
 
+void mesh_compiler::compileUnit::appendKey(std::string& key) const
+{
+    key += static_cast<char>(count_type);
+    appendSize(key, preamble.size());
+    for (const compileField& field : preamble) field.appendKey(key);
+    appendSize(key, buffers.size());
+    for (const compileBuffer& buffer : buffers) buffer.appendKey(key);
+}
+
 mesh_compiler::type mesh_compiler::compileUnit::extractType(std::string& word)
 {
     type t = mc_none;
     size_t pos = word.find(':');
     if (pos != std::string::npos) {
-        if (typesMap.find(word.substr(0, pos)) == typesMap.end()) throw formatInterpreterException(formatInterpreterException::error_code::invalid_type_specifier);
-        t = typesMap[word.substr(0, pos)];
+        const type* found = typesMap.find(std::string_view(word).substr(0, pos));
+        if (found == nullptr) throw formatInterpreterException(formatInterpreterException::error_code::invalid_type_specifier);
+        t = *found;
         word = word.substr(pos + 1, word.size() - pos - 1);
     }
 
@@ -1077,8 +1336,8 @@ mesh_compiler::type mesh_compiler::compileUnit::extractType(std::string& word)
 mesh_compiler::value mesh_compiler::compileUnit::extractPreambleValue(std::string& word)
 {
     value v = value::null;
-    if (preambleMap.find(word) != preambleMap.end()) {
-        v = preambleMap[word];
+    if (const value* found = preambleMap.find(word)) {
+        v = *found;
         word = "";
     }
     return v;
@@ -1093,8 +1352,8 @@ mesh_compiler::value mesh_compiler::compileUnit::extractFieldValue(std::string&
         ftype = word.substr(0, pos);
     }
     else pos = word.size();
-    if (fieldsMap.find(ftype) != fieldsMap.end()) {
-        v = fieldsMap[ftype];
+    if (const value* found = fieldsMap.find(ftype)) {
+        v = *found;
         word = word.substr(pos, word.size() - pos);
     }
     return v;
@@ -1122,7 +1381,7 @@ bool mesh_compiler::compileUnit::isFieldValue(type t, std::string& arg, std::vec
         counting_type ffc = getFieldCount(field.vtype);
         if (ffc != counting_type::null) {
             if (ffc != field_count && field_count != counting_type::null) {
-                throw formatInterpreterException(formatInterpreterException::error_code::conflicting_buffer_fields, " conflicting types: " + valueNamesMap[field.vtype] + " and " + countingTypeNamesMap[field_count]);
+                throw formatInterpreterException(formatInterpreterException::error_code::conflicting_buffer_fields, std::string(" conflicting types: ") + valueNamesMap[field.vtype] + " and " + countingTypeNamesMap[field_count]);
             }
             field_count = ffc;
         }
@@ -1130,7 +1389,7 @@ bool mesh_compiler::compileUnit::isFieldValue(type t, std::string& arg, std::vec
         // unit counting type
         ffc = getParentCountingType(field_count);
         if (unit_count == counting_type::null) unit_count = ffc;
-        else if (unit_count != ffc) throw formatInterpreterException(formatInterpreterException::error_code::conflicting_unit_fields, " conflicting types: " + countingTypeNamesMap[ffc] + " and " + countingTypeNamesMap[unit_count]);
+        else if (unit_count != ffc) throw formatInterpreterException(formatInterpreterException::error_code::conflicting_unit_fields, std::string(" conflicting types: ") + countingTypeNamesMap[ffc] + " and " + countingTypeNamesMap[unit_count]);
 
         std::vector<unsigned short> suffixes_data = getMaxSuffixes(v);
         while (arg.size() > 0) {
@@ -1139,9 +1398,9 @@ bool mesh_compiler::compileUnit::isFieldValue(type t, std::string& arg, std::vec
                 else throw formatInterpreterException(formatInterpreterException::error_code::unknown_statement);
             }
             if (arg[0] != '.') throw formatInterpreterException(formatInterpreterException::error_code::unknown_statement);
-            if (suffixesMap.find(arg[1]) == suffixesMap.end()) throw formatInterpreterException(formatInterpreterException::error_code::invalid_suffix);
+            if (suffixesMap[static_cast<unsigned char>(arg[1])] < 0) throw formatInterpreterException(formatInterpreterException::error_code::invalid_suffix);
 
-            field.data.push_back(suffixesMap[arg[1]]);
+            field.data.push_back(suffixesMap[static_cast<unsigned char>(arg[1])]);
             if (field.data.size() > suffixes_data.size()) throw formatInterpreterException(formatInterpreterException::error_code::wrong_suffixes_amount, "this field type requires up to " + std::to_string(suffixes_data.size()) + " suffixes");
             if (field.data.back() >= suffixes_data[field.data.size() - 1]) throw formatInterpreterException(formatInterpreterException::error_code::invalid_suffix, arg.substr(0, 2) + " suffix must be less than " + std::to_string(suffixes_data[field.data.size() - 1]));
 
@@ -1183,7 +1442,7 @@ bool mesh_compiler::compileUnit::isOtherUnitValue(const type& t, std::string& ar
     if (unitsMap.find(arg) != unitsMap.end()) {
         if (t != type::mc_none) throw formatInterpreterException(formatInterpreterException::error_code::unsupported_type, "units dont have types");
         if (count_type == counting_type::null) count_type = unitsMap[arg].count_type;
-        else if (count_type != unitsMap[arg].count_type) throw formatInterpreterException(formatInterpreterException::error_code::conflicting_unit_fields, "conflicting types: " + countingTypeNamesMap[unitsMap[arg].count_type] + " and " + countingTypeNamesMap[count_type]);
+        else if (count_type != unitsMap[arg].count_type) throw formatInterpreterException(formatInterpreterException::error_code::conflicting_unit_fields, std::string("conflicting types: ") + countingTypeNamesMap[unitsMap[arg].count_type] + " and " + countingTypeNamesMap[count_type]);
         fields.push_back(compileField(type::mc_unit, value::other_unit, arg.data(), arg.size()));
         arg = "";
         return true;
@@ -1296,10 +1555,12 @@ mesh_compiler::compileUnit::compileUnit(std::ifstream& file, size_t& line_num, /
 
 mesh_compiler::fileUnit::fileUnit(std::ifstream& file, const std::string& output_file_, size_t& line_num, /*const*/ std::map<std::string, compileUnit>* unitsMap) : compileUnit(file, line_num, unitsMap), output_file(output_file_)
 {
+    name = "file " + output_file_;
 }
 
 mesh_compiler::compilationInfo::compilationInfo(const std::string& format_file, const bool& debug_messages) : debug_messages(debug_messages)
 {
+    profiler::scope parse(profiler::phase::format_parse, format_file);
     std::ifstream formatFile(format_file, std::ios::in);
     if (!formatFile) {
         throw std::runtime_error("could not open file: " + format_file);
@@ -1326,9 +1587,10 @@ mesh_compiler::compilationInfo::compilationInfo(const std::string& format_file,
             }
             else {
                 if (units.find(word) != units.end()) throw formatInterpreterException(formatInterpreterException::error_code::unit_redefinition, line_num, arg);
-                if (preambleMap.find(word) != preambleMap.end()) throw formatInterpreterException(formatInterpreterException::error_code::name_keyword_collision, line_num, arg);
-                if (fieldsMap.find(word) != fieldsMap.end()) throw formatInterpreterException(formatInterpreterException::error_code::name_keyword_collision, line_num, arg);
+                if (preambleMap.contains(word)) throw formatInterpreterException(formatInterpreterException::error_code::name_keyword_collision, line_num, arg);
+                if (fieldsMap.contains(word)) throw formatInterpreterException(formatInterpreterException::error_code::name_keyword_collision, line_num, arg);
                 this->units.emplace(word, compileUnit(formatFile, line_num, &units));
+                this->units[word].name = word;
                 if (this->debug_messages) {
                     std::cout << word << " ";
                     this->units[word].print();
@@ -1341,22 +1603,104 @@ mesh_compiler::compilationInfo::compilationInfo(const std::string& format_file,
     if (debug_messages) std::cout << "format file compilation succeded\n";
 }
 
-// ========== COMPILER FUNCTION DEFINITIONS ==========
+mesh_compiler::compilationInfo::compilationInfo(const compilationInfo& other) :
+    debug_messages(other.debug_messages), units(other.units), file_units(other.file_units)
+{
+    for (auto& unit : units) unit.second.unitsMap = &units;
+    for (fileUnit& fu : file_units) fu.unitsMap = &units;
+}
 
-void mesh_compiler::run(int argc, char** argv)
+mesh_compiler::compilationInfo& mesh_compiler::compilationInfo::operator=(const compilationInfo& other)
 {
-    if (argc == 1) {
-        std::string line = "";
-        while (1) {
-            std::cout << "> ";
-            std::getline(std::cin, line);
-            if (line == "q") return;
-            std::vector<std::string> args;
-            std::stringstream ss(line);
-            while (ss) {
-                std::string a;
-                ss >> a;
-                if (!a.empty()) args.push_back(a);
+    debug_messages = other.debug_messages;
+    units = other.units;
+    file_units = other.file_units;
+    for (auto& unit : units) unit.second.unitsMap = &units;
+    for (fileUnit& fu : file_units) fu.unitsMap = &units;
+    return *this;
+}
+
+std::string mesh_compiler::compilationInfo::get_cache_key() const
+{
+    std::string key;
+    appendSize(key, units.size());
+    for (const auto& unit : units) {
+        appendSize(key, unit.first.size());
+        key += unit.first;
+        unit.second.appendKey(key);
+    }
+    appendSize(key, file_units.size());
+    for (const fileUnit& fu : file_units) {
+        appendSize(key, fu.output_file.size());
+        key += fu.output_file;
+        fu.appendKey(key);
+    }
+    return key;
+}
+
+bool mesh_compiler::compilationInfo::uses(const value& v) const
+{
+    for (const fileUnit& fu : file_units) {
+        if (fu.uses(v)) return true;
+    }
+    return false;
+}
+
+bool mesh_compiler::compilationInfo::uses(const counting_type& ct) const
+{
+    for (const fileUnit& fu : file_units) {
+        if (fu.uses(ct)) return true;
+    }
+    return false;
+}
+
+assimp::importSettings mesh_compiler::compilationInfo::get_import_settings() const
+{
+    assimp::importSettings import(0);
+
+    // since v2.2.0, formats that compile no per vertex or per indice data are no longer triangulated or sorted
+    // and stripped components are gone from the imported scene, which can change their output bytes,
+    // --pp default restores the fixed steps of earlier versions
+    // only file units and units they reference ever get compiled
+    bool mesh_data = uses(counting_type::per_vertex) || uses(counting_type::per_indice);
+    bool tangents = uses(value::tangent) || uses(value::bitangent);
+    bool bones = uses(value::bone_id) || uses(value::bone_weight) || uses(value::offset_matrix) ||
+        uses(counting_type::per_mesh_bone) || uses(counting_type::per_bone) || uses(counting_type::per_skeleton);
+    bool animations = uses(counting_type::per_animation) || uses(counting_type::per_animation_channel);
+
+    // joining stays whenever vertices are compiled, otherwise vertex counts would change
+    if (mesh_data) import.flags |= aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_JoinIdenticalVertices;
+    if (tangents) import.flags |= aiProcess_CalcTangentSpace;
+
+    // tangent space calculation needs normals and texture coordinates
+    import.removed_components = aiComponent_TEXTURES | aiComponent_LIGHTS | aiComponent_CAMERAS | aiComponent_MATERIALS;
+    if (!tangents) import.removed_components |= aiComponent_TANGENTS_AND_BITANGENTS;
+    if (!tangents && !uses(value::normal)) import.removed_components |= aiComponent_NORMALS;
+    if (!tangents && !uses(value::uv)) import.removed_components |= aiComponent_TEXCOORDS;
+    if (!uses(value::vertex_color)) import.removed_components |= aiComponent_COLORS;
+    if (!bones) import.removed_components |= aiComponent_BONEWEIGHTS;
+    if (!animations) import.removed_components |= aiComponent_ANIMATIONS;
+    import.flags |= aiProcess_RemoveComponent;
+
+    return import;
+}
+
+// ========== COMPILER FUNCTION DEFINITIONS ==========
+
+void mesh_compiler::run(int argc, char** argv)
+{
+    if (argc == 1) {
+        std::string line = "";
+        while (1) {
+            std::cout << "> ";
+            std::getline(std::cin, line);
+            if (line == "q") return;
+            std::vector<std::string> args;
+            std::stringstream ss(line);
+            while (ss) {
+                std::string a;
+                ss >> a;
+                if (!a.empty()) args.push_back(a);
             }
             runOnce(args);
         }
@@ -1401,31 +1745,379 @@ void mesh_compiler::compile(const std::vector<std::string>& args)
     if (siz == 0) {
         throw std::runtime_error("source file not specified");
     }
+    if (args[0] == "--merge") {
+        if (siz < 3) throw std::runtime_error("unspecified indexes: --merge <index> <partial index> [<partial index> ...]");
+        mergeIndexes(args[1], std::vector<std::string>(args.begin() + 2, args.end()));
+        return;
+    }
 
-    std::string format_file = ".format";
-    bool format_specified = false;
+    std::vector<std::string> format_files;
     bool debug_messages = false;
+    bool inspect = false;
+    std::string import_overrides = "";
+    bool mapped_io = true;
+    bool native_import = true;
+    std::string hint = "";
+    bool to_stdout = false;
+    size_t memory_limit = 0;
+    std::string source_format = "";
+    std::string transcode_format = "";
+    bool batch = false;
+    std::string glob = "";
+    unsigned int jobs = 0;
+    std::array<unsigned int, 3> stage_jobs = { 0, 0, 0 };
+    unsigned int emit_jobs = 0;
+    unsigned int shard = 0;
+    unsigned int shard_count = 0;
+    std::string index = "";
+    std::string cache_directory = "";
+    size_t cache_size = 0;
+    bool cache_hardlinks = false;
+    std::string scene_cache_directory = "";
+    size_t scene_cache_size = 0;
+    bool profile = false;
+    bool profile_steps = false;
+    bool hardware_counters = false;
+    bool track_allocations = false;
+    bool dry_run = false;
+    std::string stats_file = "";
+    std::string trace_file = "";
 
     for (int i = 1; i < siz; ++i) {
         if (args[i] == "-f") {
             ++i;
             if (i == siz) throw std::runtime_error("unspecified format file: -f <format file path>");
-            if (format_specified) throw std::runtime_error("format file specified more than once");
-            format_file = args[i];
-            format_specified = true;
+            if (std::find(format_files.begin(), format_files.end(), args[i]) != format_files.end()) throw std::runtime_error("format file specified more than once: " + args[i]);
+            format_files.push_back(args[i]);
         }
         else if (args[i] == "-d") {
             if (debug_messages) throw std::runtime_error("-d flag specified more than once");
             debug_messages = true;
         }
+        else if (args[i] == "--pp") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified post processing steps: --pp <default|+step|-step,...>");
+            if (!import_overrides.empty()) throw std::runtime_error("--pp specified more than once");
+            import_overrides = args[i];
+        }
+        else if (args[i] == "--hint") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified format hint: --hint <file extension>");
+            if (!hint.empty()) throw std::runtime_error("--hint specified more than once");
+            hint = args[i];
+        }
+        else if (args[i] == "--memory-limit") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified memory limit: --memory-limit <bytes[K|M|G]>");
+            if (memory_limit != 0) throw std::runtime_error("--memory-limit specified more than once");
+            memory_limit = parseMemorySize(args[i]);
+        }
+        else if (args[i] == "--from") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified source format file: --from <format file path>");
+            if (!source_format.empty()) throw std::runtime_error("--from specified more than once");
+            source_format = args[i];
+        }
+        else if (args[i] == "--transcode") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified source format file: --transcode <format file path>");
+            if (!transcode_format.empty()) throw std::runtime_error("--transcode specified more than once");
+            transcode_format = args[i];
+        }
+        else if (args[i] == "--batch") {
+            if (batch) throw std::runtime_error("--batch flag specified more than once");
+            batch = true;
+        }
+        else if (args[i] == "--glob") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified file pattern: --glob <pattern>");
+            if (!glob.empty()) throw std::runtime_error("--glob specified more than once");
+            glob = args[i];
+        }
+        else if (args[i] == "--jobs") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified job count: --jobs <threads>");
+            if (jobs != 0) throw std::runtime_error("--jobs specified more than once");
+            jobs = parseJobCount(args[i]);
+        }
+        else if (args[i] == "--emit-jobs") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified emission thread count: --emit-jobs <threads>");
+            if (emit_jobs != 0) throw std::runtime_error("--emit-jobs specified more than once");
+            emit_jobs = parseJobCount(args[i]);
+        }
+        else if (args[i] == "--pipeline") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified stage worker counts: --pipeline <import>,<emit>,<write>");
+            if (stage_jobs[0] != 0) throw std::runtime_error("--pipeline specified more than once");
+            stage_jobs = parseStageJobs(args[i]);
+        }
+        else if (args[i] == "--shard") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified shard: --shard <index>/<count>");
+            if (shard_count != 0) throw std::runtime_error("--shard specified more than once");
+            parseShard(args[i], shard, shard_count);
+        }
+        else if (args[i] == "--index") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified index file: --index <file>");
+            if (!index.empty()) throw std::runtime_error("--index specified more than once");
+            index = args[i];
+        }
+        else if (args[i] == "--cache") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified cache directory: --cache <directory>");
+            if (!cache_directory.empty()) throw std::runtime_error("--cache specified more than once");
+            cache_directory = args[i];
+        }
+        else if (args[i] == "--cache-size") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified cache size: --cache-size <bytes[K|M|G]>");
+            if (cache_size != 0) throw std::runtime_error("--cache-size specified more than once");
+            cache_size = parseMemorySize(args[i]);
+        }
+        else if (args[i] == "--scene-cache") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified scene cache directory: --scene-cache <directory>");
+            if (!scene_cache_directory.empty()) throw std::runtime_error("--scene-cache specified more than once");
+            scene_cache_directory = args[i];
+        }
+        else if (args[i] == "--scene-cache-size") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified scene cache size: --scene-cache-size <bytes[K|M|G]>");
+            if (scene_cache_size != 0) throw std::runtime_error("--scene-cache-size specified more than once");
+            scene_cache_size = parseMemorySize(args[i]);
+        }
+        else if (args[i] == "--cache-hardlink") {
+            if (cache_hardlinks) throw std::runtime_error("--cache-hardlink flag specified more than once");
+            cache_hardlinks = true;
+        }
+        else if (args[i] == "--stdout") {
+            if (to_stdout) throw std::runtime_error("--stdout flag specified more than once");
+            to_stdout = true;
+        }
+        else if (args[i] == "--no-native") {
+            if (!native_import) throw std::runtime_error("--no-native flag specified more than once");
+            native_import = false;
+        }
+        else if (args[i] == "--no-mmap") {
+            if (!mapped_io) throw std::runtime_error("--no-mmap flag specified more than once");
+            mapped_io = false;
+        }
+        else if (args[i] == "--inspect") {
+            if (inspect) throw std::runtime_error("--inspect flag specified more than once");
+            inspect = true;
+        }
+        else if (args[i] == "--profile") {
+            if (profile) throw std::runtime_error("--profile flag specified more than once");
+            profile = true;
+        }
+        else if (args[i] == "--profile-steps") {
+            if (profile_steps) throw std::runtime_error("--profile-steps flag specified more than once");
+            profile_steps = true;
+        }
+        else if (args[i] == "--perf-counters") {
+            if (hardware_counters) throw std::runtime_error("--perf-counters flag specified more than once");
+            hardware_counters = true;
+        }
+        else if (args[i] == "--track-allocations") {
+            if (track_allocations) throw std::runtime_error("--track-allocations flag specified more than once");
+            track_allocations = true;
+        }
+        else if (args[i] == "--dry-run") {
+            if (dry_run) throw std::runtime_error("--dry-run flag specified more than once");
+            dry_run = true;
+        }
+        else if (args[i] == "--stats-json") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified stats file: --stats-json <file>");
+            if (!stats_file.empty()) throw std::runtime_error("--stats-json specified more than once");
+            stats_file = args[i];
+        }
+        else if (args[i] == "--trace") {
+            ++i;
+            if (i == siz) throw std::runtime_error("unspecified trace file: --trace <file>");
+            if (!trace_file.empty()) throw std::runtime_error("--trace specified more than once");
+            trace_file = args[i];
+        }
         else if (i == 1) {
-            format_file = args[i];
-            format_specified = true;
+            format_files.push_back(args[i]);
+        }
+    }
+    if (format_files.empty()) format_files.push_back(".format");
+    const std::string& format_file = format_files[0];
+    if (!source_format.empty() && !transcode_format.empty()) throw std::runtime_error("--from and --transcode can not be combined");
+    if (batch && inspect) throw std::runtime_error("--inspect can not be combined with --batch");
+    if (format_files.size() > 1 && (batch || inspect)) throw std::runtime_error("several format files can not be combined with --batch or --inspect");
+    if (format_files.size() > 1 && args[0] == "-") throw std::runtime_error("several format files can not be used when reading from stdin");
+    if (!batch && !glob.empty()) throw std::runtime_error("--glob needs --batch");
+    if (!batch && stage_jobs[0] != 0) throw std::runtime_error("--pipeline needs --batch");
+    if (jobs != 0 && stage_jobs[0] != 0) throw std::runtime_error("--jobs and --pipeline can not be combined");
+    if (!batch && shard_count != 0) throw std::runtime_error("--shard needs --batch");
+    if (!batch && !index.empty()) throw std::runtime_error("--index needs --batch");
+    if (cache_directory.empty() && (cache_size != 0 || cache_hardlinks)) throw std::runtime_error("--cache-size and --cache-hardlink need --cache");
+    if (scene_cache_directory.empty() && scene_cache_size != 0) throw std::runtime_error("--scene-cache-size needs --scene-cache");
+    if (profile_steps && !profile) throw std::runtime_error("--profile-steps needs --profile");
+    if (hardware_counters && !profile) throw std::runtime_error("--perf-counters needs --profile");
+    if (track_allocations && !profile) throw std::runtime_error("--track-allocations needs --profile");
+    if (dry_run && (batch || inspect || to_stdout)) throw std::runtime_error("--dry-run can not be combined with --batch, --inspect or --stdout");
+    if (dry_run && (memory_limit != 0 || !transcode_format.empty())) throw std::runtime_error("--dry-run can not be combined with --memory-limit or --transcode");
+    if (dry_run && args[0] == "-") throw std::runtime_error("--dry-run needs a source file");
+
+    // with --stdout all messages go to stderr, stdout only carries output frames
+    class coutRestore {
+    public:
+        std::streambuf* buf;
+        ~coutRestore() { std::cout.rdbuf(buf); }
+    } restore{ std::cout.rdbuf() };
+    std::ostream stdout_stream(std::cout.rdbuf());
+    if (to_stdout) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    // a later run in the same process starts from nothing
+    class measureRestore {
+    public:
+        ~measureRestore()
+        {
+            profiler::disable();
+            compile_stats::disable();
+            tracer::disable();
         }
+    } measure_restore;
+    if (profile) profiler::enable();
+    if (track_allocations) alloc_tracker::enable();
+    std::string counters_unavailable;
+    if (hardware_counters && !perf_counters::enable(counters_unavailable)) std::cout << "hardware counters unavailable: " << counters_unavailable << "\n";
+    // phase times in the report come from profiler, so stats also turn on in memory emission
+    if (!stats_file.empty()) {
+        compile_stats::enable();
+        profiler::enable();
     }
+    if (!trace_file.empty()) tracer::enable();
+
     try {
         try {
-            compileFile(args[0], compilationInfo(format_file, debug_messages));
+            compileSettings settings;
+            settings.import.mapped_io = mapped_io;
+            settings.import.report_time = debug_messages;
+            settings.import.measure_steps = profile_steps;
+            settings.native_import = native_import;
+            settings.memory_limit = memory_limit;
+            // one pool for the whole run, batch already keeps every core busy
+            const unsigned int emit_threads = emit_jobs != 0 ? emit_jobs : batch ? 1 : thread_pool::defaultSize();
+            std::unique_ptr<thread_pool> emit_pool;
+            if (emit_threads > 1) emit_pool.reset(new thread_pool(emit_threads));
+            settings.emit_pool = emit_pool.get();
+            settings.source_format = source_format;
+            if (!transcode_format.empty()) {
+                settings.source_format = transcode_format;
+                settings.transcode = true;
+            }
+            if (to_stdout) settings.output_stream = &stdout_stream;
+
+            // hard linked outputs share their data with the cache, they must be replaced and never edited in place
+            std::unique_ptr<compile_cache> cache;
+            if (!cache_directory.empty()) {
+                cache.reset(new compile_cache(cache_directory, cache_size != 0 ? cache_size : 5ull << 30, cache_hardlinks));
+                settings.cache = cache.get();
+            }
+            std::unique_ptr<compile_cache> scene_cache;
+            if (!scene_cache_directory.empty()) {
+                scene_cache.reset(new compile_cache(scene_cache_directory, scene_cache_size != 0 ? scene_cache_size : 20ull << 30, false));
+                settings.scene_cache = scene_cache.get();
+            }
+
+            if (inspect) mesh_decoder(format_file).decode(args[0]).print();
+            else if (batch) {
+                assimp::importSettings check;
+                applyImportOverrides(check, import_overrides); // report bad --pp once instead of once per file
+                const bool directory = std::filesystem::is_directory(args[0]);
+                std::vector<batchTask> tasks = directory ? listDirectory(args[0], glob.empty() ? "*" : glob, format_file) : readManifest(args[0], format_file);
+                for (const batchTask& task : tasks) compile_stats::addInput(task.source);
+                checkBatchOutputs(tasks); // before sharding so every node rejects the same list
+                const std::string shard_name = shard_count == 0 ? "" : std::to_string(shard) + "/" + std::to_string(shard_count);
+                if (shard_count != 0) {
+                    const size_t all = tasks.size();
+                    tasks = selectShard(tasks, directory ? args[0] : "", shard, shard_count);
+                    std::cout << "shard " << shard_name << ": " << tasks.size() << " out of " << all << " inputs\n";
+                    // partial index next to the input list unless told otherwise, so nodes on a shared mount never collide
+                    if (index.empty()) {
+                        std::string input = args[0];
+                        while (input.size() > 1 && (input.back() == '/' || input.back() == '\\')) input.pop_back();
+                        index = input + "." + std::to_string(shard) + "-of-" + std::to_string(shard_count) + ".index";
+                    }
+                }
+
+                std::vector<batchResult> results;
+                if (stage_jobs[0] != 0) results = compilePipelined(tasks, import_overrides, settings, stage_jobs);
+                else results = compileBatch(tasks, import_overrides, settings, jobs == 0 ? thread_pool::defaultSize() : jobs);
+
+                // failed sources are left out, their partial outputs are not trustworthy
+                if (!index.empty()) {
+                    std::vector<std::pair<std::string, std::string>> entries;
+                    for (size_t i = 0; i < tasks.size(); ++i) {
+                        if (!results[i].error.empty()) continue;
+                        for (const std::string& output : results[i].outputs) entries.emplace_back(tasks[i].source, output);
+                    }
+                    writeIndex(index, shard_name, entries);
+                }
+            }
+            else if (dry_run) {
+                // caches are left out, a scene cache lookup may store an entry
+                settings.cache = nullptr;
+                settings.scene_cache = nullptr;
+                compile_stats::addInput(args[0]);
+                for (const std::string& file : format_files) {
+                    compilationInfo ci(file, debug_messages);
+                    compileSettings format_settings = settings;
+                    applyFormatImport(format_settings, ci, import_overrides);
+                    dryRun(args[0], ci, format_settings, std::cout);
+                }
+            }
+            else if (format_files.size() > 1) {
+                compile_stats::addInput(args[0]);
+                std::vector<compilationInfo> formats;
+                for (const std::string& file : format_files) formats.emplace_back(file, debug_messages);
+                compileFormats(args[0], formats, import_overrides, settings);
+            }
+            else {
+                compilationInfo ci(format_file, debug_messages);
+                applyFormatImport(settings, ci, import_overrides);
+                if (debug_messages) std::cout << "import flags: 0x" << std::hex << settings.import.flags << ", removed components: 0x" << settings.import.removed_components << std::dec << "\n";
+                if (args[0] == "-") compileStdin(hint, ci, settings);
+                else {
+                    compile_stats::addInput(args[0]);
+                    compileFile(args[0], ci, settings);
+                }
+            }
+            auto print_cache = [](const std::string& name, const compile_cache& c, const std::string& directory) {
+                const compile_cache::stats st = c.get_stats();
+                std::cout << name << ": " << st.hits << " hits, " << st.misses << " misses, " << st.stores << " stores, " << st.evictions << " evictions, "
+                    << st.bytes / 1024 << " KiB in " << directory << "\n";
+            };
+            if (cache && (batch || debug_messages)) print_cache("cache", *cache, cache_directory);
+            if (scene_cache && (batch || debug_messages)) print_cache("scene cache", *scene_cache, scene_cache_directory);
+            const assimp::importerStats importers = assimp::getImporterStats();
+            if (importers.created != 0 && (batch || debug_messages)) {
+                std::cout << "assimp importers: " << importers.created << " created, " << importers.reused << " reused, startup " << importers.startup_seconds
+                    << " s, teardown " << importers.teardown_seconds << " s\n";
+            }
+            if (profile) profiler::print(std::cout);
+            if (!stats_file.empty()) {
+                std::vector<compile_stats::cacheInfo> caches;
+                auto add_cache = [&](const std::string& name, const compile_cache& c) {
+                    const compile_cache::stats st = c.get_stats();
+                    caches.push_back(compile_stats::cacheInfo{ name, st.hits, st.misses, st.stores, st.evictions });
+                };
+                if (cache) add_cache("cache", *cache);
+                if (scene_cache) add_cache("scene cache", *scene_cache);
+                compile_stats::writeJson(stats_file, version, caches);
+            }
+            if (!trace_file.empty()) tracer::write(trace_file);
         }
         catch (formatInterpreterException& e) {
             std::cout << e.what() << std::endl;
@@ -1437,68 +2129,1339 @@ void mesh_compiler::compile(const std::vector<std::string>& args)
     }
 }
 
-void mesh_compiler::compileFile(const std::string& filename, compilationInfo ci)
+// overrides are comma separated: "default" restores fixed legacy flags, "+step" / "-step" add or remove a step
+void mesh_compiler::applyImportOverrides(assimp::importSettings& import, const std::string& overrides)
+{
+    std::stringstream ss(overrides);
+    std::string word;
+    while (std::getline(ss, word, ',')) {
+        if (word.empty()) continue;
+        if (word == "default") {
+            import = assimp::importSettings();
+            continue;
+        }
+        if (word[0] != '+' && word[0] != '-') throw std::runtime_error("post processing step must start with + or -: " + word);
+        std::string step = word.substr(1);
+        const unsigned int* flag = postProcessMap.find(step);
+        if (flag == nullptr) throw std::runtime_error("unknown post processing step: " + step);
+        if (word[0] == '+') import.flags |= *flag;
+        else import.flags &= ~*flag;
+    }
+}
+
+// format flags with --pp overrides on top, io settings stay as they were
+void mesh_compiler::applyFormatImport(compileSettings& settings, const compilationInfo& ci, const std::string& import_overrides)
+{
+    const assimp::importSettings io = settings.import;
+    settings.import = ci.get_import_settings();
+    applyImportOverrides(settings.import, import_overrides);
+    settings.import.mapped_io = io.mapped_io;
+    settings.import.report_time = io.report_time;
+    settings.import.measure_steps = io.measure_steps;
+}
+
+void mesh_compiler::compileMemory(const void* data, const size_t& size, const std::string& hint, const std::string& format_file, const std::string& name)
+{
+    // formatInterpreterException is private, callers get the same error type as the command line
+    try {
+        compilationInfo ci(format_file);
+        compileSettings settings;
+        settings.import = ci.get_import_settings();
+        compileMemory(data, size, hint, name, ci, settings);
+    }
+    catch (formatInterpreterException& e) {
+        throw std::runtime_error(e.what());
+    }
+}
+
+void mesh_compiler::expandFileName(fileUnit& fu, const std::string& filename)
+{
+    // replace {file} with file name in output file name
+    size_t found = fu.output_file.find("{file}");
+    if (found != std::string::npos) {
+        std::string base_filename = filename.substr(filename.find_last_of("/\\") + 1);
+        size_t const p(base_filename.find_last_of('.'));
+        fu.output_file.replace(found, 6, base_filename.substr(0, p));
+    }
+}
+
+// returns false if assimp could not import the file, it reports why by itself
+bool mesh_compiler::compileFile(const std::string& filename, compilationInfo ci, const compileSettings& settings)
+{
+    if (cacheable(settings)) return compileCached(filename, ci, settings);
+    if (!settings.source_format.empty()) {
+        if (settings.transcode) compileTranscoded(filename, ci, settings);
+        else compileOutput(filename, ci, settings);
+        return true;
+    }
+    bool imported = true;
+    for (fileUnit& fu : ci.file_units) {
+        expandFileName(fu, filename);
+        if (settings.memory_limit != 0) {
+            compileStreamed(filename, fu, settings);
+            continue;
+        }
+        auto process_scene = [&](const aiScene* scene) {
+            compile_stats::addScene(filename, scene);
+            compileScene(scene, fu, settings);
+        };
+        if (settings.native_import && compileGlb(filename, fu, settings)) continue;
+        if (settings.scene_cache != nullptr) {
+            std::unique_ptr<aiScene> scene(importScene(filename, settings));
+            if (scene) compileScene(scene.get(), fu, settings);
+            else imported = false;
+            continue;
+        }
+        if (settings.native_import && native_reader::readFile(filename, process_scene, settings.import)) continue;
+        if (!assimp::readFile(filename, process_scene, settings.import)) imported = false;
+    }
+    return imported;
+}
+
+// formats importing with the same settings share one import and their mesh units are emitted together,
+// sources compiled without a scene of their own (rebuilt, streamed, cached, glb views) go format by format
+bool mesh_compiler::compileFormats(const std::string& filename, const std::vector<compilationInfo>& formats, const std::string& import_overrides, const compileSettings& settings)
+{
+    class importGroup {
+    public:
+        compileSettings settings;
+        std::vector<fileUnit> units;
+    };
+
+    bool imported = true;
+    std::vector<importGroup> groups;
+    const bool shared = settings.source_format.empty() && settings.memory_limit == 0 && !cacheable(settings) && !(settings.native_import && glb_reader::isGlb(filename));
+    for (const compilationInfo& ci : formats) {
+        compileSettings format_settings = settings;
+        applyFormatImport(format_settings, ci, import_overrides);
+        if (!shared) {
+            if (!compileFile(filename, ci, format_settings)) imported = false;
+            continue;
+        }
+
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const importGroup& g) {
+            return g.settings.import.flags == format_settings.import.flags && g.settings.import.removed_components == format_settings.import.removed_components;
+        });
+        if (group == groups.end()) group = groups.insert(groups.end(), importGroup{ format_settings, {} });
+        for (fileUnit fu : ci.file_units) {
+            expandFileName(fu, filename);
+            group->units.push_back(fu);
+        }
+    }
+
+    for (const importGroup& group : groups) {
+        if (settings.import.report_time) std::cout << "import flags: 0x" << std::hex << group.settings.import.flags << ", removed components: 0x" << group.settings.import.removed_components << std::dec
+            << " (" << group.units.size() << " file units)\n";
+        std::unique_ptr<aiScene> scene(importScene(filename, group.settings));
+        if (!scene) {
+            imported = false;
+            continue;
+        }
+        std::vector<fileUnit> meshes;
+        for (const fileUnit& fu : group.units) {
+            if (fu.count_type == counting_type::per_mesh) meshes.push_back(fu);
+            else compileScene(scene.get(), fu, group.settings);
+        }
+        if (!meshes.empty()) compileMeshes(scene.get(), meshes, group.settings);
+    }
+    return imported;
+}
+
+// outputs are kept whole in memory until they are stored, streamed and rebuilt sources are compiled without the cache
+bool mesh_compiler::compileCached(const std::string& filename, const compilationInfo& ci, const compileSettings& settings)
+{
+    const std::string key = cacheKey(filename, ci, settings);
+    compileSettings uncached = settings;
+    uncached.cache = nullptr;
+    if (key.empty()) return compileFile(filename, ci, uncached);
+    if (restoreCached(key, settings)) return true;
+
+    std::vector<std::pair<std::string, std::string>> outputs;
+    uncached.output_sink = [&](const std::string& name, std::string& data) {
+        outputs.emplace_back(name, data);
+        if (settings.output_sink) settings.output_sink(name, data);
+        else writeOutput(name, settings, [&](std::ostream& out) { out.write(data.data(), data.size()); });
+    };
+    // an entry missing failed outputs would be restored later as if the compile had worked
+    size_t failed = 0;
+    uncached.failed_outputs = &failed;
+    if (!compileFile(filename, ci, uncached)) return false;
+    countFailed(settings, failed);
+    if (failed == 0) settings.cache->store(key, outputs);
+    return true;
+}
+
+bool mesh_compiler::cacheable(const compileSettings& settings)
+{
+    return settings.cache != nullptr && settings.source_format.empty() && settings.memory_limit == 0;
+}
+
+// source bytes, files it pulls in, parsed format, import settings and compiler version decide the outputs,
+// source file name too since it can be part of output names, empty if the source can not be cached
+std::string mesh_compiler::cacheKey(const std::string& filename, const compilationInfo& ci, const compileSettings& settings)
+{
+    std::vector<std::string> files;
+    if (!keyFiles(filename, files)) return "";
+    std::ostringstream salt;
+    salt << version << '\n' << settings.import.flags << ' ' << settings.import.removed_components << ' ' << settings.native_import << '\n';
+    salt << filename.substr(filename.find_last_of("/\\") + 1) << ' ' << files.size() << '\n';
+    return compile_cache::key(salt.str() + ci.get_cache_key(), files);
+}
+
+// source followed by the files next to it that it references: obj material libraries, gltf and glb buffers and images,
+// false for formats that may read other files not listed here and for references that would need unescaping
+bool mesh_compiler::keyFiles(const std::string& filename, std::vector<std::string>& files)
+{
+    std::string extension = std::filesystem::path(filename).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".dae" || extension == ".md5mesh" || extension == ".smd" || extension == ".xml") return false;
+
+    files = { filename };
+    if (extension != ".obj" && extension != ".gltf" && extension != ".glb") return true;
+
+    mapped_file mf(filename);
+    std::string_view text(mf.data(), mf.size());
+    std::vector<std::string> names;
+    if (extension == ".obj") {
+        // rest of the line is one name like assimp reads it
+        for (size_t at = text.find("mtllib"); at != std::string_view::npos; at = text.find("mtllib", at + 6)) {
+            size_t line = at;
+            while (line > 0 && (text[line - 1] == ' ' || text[line - 1] == '\t')) --line;
+            if (line > 0 && text[line - 1] != '\n') continue;
+            size_t first = at + 6, last = std::min(text.find('\n', first), text.size());
+            if (first == last || (text[first] != ' ' && text[first] != '\t')) continue;
+            while (first < last && std::isspace(static_cast<unsigned char>(text[first]))) ++first;
+            while (last > first && std::isspace(static_cast<unsigned char>(text[last - 1]))) --last;
+            if (first != last) names.emplace_back(text.substr(first, last - first));
+        }
+    }
+    else {
+        // glb references sit in its json chunk, binary data after it could look like one
+        if (extension == ".glb") {
+            if (text.size() < 20 || text.substr(0, 4) != "glTF") return true;
+            unsigned int json_size = 0;
+            std::memcpy(&json_size, text.data() + 12, sizeof(json_size));
+            text = text.substr(20, json_size);
+        }
+        for (size_t at = text.find("\"uri\""); at != std::string_view::npos; at = text.find("\"uri\"", at + 5)) {
+            size_t first = at + 5;
+            while (first < text.size() && (std::isspace(static_cast<unsigned char>(text[first])) || text[first] == ':')) ++first;
+            if (first == text.size() || text[first] != '"') return false;
+            const size_t last = text.find('"', ++first);
+            if (last == std::string_view::npos) return false;
+            const std::string_view uri = text.substr(first, last - first);
+            if (uri.substr(0, 5) == "data:") continue;
+            if (uri.find_first_of("\\%") != std::string_view::npos || uri.find("://") != std::string_view::npos) return false;
+            names.emplace_back(uri);
+        }
+    }
+
+    // missing files are left out, the count in the key tells that apart
+    const std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+    for (const std::string& name : names) {
+        const std::string path = (directory / name).string();
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(path, ec)) files.push_back(path);
+    }
+    return true;
+}
+
+bool mesh_compiler::restoreCached(const std::string& key, const compileSettings& settings)
+{
+    std::vector<compile_cache::cachedOutput> cached;
+    if (!settings.cache->lookup(key, cached)) return false;
+
+    for (const compile_cache::cachedOutput& output : cached) {
+        if (settings.output_stream == nullptr && !settings.output_sink) {
+            settings.cache->restore(output);
+            if (settings.produced_outputs != nullptr) settings.produced_outputs->push_back(output.first);
+            continue;
+        }
+        mapped_file blob(output.second);
+        writeOutput(output.first, settings, [&](std::ostream& out) { out.write(blob.data(), blob.size()); });
+    }
+    if (settings.import.report_time) std::cout << "cache hit: " << key << " (" << cached.size() << " outputs)\n";
+    return true;
+}
+
+void mesh_compiler::compileMemory(const void* data, const size_t& size, const std::string& hint, const std::string& name, compilationInfo ci, const compileSettings& settings)
+{
+    for (fileUnit& fu : ci.file_units) {
+        expandFileName(fu, name);
+        auto process_scene = [&](const aiScene* scene) {
+            compile_stats::addScene(name, scene);
+            compileScene(scene, fu, settings);
+        };
+        if (settings.native_import && native_reader::readMemory(data, size, hint, process_scene, settings.import)) continue;
+        assimp::readMemory(data, size, hint, process_scene, settings.import);
+    }
+}
+
+void mesh_compiler::compileStdin(const std::string& hint, compilationInfo ci, const compileSettings& settings)
+{
+    if (hint.empty()) throw std::runtime_error("reading from stdin requires format hint: --hint <file extension>");
+    if (settings.memory_limit != 0) throw std::runtime_error("--memory-limit can not be used when reading from stdin");
+    if (!settings.source_format.empty()) throw std::runtime_error("--from and --transcode can not be used when reading from stdin");
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    std::vector<char> data;
+    char chunk[65536];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), stdin)) > 0) data.insert(data.end(), chunk, chunk + got);
+    if (data.empty()) throw std::runtime_error("no data on stdin");
+
+    compileMemory(data.data(), data.size(), hint, "stdin", ci, settings);
+}
+
+// source is rebuilt from an output of settings.source_format, no model import is done
+void mesh_compiler::compileOutput(const std::string& filename, compilationInfo ci, const compileSettings& settings)
 {
+    std::unique_ptr<aiScene> scene(importOutput(filename, ci, settings));
     for (fileUnit& fu : ci.file_units) {
-        // replace {file} with file name in output file name
-        size_t found = fu.output_file.find("{file}");
-        if (found != std::string::npos) {
-            std::string base_filename = filename.substr(filename.find_last_of("/\\") + 1);
-            size_t const p(base_filename.find_last_of('.'));
-            fu.output_file.replace(found, 6, base_filename.substr(0, p));
+        expandFileName(fu, filename);
+        compileScene(scene.get(), fu, settings);
+    }
+}
+
+// caller owns returned scene
+aiScene* mesh_compiler::importOutput(const std::string& filename, const compilationInfo& ci, const compileSettings& settings)
+{
+    if (settings.memory_limit != 0) throw std::runtime_error("--memory-limit can not be combined with --from");
+
+    profiler::scope import(profiler::phase::import, "compiled output");
+    import.set_source(filename);
+    const auto start{ std::chrono::steady_clock::now() };
+    output_importer importer(settings.source_format);
+    importer.checkProvides(ci);
+    aiScene* scene = importer.readFile(filename);
+    import.stop();
+    if (settings.import.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (compiled output)\n";
+    }
+    compile_stats::addScene(filename, scene);
+    return scene;
+}
+
+// source fields are copied into target layout, object names come from source file name
+void mesh_compiler::compileTranscoded(const std::string& filename, compilationInfo ci, const compileSettings& settings)
+{
+    if (settings.memory_limit != 0) throw std::runtime_error("--memory-limit can not be combined with --transcode");
+
+    static const std::vector<std::string> placeholders = { "{scene}", "{mesh}", "{skeleton}", "{animation}", "{channel}" };
+    const auto start{ std::chrono::steady_clock::now() };
+    transcoder tc(settings.source_format, filename);
+    for (fileUnit& fu : ci.file_units) {
+        expandFileName(fu, filename);
+        for (const std::string& p : placeholders) {
+            size_t found = fu.output_file.find(p);
+            if (found != std::string::npos) fu.output_file.replace(found, p.size(), tc.objectName(p));
         }
+        transcoder::plan plan = tc.map(fu);
+        writeOutput(fu.output_file, settings, [&](std::ostream& out) { tc.put(out, fu, plan); });
+    }
+    if (settings.import.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+        std::cout << "transcode time: " << elapsed_seconds.count() << " s\n";
+    }
+}
+
+// one input per line, optionally followed by its format file, lines starting with # are skipped
+std::vector<mesh_compiler::batchTask> mesh_compiler::readManifest(const std::string& manifest, const std::string& default_format)
+{
+    std::ifstream file(manifest, std::ios::in);
+    if (!file) throw std::runtime_error("could not open file: " + manifest);
 
-        assimp::readFile(filename, std::bind(mesh_compiler::compileScene, std::placeholders::_1, std::ref(fu)));
+    std::vector<batchTask> tasks;
+    std::string line;
+    size_t line_num = 0;
+    while (std::getline(file, line)) {
+        ++line_num;
+        std::stringstream ss(line);
+        batchTask task;
+        if (!(ss >> task.source) || task.source[0] == '#') continue;
+        if (!(ss >> task.format_file)) task.format_file = default_format;
+        std::string rest;
+        if (ss >> rest) throw std::runtime_error("unexpected text in manifest line " + std::to_string(line_num) + ": " + rest);
+        tasks.push_back(task);
     }
+    return tasks;
 }
 
-void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
+// every file under directory whose name matches glob, sorted so runs are repeatable
+std::vector<mesh_compiler::batchTask> mesh_compiler::listDirectory(const std::string& directory, const std::string& glob, const std::string& default_format)
 {
-    // replace {scene} with scene name in output file name
+    std::vector<batchTask> tasks;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (!entry.is_regular_file()) continue;
+        if (!mesh_decoder::matchesPattern(entry.path().filename().string(), glob)) continue;
+        tasks.push_back(batchTask{ entry.path().string(), default_format });
+    }
+    std::sort(tasks.begin(), tasks.end(), [](const batchTask& a, const batchTask& b) { return a.source < b.source; });
+    return tasks;
+}
+
+// every distinct format is parsed once, tasks run on a thread pool and a failing task does not stop the others
+std::vector<mesh_compiler::batchResult> mesh_compiler::compileBatch(const std::vector<batchTask>& tasks, const std::string& import_overrides, const compileSettings& base, const unsigned int& jobs)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+
+    std::map<std::string, std::unique_ptr<compilationInfo>> formats;
+    std::map<std::string, std::string> format_errors;
+    parseBatchFormats(tasks, base.import.report_time, formats, format_errors);
+
+    std::vector<batchResult> results(tasks.size());
+    {
+        thread_pool pool(jobs);
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            pool.submit([&, i]() {
+                const batchTask& task = tasks[i];
+                try {
+                    auto found = format_errors.find(task.format_file);
+                    if (found != format_errors.end()) throw std::runtime_error(found->second);
+                    const compilationInfo& ci = *formats.at(task.format_file);
+                    compileSettings settings = base;
+                    settings.produced_outputs = &results[i].outputs;
+                    applyFormatImport(settings, ci, import_overrides);
+                    if (!compileFile(task.source, ci, settings)) results[i].error = "could not import file";
+                }
+                catch (formatInterpreterException& e) {
+                    results[i].error = e.what();
+                }
+                catch (meshCompilerException& e) {
+                    results[i].error = e.what();
+                }
+                catch (std::exception& e) {
+                    results[i].error = e.what();
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    printBatchSummary(tasks, results, start, std::to_string(jobs) + " threads");
+    return results;
+}
+
+// import, emission and writing run on their own workers joined by bounded queues,
+// so file N+1 is imported while file N is emitted and outputs of file N-1 are written
+std::vector<mesh_compiler::batchResult> mesh_compiler::compilePipelined(const std::vector<batchTask>& tasks, const std::string& import_overrides, const compileSettings& base, const std::array<unsigned int, 3>& stage_jobs)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+
+    std::map<std::string, std::unique_ptr<compilationInfo>> formats;
+    std::map<std::string, std::string> format_errors;
+    parseBatchFormats(tasks, base.import.report_time, formats, format_errors);
+
+    // scene is null for sources compiled in one go by the emit stage (streamed, transcoded, glb views)
+    class importedModel {
+    public:
+        size_t task = 0;
+        compileSettings settings;
+        std::unique_ptr<aiScene> scene;
+        std::string cache_key; // outputs are stored under it after emission, empty when not cached
+    };
+    class finishedOutput {
+    public:
+        size_t task = 0;
+        std::string name;
+        std::string data;
+    };
+
+    // first error of a task wins, later stages may still report outputs of a failed task
+    std::vector<batchResult> results(tasks.size());
+    std::mutex results_mutex;
+    auto fail = [&](const size_t& task, const std::string& message) {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        if (results[task].error.empty()) results[task].error = message;
+    };
+
+    // two items per consumer keep consumers busy without holding many scenes in memory
+    bounded_queue<std::unique_ptr<importedModel>> imported(2 * static_cast<size_t>(stage_jobs[1]));
+    bounded_queue<std::unique_ptr<finishedOutput>> finished(2 * static_cast<size_t>(stage_jobs[2]));
+    std::atomic<size_t> next_task{ 0 };
+
+    auto import_stage = [&]() {
+        size_t i;
+        while ((i = next_task++) < tasks.size()) {
+            const batchTask& task = tasks[i];
+            try {
+                auto found = format_errors.find(task.format_file);
+                if (found != format_errors.end()) throw std::runtime_error(found->second);
+                const compilationInfo& ci = *formats.at(task.format_file);
+                std::unique_ptr<importedModel> model(new importedModel());
+                model->task = i;
+                model->settings = base;
+                applyFormatImport(model->settings, ci, import_overrides);
+
+                // cache hits are restored here and never reach the other stages
+                if (cacheable(model->settings)) {
+                    model->cache_key = cacheKey(task.source, ci, model->settings);
+                    std::vector<std::string> restored;
+                    model->settings.produced_outputs = &restored;
+                    const bool hit = !model->cache_key.empty() && restoreCached(model->cache_key, model->settings);
+                    model->settings.produced_outputs = nullptr;
+                    model->settings.cache = nullptr;
+                    if (hit) {
+                        std::lock_guard<std::mutex> lock(results_mutex);
+                        results[i].outputs = restored;
+                        continue;
+                    }
+                }
+                model->scene.reset(importModel(task.source, ci, model->settings));
+                imported.push(std::move(model));
+            }
+            catch (formatInterpreterException& e) {
+                fail(i, e.what());
+            }
+            catch (meshCompilerException& e) {
+                fail(i, e.what());
+            }
+            catch (std::exception& e) {
+                fail(i, e.what());
+            }
+        }
+    };
+
+    auto emit_stage = [&]() {
+        std::unique_ptr<importedModel> model;
+        while (imported.pop(model)) {
+            const batchTask& task = tasks[model->task];
+            const size_t i = model->task;
+            std::vector<std::pair<std::string, std::string>> cached_outputs;
+            const bool caching = !model->cache_key.empty();
+            model->settings.output_sink = [&finished, &cached_outputs, caching, i](const std::string& name, std::string& data) {
+                if (caching) cached_outputs.emplace_back(name, data);
+                std::unique_ptr<finishedOutput> out(new finishedOutput());
+                out->task = i;
+                out->name = name;
+                out->data.swap(data);
+                finished.push(std::move(out));
+            };
+            // streamed outputs skip the write stage
+            std::vector<std::string> written;
+            model->settings.produced_outputs = &written;
+            size_t failed = 0;
+            model->settings.failed_outputs = &failed;
+            try {
+                compilationInfo ci = *formats.at(task.format_file);
+                if (!model->scene) {
+                    if (!compileFile(task.source, ci, model->settings)) throw std::runtime_error("could not import file");
+                }
+                else for (fileUnit& fu : ci.file_units) {
+                    expandFileName(fu, task.source);
+                    compileScene(model->scene.get(), fu, model->settings);
+                }
+                if (caching && failed == 0) base.cache->store(model->cache_key, cached_outputs);
+            }
+            catch (formatInterpreterException& e) {
+                fail(i, e.what());
+            }
+            catch (meshCompilerException& e) {
+                fail(i, e.what());
+            }
+            catch (std::exception& e) {
+                fail(i, e.what());
+            }
+            if (!written.empty()) {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results[i].outputs.insert(results[i].outputs.end(), written.begin(), written.end());
+            }
+            model.reset();
+        }
+    };
+
+    auto write_stage = [&]() {
+        compileSettings settings;
+        settings.output_stream = base.output_stream;
+        std::unique_ptr<finishedOutput> out;
+        while (finished.pop(out)) {
+            try {
+                writeOutput(out->name, settings, [&](std::ostream& file) { file.write(out->data.data(), out->data.size()); });
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results[out->task].outputs.push_back(out->name);
+            }
+            catch (std::exception& e) {
+                fail(out->task, e.what());
+            }
+            out.reset();
+        }
+    };
+
+    // every stage closes the queue it feeds once all of its workers are done
+    std::vector<std::thread> importers, emitters, writers;
+    for (unsigned int i = 0; i < stage_jobs[0]; ++i) importers.emplace_back(import_stage);
+    for (unsigned int i = 0; i < stage_jobs[1]; ++i) emitters.emplace_back(emit_stage);
+    for (unsigned int i = 0; i < stage_jobs[2]; ++i) writers.emplace_back(write_stage);
+    for (std::thread& t : importers) t.join();
+    imported.close();
+    for (std::thread& t : emitters) t.join();
+    finished.close();
+    for (std::thread& t : writers) t.join();
+
+    printBatchSummary(tasks, results, start, std::to_string(stage_jobs[0]) + "+" + std::to_string(stage_jobs[1]) + "+" + std::to_string(stage_jobs[2]) + " pipeline threads");
+
+    // full waits mean the consuming stage needs more workers, empty waits mean the producing one does
+    auto print_queue = [](const std::string& name, const auto& st) {
+        std::cout << "queue " << name << ": capacity " << st.capacity << ", max depth " << st.max_depth << ", average depth " << st.average_depth()
+            << ", full waits " << st.full_waits << ", empty waits " << st.empty_waits << "\n";
+    };
+    print_queue("import -> emit", imported.get_stats());
+    print_queue("emit -> write", finished.get_stats());
+    return results;
+}
+
+void mesh_compiler::parseBatchFormats(const std::vector<batchTask>& tasks, const bool& debug_messages, std::map<std::string, std::unique_ptr<compilationInfo>>& formats, std::map<std::string, std::string>& format_errors)
+{
+    for (const batchTask& task : tasks) {
+        if (formats.count(task.format_file) != 0 || format_errors.count(task.format_file) != 0) continue;
+        try {
+            formats[task.format_file].reset(new compilationInfo(task.format_file, debug_messages));
+        }
+        catch (formatInterpreterException& e) {
+            format_errors[task.format_file] = e.what();
+            formats.erase(task.format_file);
+        }
+        catch (std::runtime_error& e) {
+            format_errors[task.format_file] = e.what();
+            formats.erase(task.format_file);
+        }
+    }
+}
+
+// tasks run at the same time, two of them whose file units expand to the same name would write the same outputs,
+// same stem in different directories or a name without {file} does that
+void mesh_compiler::checkBatchOutputs(const std::vector<batchTask>& tasks)
+{
+    std::map<std::string, std::unique_ptr<compilationInfo>> formats;
+    std::map<std::string, std::string> format_errors;
+    parseBatchFormats(tasks, false, formats, format_errors);
+
+    std::map<std::string, size_t> writers; // expanded output name, task writing it
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        auto found = formats.find(tasks[i].format_file);
+        if (found == formats.end()) continue; // fails by itself later
+        std::vector<std::string> names;
+        for (fileUnit fu : found->second->file_units) {
+            expandFileName(fu, tasks[i].source);
+            if (std::find(names.begin(), names.end(), fu.output_file) == names.end()) names.push_back(fu.output_file);
+        }
+        for (const std::string& name : names) {
+            auto writer = writers.emplace(name, i);
+            if (!writer.second) throw std::runtime_error("inputs: " + tasks[writer.first->second].source + " and " + tasks[i].source + " would both write: " + name);
+        }
+    }
+}
+
+void mesh_compiler::printBatchSummary(const std::vector<batchTask>& tasks, const std::vector<batchResult>& results, const std::chrono::steady_clock::time_point& start, const std::string& workers)
+{
+    size_t failed = 0;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        if (results[i].error.empty()) continue;
+        std::cout << "failed: " << tasks[i].source << ": " << results[i].error << "\n";
+        ++failed;
+    }
+    const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+    std::cout << "batch: compiled " << tasks.size() - failed << " out of " << tasks.size() << " files in " << elapsed_seconds.count() << " s on " << workers << "\n";
+}
+
+// "import,emit,write" worker counts, each at least 1
+std::array<unsigned int, 3> mesh_compiler::parseStageJobs(const std::string& text)
+{
+    std::array<unsigned int, 3> stage_jobs = { 0, 0, 0 };
+    std::stringstream ss(text);
+    std::string word;
+    size_t stage = 0;
+    while (std::getline(ss, word, ',')) {
+        if (stage == stage_jobs.size()) throw std::runtime_error("invalid stage worker counts: " + text);
+        try {
+            stage_jobs[stage++] = parseJobCount(word);
+        }
+        catch (std::runtime_error&) {
+            throw std::runtime_error("invalid stage worker counts: " + text);
+        }
+    }
+    if (stage != stage_jobs.size()) throw std::runtime_error("invalid stage worker counts: " + text);
+    return stage_jobs;
+}
+
+// 64 bit FNV-1a of source path with / separators, same on every node and platform
+unsigned long long mesh_compiler::shardHash(const std::string& source)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    for (char c : source) {
+        if (c == '\\') c = '/';
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// "index/count" with index below count
+void mesh_compiler::parseShard(const std::string& text, unsigned int& shard, unsigned int& shard_count)
+{
+    const std::string message = "invalid shard: " + text + ", expected <index>/<count> with index below count";
+    size_t slash = text.find('/');
+    if (slash == std::string::npos || slash == 0 || slash + 1 == text.size()) throw std::runtime_error(message);
+    size_t pos = 0;
+    unsigned long index = 0, count = 0;
+    try {
+        const std::string index_text = text.substr(0, slash);
+        const std::string count_text = text.substr(slash + 1);
+        index = std::stoul(index_text, &pos);
+        if (pos != index_text.size()) throw std::runtime_error(message);
+        count = std::stoul(count_text, &pos);
+        if (pos != count_text.size()) throw std::runtime_error(message);
+    }
+    catch (std::exception&) {
+        throw std::runtime_error(message);
+    }
+    if (count == 0 || index >= count) throw std::runtime_error(message);
+    shard = static_cast<unsigned int>(index);
+    shard_count = static_cast<unsigned int>(count);
+}
+
+// every node given the same input list picks a disjoint part of it without talking to the others,
+// sources listed from a directory hash relative to root so nodes may mount it at different paths
+std::vector<mesh_compiler::batchTask> mesh_compiler::selectShard(const std::vector<batchTask>& tasks, const std::string& root, const unsigned int& shard, const unsigned int& shard_count)
+{
+    std::vector<batchTask> selected;
+    for (const batchTask& task : tasks) {
+        const std::string key = root.empty() ? task.source : std::filesystem::path(task.source).lexically_relative(root).generic_string();
+        if (shardHash(key) % shard_count == shard) selected.push_back(task);
+    }
+    return selected;
+}
+
+// one "source<tab>output" line per output, written next to index and renamed so readers on a shared filesystem never see half of it
+void mesh_compiler::writeIndex(const std::string& index, const std::string& shard, const std::vector<std::pair<std::string, std::string>>& entries)
+{
+    const std::string temporary = index + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::binary);
+        if (!file) throw std::runtime_error("cannot open file: " + temporary);
+        file << "# mesh-compiler index\n";
+        if (!shard.empty()) file << "# shard " << shard << "\n";
+        for (const std::pair<std::string, std::string>& entry : entries) file << entry.first << '\t' << entry.second << '\n';
+        if (!file) throw std::runtime_error("could not write file: " + temporary);
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, index, ec);
+    if (ec) throw std::runtime_error("could not replace file: " + index + ": " + ec.message());
+}
+
+// partial indexes of one sharded run become one index sorted by source,
+// every shard has to be there exactly once and no output may come from two different sources
+void mesh_compiler::mergeIndexes(const std::string& index, const std::vector<std::string>& partials)
+{
+    std::vector<std::pair<std::string, std::string>> entries;
+    std::map<unsigned int, std::string> shards;
+    unsigned int shard_count = 0;
+    size_t unsharded = 0;
+    for (const std::string& partial : partials) {
+        std::ifstream file(partial, std::ios::in | std::ios::binary);
+        if (!file) throw std::runtime_error("could not open file: " + partial);
+
+        bool sharded = false;
+        std::string line;
+        size_t line_num = 0;
+        while (std::getline(file, line)) {
+            ++line_num;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            if (line.compare(0, 8, "# shard ") == 0) {
+                unsigned int shard = 0, count = 0;
+                parseShard(line.substr(8), shard, count);
+                if (shard_count != 0 && count != shard_count) {
+                    throw std::runtime_error(partial + " is a shard of " + std::to_string(count) + " while other indexes are shards of " + std::to_string(shard_count));
+                }
+                shard_count = count;
+                auto found = shards.emplace(shard, partial);
+                if (!found.second) throw std::runtime_error("shard " + line.substr(8) + " is in both " + found.first->second + " and " + partial);
+                sharded = true;
+                continue;
+            }
+            if (line[0] == '#') continue;
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos) throw std::runtime_error("missing tab in " + partial + " line " + std::to_string(line_num));
+            entries.emplace_back(line.substr(0, tab), line.substr(tab + 1));
+        }
+        if (!sharded) ++unsharded;
+    }
+    if (shard_count != 0 && unsharded != 0) throw std::runtime_error("can not merge sharded and unsharded indexes");
+    for (unsigned int i = 0; i < shard_count; ++i) {
+        if (shards.count(i) == 0) throw std::runtime_error("missing shard " + std::to_string(i) + "/" + std::to_string(shard_count));
+    }
+
+    // outputs keep their order within a source
+    std::stable_sort(entries.begin(), entries.end(), [](const std::pair<std::string, std::string>& a, const std::pair<std::string, std::string>& b) { return a.first < b.first; });
+    std::map<std::string, std::string> producers;
+    std::vector<std::pair<std::string, std::string>> merged;
+    for (const std::pair<std::string, std::string>& entry : entries) {
+        auto found = producers.emplace(entry.second, entry.first);
+        if (found.second) merged.push_back(entry);
+        else if (found.first->second != entry.first) throw std::runtime_error("output " + entry.second + " produced by both " + found.first->second + " and " + entry.first);
+    }
+    writeIndex(index, "", merged);
+    std::cout << "merged " << partials.size() << " indexes into " << index << ": " << merged.size() << " outputs\n";
+}
+
+// caller owns returned scene, nullptr if source has to be compiled in one go by compileFile
+aiScene* mesh_compiler::importModel(const std::string& filename, const compilationInfo& ci, const compileSettings& settings)
+{
+    if (!settings.source_format.empty() && !settings.transcode) return importOutput(filename, ci, settings);
+    if (settings.memory_limit != 0 || settings.transcode) return nullptr;
+    if (settings.native_import && glb_reader::isGlb(filename)) return nullptr;
+
+    aiScene* scene = importScene(filename, settings);
+    if (scene == nullptr) throw std::runtime_error("could not import file");
+    return scene;
+}
+
+// caller owns returned scene, nullptr if import failed, format does not take part in the key
+// so layout changes keep hitting scenes imported for earlier layouts, sources keyFiles rejects are not cached
+aiScene* mesh_compiler::importScene(const std::string& filename, const compileSettings& settings)
+{
+    std::string key;
+    std::vector<std::string> files;
+    if (settings.scene_cache != nullptr && keyFiles(filename, files)) {
+        std::ostringstream salt;
+        salt << "scene " << scene_file::version << '\n' << settings.import.flags << ' ' << settings.import.removed_components << ' ' << settings.native_import << '\n';
+        salt << files.size() << '\n';
+        key = compile_cache::key(salt.str(), files);
+
+        std::vector<compile_cache::cachedOutput> cached;
+        if (settings.scene_cache->lookup(key, cached) && cached.size() == 1) {
+            profiler::scope import(profiler::phase::import, "scene cache");
+            import.set_source(filename);
+            const auto start{ std::chrono::steady_clock::now() };
+            try {
+                aiScene* scene = scene_file::readFile(cached[0].second);
+                import.stop();
+                if (settings.import.report_time) {
+                    const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+                    std::cout << "import time: " << elapsed_seconds.count() << " s (scene cache)\n";
+                }
+                compile_stats::addScene(filename, scene);
+                return scene;
+            }
+            catch (std::runtime_error& e) {
+                if (settings.import.report_time) std::cout << "scene cache entry unusable, importing again: " << e.what() << "\n";
+            }
+        }
+    }
+
+    aiScene* scene = nullptr;
+    if (settings.native_import) scene = native_reader::importFile(filename, settings.import);
+    if (scene == nullptr) scene = assimp::importFile(filename, settings.import);
+    if (scene != nullptr) compile_stats::addScene(filename, scene);
+    if (scene != nullptr && !key.empty()) {
+        std::ostringstream snapshot(std::ios::out | std::ios::binary);
+        scene_file::write(snapshot, scene);
+        settings.scene_cache->store(key, { { "scene", snapshot.str() } });
+    }
+    return scene;
+}
+
+unsigned int mesh_compiler::parseJobCount(const std::string& text)
+{
+    size_t pos = 0;
+    unsigned long jobs = 0;
+    try {
+        jobs = std::stoul(text, &pos);
+    }
+    catch (std::exception&) {
+        throw std::runtime_error("invalid job count: " + text);
+    }
+    if (pos != text.size() || jobs == 0) throw std::runtime_error("invalid job count: " + text);
+    return static_cast<unsigned int>(jobs);
+}
+
+size_t mesh_compiler::parseMemorySize(const std::string& text)
+{
+    size_t pos = 0;
+    unsigned long long bytes = 0;
+    try {
+        bytes = std::stoull(text, &pos);
+    }
+    catch (std::exception&) {
+        throw std::runtime_error("invalid memory limit: " + text);
+    }
+    std::string suffix = text.substr(pos);
+    if (suffix == "K" || suffix == "k") bytes <<= 10;
+    else if (suffix == "M" || suffix == "m") bytes <<= 20;
+    else if (suffix == "G" || suffix == "g") bytes <<= 30;
+    else if (!suffix.empty()) throw std::runtime_error("invalid memory limit: " + text);
+    if (bytes == 0) throw std::runtime_error("invalid memory limit: " + text);
+    return static_cast<size_t>(bytes);
+}
+
+// only plain vertex attributes and indices can be emitted without having whole mesh
+bool mesh_compiler::streamable(const compileUnit& unit)
+{
+    if (unit.count_type != counting_type::per_mesh) return false;
+    for (const compileField& field : unit.preamble) {
+        if (field.vtype == value::other_unit) return false;
+    }
+    for (const compileBuffer& buffer : unit.buffers) {
+        if (buffer.count_type != counting_type::per_vertex && buffer.count_type != counting_type::per_indice) return false;
+        for (const compileField& field : buffer.preamble) {
+            if (field.vtype == value::other_unit) return false;
+        }
+        for (const compileField& field : buffer.fields) {
+            switch (field.vtype)
+            {
+            case value::constant:
+            case value::indice:
+            case value::vertex:
+            case value::normal:
+                break;
+            case value::uv:
+            case value::vertex_color:
+                if (field.data[0] != 0) return false;
+                break;
+            default:
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// binary ply is read in chunks of settings.memory_limit bytes, counts in preambles are written after each buffer
+void mesh_compiler::compileStreamed(const std::string& filename, fileUnit fu, const compileSettings& settings)
+{
+    if (!streamable(fu)) throw std::runtime_error("--memory-limit needs per mesh format with only per vertex and per indice buffers of vertex attributes");
+    if (settings.output_stream != nullptr) throw std::runtime_error("--memory-limit can not be combined with --stdout");
+    std::string ext = filename.substr(filename.find_last_of('.') + 1);
+    if (ext != "ply" && ext != "PLY") throw std::runtime_error("--memory-limit needs binary ply source, got: " + filename);
+
+    const auto start{ std::chrono::steady_clock::now() };
+    ply_format::chunkReader reader(filename, settings.memory_limit);
+    const ply_format::header& header = reader.get_header();
+    const ply_format::element* vertices = header.find("vertex");
+    const ply_format::element* faces = header.find("face");
+    if (vertices == nullptr || vertices->get_stride() == 0) throw std::runtime_error("ply file: " + filename + " has no fixed size vertices");
+    const bool swap = header.needsSwap();
+    const bool flip = (settings.import.flags & aiProcess_FlipUVs) != 0;
+    if (compile_stats::enabled()) {
+        compile_stats::meshInfo info;
+        info.vertices = vertices->count;
+        info.faces = faces == nullptr ? 0 : faces->count;
+        compile_stats::addMeshes(filename, { info });
+    }
+
+    // where every vertex attribute lives inside one vertex
+    std::vector<int> slot_offset(ply_format::none, -1);
+    std::vector<ply_format::type> slot_type(ply_format::none, ply_format::type::float32);
+    size_t stride = 0;
+    for (const ply_format::property& p : vertices->properties) {
+        ply_format::slot slot = ply_format::getSlot(p.name);
+        if (slot != ply_format::none) {
+            slot_offset[slot] = static_cast<int>(stride);
+            slot_type[slot] = p.value_type;
+        }
+        stride += ply_format::typeSize(p.value_type);
+    }
+    auto attribute = [&](const char* vertex, const int& slot) {
+        if (slot_offset[slot] < 0) {
+            if (slot == ply_format::a) return 1.0;
+            throw std::runtime_error("ply file: " + filename + " lacks vertex data required by format");
+        }
+        double v = ply_format::readValue(vertex + slot_offset[slot], slot_type[slot], swap);
+        if (slot >= ply_format::r) v /= ply_format::typeMax(slot_type[slot]);
+        return v;
+    };
+
+    // ply has no scene or mesh names, the file name stands in for both
+    std::string stem = filename.substr(filename.find_last_of("/\\") + 1);
+    stem = stem.substr(0, stem.find_last_of('.'));
     size_t found = fu.output_file.find("{scene}");
-    if (found != std::string::npos) fu.output_file.replace(found, 7, scene->mName.C_Str());
+    if (found != std::string::npos) fu.output_file.replace(found, 7, stem);
+    found = fu.output_file.find("{mesh}");
+    if (found != std::string::npos) fu.output_file.replace(found, 6, stem);
+    std::error_code unlinked;
+    std::filesystem::remove(fu.output_file, unlinked); // see writeOutput
+    std::ofstream fout(fu.output_file, std::ios::out | std::ios::binary);
+    if (!fout) {
+        throw std::runtime_error("cannot open file: " + fu.output_file);
+    }
+
+    // a half written output is removed, its preambles were never patched
+    try {
+        // counts are 0 until the buffer is streamed
+        for (compileBuffer& buffer : fu.buffers) buffer.count = 0;
+        const std::streampos unit_preamble = fout.tellp();
+        for (const compileField& field : fu.preamble) field.put(fout, fu);
+
+        for (compileBuffer& buffer : fu.buffers) {
+            const std::streampos buffer_preamble = fout.tellp();
+            for (const compileField& field : buffer.preamble) field.put(fout, buffer);
+
+            size_t count = 0;
+            if (buffer.count_type == counting_type::per_vertex) {
+                reader.seekElement("vertex");
+                const size_t batch = std::max<size_t>(1, settings.memory_limit / stride);
+                while (count < vertices->count) {
+                    const size_t n = std::min(batch, vertices->count - count);
+                    const char* data = reader.need(n * stride);
+                    for (size_t i = 0; i < n; ++i) {
+                        const char* vertex = data + i * stride;
+                        for (const compileField& field : buffer.fields) {
+                            switch (field.vtype)
+                            {
+                            case value::constant:
+                                fout.write(field.data.data(), typeSizesMap[field.stype]);
+                                break;
+                            case value::vertex:
+                                writeConst(fout, attribute(vertex, ply_format::x + field.data[0]), field.stype);
+                                break;
+                            case value::normal:
+                                writeConst(fout, attribute(vertex, ply_format::nx + field.data[0]), field.stype);
+                                break;
+                            case value::uv:
+                                if (field.data[1] == 0) writeConst(fout, attribute(vertex, ply_format::u), field.stype);
+                                else if (field.data[1] == 1) writeConst(fout, flip ? 1.0 - attribute(vertex, ply_format::v) : attribute(vertex, ply_format::v), field.stype);
+                                else writeConst(fout, 0.0, field.stype);
+                                break;
+                            case value::vertex_color:
+                                writeConst(fout, attribute(vertex, ply_format::r + field.data[1]), field.stype);
+                                break;
+                            default:
+                                throw std::logic_error("invalid value for per vertex buffer");
+                            }
+                        }
+                    }
+                    count += n;
+                }
+            }
+            else {
+                if (faces == nullptr) throw std::runtime_error("ply file: " + filename + " has no faces");
+                reader.seekElement("face");
+                std::vector<unsigned int> face;
+                for (size_t item = 0; item < faces->count; ++item) {
+                    face.clear();
+                    for (const ply_format::property& p : faces->properties) {
+                        size_t n = 1;
+                        if (p.list) n = static_cast<size_t>(ply_format::readValue(reader.need(ply_format::typeSize(p.count_type)), p.count_type, swap));
+                        const char* values = reader.need(n * ply_format::typeSize(p.value_type));
+                        if (!p.isFaceIndices()) continue;
+                        for (size_t j = 0; j < n; ++j) {
+                            double index = ply_format::readValue(values + j * ply_format::typeSize(p.value_type), p.value_type, swap);
+                            if (index < 0 || index >= vertices->count) throw std::runtime_error("face index out of range in ply file: " + filename);
+                            face.push_back(static_cast<unsigned int>(index));
+                        }
+                    }
+
+                    // fan triangulation, points and lines are left out
+                    for (size_t k = 1; k + 1 < face.size(); ++k, ++count) {
+                        const unsigned int triangle[3] = { face[0], face[k], face[k + 1] };
+                        for (const compileField& field : buffer.fields) {
+                            if (field.vtype == value::constant) fout.write(field.data.data(), typeSizesMap[field.stype]);
+                            else if (field.vtype == value::indice) writeConst(fout, triangle[static_cast<size_t>(field.data[0])], field.stype);
+                            else throw std::logic_error("invalid value for per indice buffer");
+                        }
+                    }
+                }
+            }
+
+            // patch buffer preamble
+            buffer.count = count;
+            const std::streampos buffer_end = fout.tellp();
+            fout.seekp(buffer_preamble);
+            for (const compileField& field : buffer.preamble) field.put(fout, buffer);
+            fout.seekp(buffer_end);
+        }
+
+        // patch unit preamble
+        fout.seekp(unit_preamble);
+        for (const compileField& field : fu.preamble) field.put(fout, fu);
+        fout.close();
+        if (!fout) throw std::runtime_error("cannot write file: " + fu.output_file);
+    }
+    catch (...) {
+        fout.close();
+        std::remove(fu.output_file.c_str());
+        throw;
+    }
+    if (settings.produced_outputs != nullptr) settings.produced_outputs->push_back(fu.output_file);
+
+    if (settings.import.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ std::chrono::steady_clock::now() - start };
+        std::cout << "streamed compile time: " << elapsed_seconds.count() << " s (" << settings.memory_limit << " byte chunks)\n";
+    }
+}
+
+// meshes are emitted straight from glb accessor views, false if assimp has to be used instead
+bool mesh_compiler::compileGlb(const std::string& filename, fileUnit fu, const compileSettings& settings)
+{
+    if (!glb_reader::isGlb(filename) || fu.count_type != counting_type::per_mesh) return false;
+    fu.emit_pool = settings.emit_pool;
+
+    std::unique_ptr<glb_reader::glbFile> glb;
+    profiler::scope import(profiler::phase::import, "glb views");
+    import.set_source(filename);
+    const auto start{ std::chrono::steady_clock::now() };
+    try {
+        glb.reset(new glb_reader::glbFile(filename, settings.import));
+        for (const glb_reader::meshView& mesh : glb->meshes) {
+            if (!viewProvides(fu, mesh)) throw std::runtime_error("mesh: " + mesh.name + " lacks data required by format");
+        }
+    }
+    catch (std::exception& e) {
+        if (settings.import.report_time) std::cout << "native reader declined " << filename << ": " << e.what() << "\n";
+        return false;
+    }
+    const auto end{ std::chrono::steady_clock::now() };
+    import.stop();
+    if (settings.import.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (glb views)\n";
+    }
+    if (compile_stats::enabled()) {
+        std::vector<compile_stats::meshInfo> meshes;
+        for (const glb_reader::meshView& mesh : glb->meshes) {
+            compile_stats::meshInfo info;
+            info.name = mesh.name;
+            info.vertices = mesh.get_vertex_count();
+            info.faces = mesh.get_face_count();
+            info.indices = info.faces * 3;
+            meshes.push_back(info);
+        }
+        compile_stats::addMeshes(filename, meshes);
+    }
+
+    // assimp leaves glTF scene names empty
+    size_t found = fu.output_file.find("{scene}");
+    if (found != std::string::npos) fu.output_file.replace(found, 7, "");
 
-    // find name and extension
     std::string orig_name = fu.output_file;
-    if (fu.count_type == counting_type::per_scene) {
+    int errors = 0;
+    for (const glb_reader::meshView& mesh : glb->meshes) {
+        size_t found = fu.output_file.find("{mesh}");
+        if (found != std::string::npos) fu.output_file.replace(found, 6, mesh.name);
         try {
-            std::ofstream fout(fu.output_file, std::ios::out | std::ios::binary);
-            if (!fout) {
-                throw std::runtime_error("cannot open file: " + fu.output_file);
-            }
-            fu.put(fout, scene);
-            fout.close();
+            writeOutput(fu.output_file, settings, [&](std::ostream& out) { fu.put(out, mesh); });
         }
         catch (meshCompilerException& e) {
             std::cout << e.what() << std::endl;
-            std::cout << "compilation of scene: " << scene->mName.C_Str() << " ended up with errors.\n";
+            std::cout << "compilation of mesh: " << mesh.name << " ended up with errors.\n";
+            errors += 1;
         }
+        fu.output_file = orig_name; // go back to original name
     }
-    else if (fu.count_type == counting_type::per_mesh) {
-        int errors = 0;
-        for (int i = 0; i < scene->mNumMeshes; ++i) {
-            size_t found = fu.output_file.find("{mesh}");
-            if (found != std::string::npos) fu.output_file.replace(found, 6, scene->mMeshes[i]->mName.C_Str());
+    if (errors != 0) {
+        std::cout << "scene compilation ended with errors\n";
+        std::cout << "compiled " << glb->meshes.size() - errors << " out of " << glb->meshes.size() << " meshes\n";
+        countFailed(settings, errors);
+    }
+    return true;
+}
+
+bool mesh_compiler::viewProvides(const compileUnit& unit, const glb_reader::meshView& mesh)
+{
+    auto provides = [&](const compileField& field) {
+        switch (field.vtype)
+        {
+        case value::other_unit: return viewProvides((*unit.unitsMap)[field.get_otherUnitName()], mesh);
+        case value::normal: return mesh.normals.valid();
+        case value::tangent: return mesh.tangents.valid();
+        case value::bitangent: return mesh.tangents.valid() && mesh.normals.valid();
+        case value::uv: return static_cast<size_t>(field.data[0]) < mesh.texcoords.size() && mesh.texcoords[field.data[0]].valid();
+        case value::vertex_color: return static_cast<size_t>(field.data[0]) < mesh.colors.size() && mesh.colors[field.data[0]].valid();
+        case value::bone_id:
+        case value::bone_weight: return mesh.joints.valid() && mesh.weights.valid();
+        default: return true;
+        }
+    };
+
+    for (const compileField& field : unit.preamble) {
+        if (!provides(field)) return false;
+    }
+    for (const compileBuffer& buffer : unit.buffers) {
+        if (buffer.count_type != counting_type::per_indice && buffer.count_type != counting_type::per_vertex) return false;
+        for (const compileField& field : buffer.preamble) {
+            if (!provides(field)) return false;
+        }
+        for (const compileField& field : buffer.fields) {
+            if (!provides(field)) return false;
+        }
+    }
+    return true;
+}
+
+// every output the file units would write with its exact size, taken from entry counts like put() takes them,
+// nothing is emitted or written, glb meshes are measured on views whenever compileGlb would emit from views
+void mesh_compiler::dryRun(const std::string& filename, compilationInfo ci, const compileSettings& settings, std::ostream& report)
+{
+    size_t outputs = 0;
+    unsigned long long total = 0;
+    auto output = [&](const std::string& name, const std::function<size_t(std::ostream&)>& measure) {
+        std::ostringstream details;
+        try {
+            const size_t size = measure(details);
+            report << "dry run: " << name << ": " << size << " bytes\n" << details.str();
+            outputs += 1;
+            total += size;
+        }
+        catch (meshCompilerException& e) {
+            report << "dry run: " << name << ": " << e.what() << "\n";
+        }
+    };
+    auto replaced = [](std::string name, const std::string& tag, const std::string& with) {
+        size_t found = name.find(tag);
+        if (found != std::string::npos) name.replace(found, tag.size(), with);
+        return name;
+    };
+
+    std::unique_ptr<glb_reader::glbFile> glb;
+    std::unique_ptr<aiScene> scene;
+    for (fileUnit& fu : ci.file_units) {
+        expandFileName(fu, filename);
+
+        if (settings.native_import && fu.count_type == counting_type::per_mesh && glb_reader::isGlb(filename)) {
+            bool views = true;
             try {
-                std::ofstream fout(fu.output_file, std::ios::out | std::ios::binary);
-                if (!fout) {
-                    throw std::runtime_error("cannot open file: " + fu.output_file);
+                if (!glb) glb.reset(new glb_reader::glbFile(filename, settings.import));
+                for (const glb_reader::meshView& mesh : glb->meshes) views = views && viewProvides(fu, mesh);
+            }
+            catch (std::exception&) {
+                views = false;
+            }
+            if (views) {
+                const std::string base = replaced(fu.output_file, "{scene}", "");
+                for (const glb_reader::meshView& mesh : glb->meshes) {
+                    output(replaced(base, "{mesh}", mesh.name), [&](std::ostream& out) { return fu.measure(out, mesh); });
                 }
-                fu.put(fout, scene->mMeshes[i]);
-                fout.close();
+                continue;
             }
-            catch (meshCompilerException& e) {
-                std::cout << e.what() << std::endl;
-                std::cout << "compilation of mesh: " << scene->mMeshes[i]->mName.C_Str() << " ended up with errors.\n";
-                errors += 1;
+        }
+
+        if (!scene) {
+            scene.reset(settings.source_format.empty() ? importScene(filename, settings) : importOutput(filename, ci, settings));
+            if (!scene) throw std::runtime_error("could not import file");
+        }
+        const aiScene* s = scene.get();
+        const std::string base = replaced(fu.output_file, "{scene}", s->mName.C_Str());
+        if (fu.count_type == counting_type::per_scene) {
+            output(base, [&](std::ostream& out) { return fu.measure(out, s); });
+        }
+        else if (fu.count_type == counting_type::per_mesh) {
+            for (unsigned int i = 0; i < s->mNumMeshes; ++i) {
+                output(replaced(base, "{mesh}", s->mMeshes[i]->mName.C_Str()), [&](std::ostream& out) { return fu.measure(out, s->mMeshes[i]); });
             }
-            fu.output_file = orig_name; // go back to original name
         }
-        if (errors != 0) {
-            std::cout << "scene compilation ended with errors\n";
-            printf("compiled %d out of %d meshes\n", scene->mNumMeshes - errors, scene->mNumMeshes);
-            return;
+        else if (fu.count_type == counting_type::per_skeleton) {
+            for (unsigned int i = 0; i < s->mNumSkeletons; ++i) {
+                output(replaced(base, "{skeleton}", s->mSkeletons[i]->mName.C_Str()), [&](std::ostream& out) { return fu.measure(out, s->mSkeletons[i]); });
+            }
+        }
+        else if (fu.count_type == counting_type::per_animation) {
+            for (unsigned int i = 0; i < s->mNumAnimations; ++i) {
+                output(replaced(base, "{animation}", s->mAnimations[i]->mName.C_Str()), [&](std::ostream& out) { return fu.measure(out, s->mAnimations[i]); });
+            }
+        }
+        else if (fu.count_type == counting_type::per_animation_channel) {
+            for (unsigned int i = 0; i < s->mNumAnimations; ++i) {
+                const std::string animation = replaced(base, "{animation}", s->mAnimations[i]->mName.C_Str());
+                for (unsigned int j = 0; j < s->mAnimations[i]->mNumChannels; ++j) {
+                    output(replaced(animation, "{channel}", s->mAnimations[i]->mChannels[j]->mNodeName.C_Str()), [&](std::ostream& out) { return fu.measure(out, s->mAnimations[i]->mChannels[j]); });
+                }
+            }
+        }
+    }
+    report << "dry run: " << outputs << " outputs, " << total << " bytes\n";
+}
+
+// frame: uint32 name length, name, uint64 data size, data
+// when profiling or tracing, file outputs are emitted into memory first so emission and write are timed apart
+void mesh_compiler::writeOutput(const std::string& name, const compileSettings& settings, std::function<void(std::ostream&)> emit)
+{
+    if (settings.output_sink) {
+        std::ostringstream buffer(std::ios::out | std::ios::binary);
+        profiler::scope emission(profiler::phase::emission, name);
+        emit(buffer);
+        emission.stop();
+        std::string data = buffer.str();
+        settings.output_sink(name, data);
+        return;
+    }
+
+    if (settings.output_stream == nullptr) {
+        // an output restored with --cache-hardlink shares its data with the cache entry, truncating it would change the entry too
+        std::error_code unlinked;
+        std::filesystem::remove(name, unlinked);
+        std::ofstream fout(name, std::ios::out | std::ios::binary);
+        if (!fout) {
+            throw std::runtime_error("cannot open file: " + name);
         }
+        if (profiler::enabled() || tracer::enabled()) {
+            std::ostringstream buffer(std::ios::out | std::ios::binary);
+            profiler::scope emission(profiler::phase::emission, name);
+            emit(buffer);
+            emission.stop();
+            const std::string data = buffer.str();
+            profiler::scope write(profiler::phase::write, name);
+            write.set_bytes(data.size());
+            fout.write(data.data(), data.size());
+            fout.close();
+        }
+        else {
+            emit(fout);
+            fout.close();
+        }
+        if (settings.produced_outputs != nullptr) settings.produced_outputs->push_back(name);
+        return;
+    }
+
+    std::ostringstream buffer(std::ios::out | std::ios::binary);
+    profiler::scope emission(profiler::phase::emission, name);
+    emit(buffer);
+    emission.stop();
+    const std::string data = buffer.str();
+
+    // batch workers share the stream, frames must not interleave
+    static std::mutex stream_mutex;
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    profiler::scope write(profiler::phase::write, name);
+    write.set_bytes(data.size());
+    writeConst<unsigned int>(*settings.output_stream, static_cast<unsigned int>(name.size()));
+    settings.output_stream->write(name.data(), name.size());
+    writeConst<unsigned long long>(*settings.output_stream, static_cast<unsigned long long>(data.size()));
+    settings.output_stream->write(data.data(), data.size());
+    settings.output_stream->flush();
+    if (settings.produced_outputs != nullptr) settings.produced_outputs->push_back(name);
+}
+
+void mesh_compiler::countFailed(const compileSettings& settings, const size_t& failed)
+{
+    if (settings.failed_outputs != nullptr) *settings.failed_outputs += failed;
+}
+
+void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu, const compileSettings& settings)
+{
+    fu.emit_pool = settings.emit_pool;
+
+    // replace {scene} with scene name in output file name
+    size_t found = fu.output_file.find("{scene}");
+    if (found != std::string::npos) fu.output_file.replace(found, 7, scene->mName.C_Str());
+
+    // find name and extension
+    std::string orig_name = fu.output_file;
+    if (fu.count_type == counting_type::per_scene) {
+        try {
+            writeOutput(fu.output_file, settings, [&](std::ostream& out) { fu.put(out, scene); });
+        }
+        catch (meshCompilerException& e) {
+            std::cout << e.what() << std::endl;
+            std::cout << "compilation of scene: " << scene->mName.C_Str() << " ended up with errors.\n";
+            countFailed(settings, 1);
+        }
+    }
+    else if (fu.count_type == counting_type::per_mesh) {
+        compileMeshes(scene, { fu }, settings);
     }
     else if (fu.count_type == counting_type::per_skeleton) {
         int errors = 0;
@@ -1506,12 +3469,7 @@ void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
             size_t found = fu.output_file.find("{skeleton}");
             if (found != std::string::npos) fu.output_file.replace(found, 10, scene->mSkeletons[i]->mName.C_Str());
             try {
-                std::ofstream fout(fu.output_file, std::ios::out | std::ios::binary);
-                if (!fout) {
-                    throw std::runtime_error("cannot open file: " + fu.output_file);
-                }
-                fu.put(fout, scene->mSkeletons[i]);
-                fout.close();
+                writeOutput(fu.output_file, settings, [&](std::ostream& out) { fu.put(out, scene->mSkeletons[i]); });
             }
             catch (meshCompilerException& e) {
                 std::cout << e.what() << std::endl;
@@ -1522,7 +3480,8 @@ void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
         }
         if (errors != 0) {
             std::cout << "scene compilation ended with errors\n";
-            printf("compiled %d out of %d skeletons\n", scene->mNumSkeletons - errors, scene->mNumSkeletons);
+            std::cout << "compiled " << scene->mNumSkeletons - errors << " out of " << scene->mNumSkeletons << " skeletons\n";
+            countFailed(settings, errors);
             return;
         }
     }
@@ -1532,12 +3491,7 @@ void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
             size_t found = fu.output_file.find("{animation}");
             if (found != std::string::npos) fu.output_file.replace(found, 11, scene->mAnimations[i]->mName.C_Str());
             try {
-                std::ofstream fout(fu.output_file, std::ios::out | std::ios::binary);
-                if (!fout) {
-                    throw std::runtime_error("cannot open file: " + fu.output_file);
-                }
-                fu.put(fout, scene->mAnimations[i]);
-                fout.close();
+                writeOutput(fu.output_file, settings, [&](std::ostream& out) { fu.put(out, scene->mAnimations[i]); });
             }
             catch (meshCompilerException& e) {
                 std::cout << e.what() << std::endl;
@@ -1548,7 +3502,8 @@ void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
         }
         if (errors != 0) {
             std::cout << "scene compilation ended with errors\n";
-            printf("compiled %d out of %d animations\n", scene->mNumAnimations - errors, scene->mNumAnimations);
+            std::cout << "compiled " << scene->mNumAnimations - errors << " out of " << scene->mNumAnimations << " animations\n";
+            countFailed(settings, errors);
             return;
         }
     }
@@ -1558,16 +3513,11 @@ void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
             size_t found = fu.output_file.find("{animation}");
             if (found != std::string::npos) fu.output_file.replace(found, 11, scene->mAnimations[i]->mName.C_Str());
             std::string orig_name2 = fu.output_file;
-            for (int j = 0; j < scene->mAnimations[i]->mNumChannels; ++i) {
+            for (int j = 0; j < scene->mAnimations[i]->mNumChannels; ++j) {
                 size_t found = fu.output_file.find("{channel}");
                 if (found != std::string::npos) fu.output_file.replace(found, 9, scene->mAnimations[i]->mChannels[j]->mNodeName.C_Str());
                 try {
-                    std::ofstream fout(fu.output_file, std::ios::out | std::ios::binary);
-                    if (!fout) {
-                        throw std::runtime_error("cannot open file: " + fu.output_file);
-                    }
-                    fu.put(fout, scene->mAnimations[i]->mChannels[j]);
-                    fout.close();
+                    writeOutput(fu.output_file, settings, [&](std::ostream& out) { fu.put(out, scene->mAnimations[i]->mChannels[j]); });
                 }
                 catch (meshCompilerException& e) {
                     std::cout << e.what() << std::endl;
@@ -1579,9 +3529,44 @@ void mesh_compiler::compileScene(const aiScene* scene, fileUnit fu)
             fu.output_file = orig_name; // go back to original name
             if (errors != 0) {
                 std::cout << "animation compilation ended with errors\n";
-                printf("compiled %d out of %d animation channels\n", scene->mAnimations[i]->mNumChannels - errors, scene->mAnimations[i]->mNumChannels);
+                std::cout << "compiled " << scene->mAnimations[i]->mNumChannels - errors << " out of " << scene->mAnimations[i]->mNumChannels << " animation channels\n";
+                countFailed(settings, errors);
                 return;
             }
         }
     }
 }
+
+// units take turns on each mesh so layouts reading the same streams find them still in cache
+void mesh_compiler::compileMeshes(const aiScene* scene, std::vector<fileUnit> units, const compileSettings& settings)
+{
+    for (fileUnit& fu : units) {
+        fu.emit_pool = settings.emit_pool;
+        size_t found = fu.output_file.find("{scene}");
+        if (found != std::string::npos) fu.output_file.replace(found, 7, scene->mName.C_Str());
+    }
+
+    std::vector<int> errors(units.size(), 0);
+    for (int i = 0; i < scene->mNumMeshes; ++i) {
+        for (size_t u = 0; u < units.size(); ++u) {
+            fileUnit& fu = units[u];
+            std::string name = fu.output_file;
+            size_t found = name.find("{mesh}");
+            if (found != std::string::npos) name.replace(found, 6, scene->mMeshes[i]->mName.C_Str());
+            try {
+                writeOutput(name, settings, [&](std::ostream& out) { fu.put(out, scene->mMeshes[i]); });
+            }
+            catch (meshCompilerException& e) {
+                std::cout << e.what() << std::endl;
+                std::cout << "compilation of mesh: " << scene->mMeshes[i]->mName.C_Str() << " ended up with errors.\n";
+                errors[u] += 1;
+            }
+        }
+    }
+    for (const int& failed : errors) {
+        if (failed == 0) continue;
+        std::cout << "scene compilation ended with errors\n";
+        std::cout << "compiled " << scene->mNumMeshes - failed << " out of " << scene->mNumMeshes << " meshes\n";
+        countFailed(settings, failed);
+    }
+}
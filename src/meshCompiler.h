@@ -4,11 +4,20 @@
 #include <map>
 #include <stdexcept>
 #include <fstream>
+#include <array>
+#include <memory>
+#include <chrono>
+#include <functional>
 #include <assimp/scene.h>
 #include "assimpReader.h"
+#include "glbReader.h"
+#include "lookupTable.h"
 
 #define MAX_BONE_INFLUENCE 4
 
+class compile_cache;
+class thread_pool;
+
 class mesh_compiler {
 public:
     mesh_compiler() = delete;
@@ -16,6 +25,9 @@ public:
     mesh_compiler(mesh_compiler&& other) = delete;
 
     friend class unit_testing;
+    friend class mesh_decoder;
+    friend class output_importer;
+    friend class transcoder;
 
     static std::string version;
 
@@ -106,14 +118,200 @@ private:
     static std::vector<unsigned short> getMaxSuffixes(const value& t);
     static void copyConstantToMemory(void* dst, const type& type, const std::string& val);
 
-    static std::map<std::string, value> preambleMap;
-    static std::map<std::string, value> fieldsMap;
-    static std::map<std::string, type> typesMap;
-    static std::map<type, unsigned short> typeSizesMap;
-
-    static std::map<type, std::string> typeNamesMap;
-    static std::map<value, std::string> valueNamesMap;
-    static std::map<counting_type, std::string> countingTypeNamesMap;
+    // constexpr so a bad entry or a failed seed search is a build error, see lookupTable.h,
+    // sizes are entry counts and enumerator counts
+    static constexpr keyword_table<value, 9> preambleMap = { {
+        {"buffu", value::buffers_per_unit },
+        {"buffs", value::buffer_size },
+        {"entryu", value::entries_per_unit },
+        {"entryb", value::entries_per_buffer },
+        {"entrys", value::entry_size },
+        {"fieldu", value::fields_per_unit },
+        {"fieldb", value::fields_per_buffer },
+        {"fielde", value::fields_per_entry },
+        {"fields", value::field_size },
+    } };
+
+    static constexpr keyword_table<value, 39> fieldsMap = { {
+        { "i", value::indice},
+        { "indice", value::indice},
+
+        { "v", value::vertex},
+        { "vert", value::vertex},
+        { "vertex", value::vertex},
+        { "n", value::normal},
+        { "normal", value::normal},
+        { "tc", value::uv},
+        { "tex_coord", value::uv},
+        { "texture_coordinate", value::uv},
+        { "uv", value::uv },
+        { "t", value::tangent },
+        { "tangent", value::tangent },
+        { "b", value::bitangent },
+        { "bitangent", value::bitangent},
+        { "vertex_color", value::vertex_color },
+        { "bone_id", value::bone_id },
+        { "bone_weight", value::bone_weight },
+
+        { "off_matr", value::offset_matrix },
+        { "off_matrix", value::offset_matrix },
+        { "offset_matr", value::offset_matrix },
+        { "offset_matrix", value::offset_matrix },
+
+        { "position_key", value::position_key },
+        { "rotation_key", value::rotation_key },
+        { "scale_key", value::scale_key },
+        { "position_key_timestamp", value::position_key_timestamp },
+        { "rotation_key_timestamp", value::rotation_key_timestamp },
+        { "scale_key_timestamp", value::scale_key_timestamp },
+        { "position_key_time", value::position_key_timestamp },
+        { "rotation_key_time", value::rotation_key_timestamp },
+        { "scale_key_time", value::scale_key_timestamp },
+        { "position_timestamp", value::position_key_timestamp },
+        { "rotation_timestamp", value::rotation_key_timestamp },
+        { "scale_timestamp", value::scale_key_timestamp },
+        { "position_time", value::position_key_timestamp },
+        { "rotation_time", value::rotation_key_timestamp },
+        { "scale_time", value::scale_key_timestamp },
+
+        { "duration", value::duration },
+        { "ticks_per_second", value::ticks_per_second }
+    } };
+
+    static constexpr keyword_table<type, 30> typesMap = { {
+        {"char", mc_char},
+        {"short", mc_short},
+        {"int", mc_int},
+        {"long", mc_long},
+        {"long_long", mc_long_long},
+        {"int2", mc_short},
+        {"int4", mc_int},
+        {"int8", mc_long},
+        {"int16", mc_long_long},
+        {"unsigned_short", mc_unsigned_short},
+        {"unsigned_int", mc_unsigned_int},
+        {"unsigned_long", mc_unsigned_long},
+        {"unsigned_long_long", mc_unsigned_long_long},
+        {"unsigned_int2", mc_unsigned_short},
+        {"unsigned_int4", mc_unsigned_int},
+        {"unsigned_int8", mc_unsigned_long},
+        {"unsigned_int16", mc_unsigned_long_long},
+        {"ushort", mc_unsigned_short},
+        {"uint", mc_unsigned_int},
+        {"ulong", mc_unsigned_long},
+        {"uint2", mc_unsigned_short},
+        {"uint4", mc_unsigned_int},
+        {"uint8", mc_unsigned_long},
+        {"uint16", mc_unsigned_long_long},
+        {"float", mc_float},
+        {"float4", mc_float},
+        {"double", mc_double},
+        {"float8", mc_double},
+        {"long_double", mc_long_double},
+        {"float16", mc_long_double}
+    } };
+
+    static constexpr enum_table<type, unsigned short, mc_long_double + 1> typeSizesMap = { {
+        {mc_char, sizeof(char)},
+        {mc_short, sizeof(short)},
+        {mc_int, sizeof(int)},
+        {mc_long, sizeof(long)},
+        {mc_long_long, sizeof(long long)},
+        {mc_unsigned_short, sizeof(unsigned short)},
+        {mc_unsigned_int, sizeof(unsigned int)},
+        {mc_unsigned_long, sizeof(unsigned long)},
+        {mc_unsigned_long_long, sizeof(unsigned long long)},
+        {mc_float, sizeof(float)},
+        {mc_double, sizeof(double)},
+        {mc_long_double, sizeof(long double)}
+    } };
+
+    static constexpr enum_table<type, const char*, mc_long_double + 1> typeNamesMap = { {
+        {mc_none, "null"},
+        {mc_unit, "unit"},
+        {mc_char, "char"},
+        {mc_short, "int2"},
+        {mc_int, "int4"},
+        {mc_long, "int8"},
+        {mc_long_long, "int16"},
+        {mc_unsigned_short, "uint2"},
+        {mc_unsigned_int, "uint4"},
+        {mc_unsigned_long, "uint8"},
+        {mc_unsigned_long_long, "uint16"},
+        {mc_float, "float4"},
+        {mc_double, "float8"},
+        {mc_long_double, "float16"}
+    } };
+
+    static constexpr enum_table<value, const char*, static_cast<size_t>(value::fields_per_entry) + 1> valueNamesMap = { {
+        { value::null, "null"},
+
+        { value::constant, "const"},
+        { value::other_unit, "other_unit"},
+
+        { value::indice, "indice" },
+        { value::vertex, "vertex"},
+        { value::normal, "normal"},
+        { value::tangent, "tangent"},
+        { value::bitangent, "bitangent"},
+        { value::uv, "uv" },
+        { value::vertex_color, "vertex_color"},
+        { value::bone_id, "bone_id"},
+        { value::bone_weight, "bone_weight"},
+
+        { value::offset_matrix, "offset_matrix"},
+
+        { value::position_key, "position_key"},
+        { value::rotation_key, "rotation_key"},
+        { value::scale_key, "scale_key"},
+        { value::position_key_timestamp, "position_key_timestamp"},
+        { value::rotation_key_timestamp, "rotation_key_timestamp"},
+        { value::scale_key_timestamp, "scale_key_timestamp"},
+
+        { value::duration, "duration"},
+        { value::ticks_per_second, "ticks_per_second"},
+
+        { value::unit_size, "units" },
+        { value::buffer_size, "buffs" },
+        { value::buffers_per_unit, "buffu" },
+        { value::entry_size, "entrys" },
+        { value::entries_per_unit, "entryu" },
+        { value::entries_per_buffer, "entryb" },
+        { value::field_size, "fields"},
+        { value::fields_per_unit, "fieldu" },
+        { value::fields_per_buffer, "fieldb"},
+        { value::fields_per_entry, "fielde" }
+    } };
+
+    static constexpr enum_table<counting_type, const char*, static_cast<size_t>(counting_type::per_scene) + 1> countingTypeNamesMap = { {
+        {counting_type::null, "null"},
+        {counting_type::per_indice, "per_indice"},
+        {counting_type::per_vertex, "per_vertex"},
+        {counting_type::per_mesh_bone, "per_mesh_bone"},
+        {counting_type::per_mesh, "per_mesh"},
+        {counting_type::per_bone, "per_bone"},
+        {counting_type::per_skeleton, "per_skeleton"},
+        {counting_type::per_position_keyframe, "per_position_keyframe"},
+        {counting_type::per_rotation_keyframe, "per_rotation_keyframe"},
+        {counting_type::per_scale_keyframe, "per_scale_keyframe"},
+        {counting_type::per_animation_channel, "per_animation_channel"},
+        {counting_type::per_animation, "per_animation"},
+        {counting_type::per_scene, "per_scene"}
+    } };
+
+    static constexpr keyword_table<unsigned int, 11> postProcessMap = { {
+        {"tangents", aiProcess_CalcTangentSpace},
+        {"triangulate", aiProcess_Triangulate},
+        {"join", aiProcess_JoinIdenticalVertices},
+        {"sort", aiProcess_SortByPType},
+        {"remove_components", aiProcess_RemoveComponent},
+        {"normals", aiProcess_GenNormals},
+        {"smooth_normals", aiProcess_GenSmoothNormals},
+        {"flip_uvs", aiProcess_FlipUVs},
+        {"limit_bone_weights", aiProcess_LimitBoneWeights},
+        {"cache_locality", aiProcess_ImproveCacheLocality},
+        {"validate", aiProcess_ValidateDataStructure}
+    } };
 
 // ========== EXCEPTIONS ==========
 
@@ -150,7 +348,27 @@ private:
         bool filled;
         std::string msg = "";
     private:
-        static std::map<error_code, std::string> errorMessagesMap;
+        static constexpr enum_table<error_code, const char*, static_cast<size_t>(error_code::unknown) + 1> errorMessagesMap = { {
+            {error_code::unknown_statement, "unknown statement"},
+            {error_code::no_suffix, "field suffix not provided"},
+            {error_code::invalid_suffix, "invalid field suffix"},
+            {error_code::wrong_suffixes_amount, "wrong amount of suffixes"},
+            {error_code::no_const_value, "constant value not provided"},
+            {error_code::invalid_const_value, "invalid const value"},
+            {error_code::invalid_type_specifier, "invalid type specifier"},
+            {error_code::byte_base_in_count_type, "given byte base in count type"},
+            {error_code::field_spec_in_preamble, "attempted field specification in preamble"},
+            {error_code::unsupported_type, "unsupported type"},
+            {error_code::conflicting_buffer_fields, "confilcting types detected in single buffer"},
+            {error_code::conflicting_unit_fields, "confilcting types detected in single unit"},
+            {error_code::constants_only, "detected buffer of only constants - unknown buffer size"},
+            {error_code::no_unit_name, "unit name unspecified"},
+            {error_code::no_file_name, "file name unspecified"},
+            {error_code::unit_redefinition, "unit redefinition"},
+            {error_code::name_keyword_collision, "unit name collides with keyword"},
+            {error_code::no_end, "end key word expected"},
+            {error_code::unknown, "unknown error"}
+        } };
     };
 
     class meshCompilerException : public std::exception {
@@ -179,15 +397,20 @@ private:
         void setData(const void* data_source, const size_t& data_amount);
 
         size_t get_size() const;
+        // bytes the matching put writes, buffer level values repeat per field or per buffer
+        size_t get_size(const compileBuffer& buffer) const;
+        size_t get_size(const compileUnit& unit) const;
         std::string get_otherUnitName() const;
         void print(const int& indent = 0) const;
 
-        void put(std::ofstream& file, const compileBuffer& buffer) const;
-        void put(std::ofstream& file, const std::vector<compileBuffer>& buffers) const;
-        void put(std::ofstream& file, const compileUnit& unit) const;
+        void put(std::ostream& file, const compileBuffer& buffer) const;
+        void put(std::ostream& file, const std::vector<compileBuffer>& buffers) const;
+        void put(std::ostream& file, const compileUnit& unit) const;
 
         bool operator==(const compileField& other) const;
         bool operator!=(const compileField& other) const;
+
+        void appendKey(std::string& key) const;
     };
 
     class compileBuffer {
@@ -199,11 +422,14 @@ private:
 
         size_t get_entry_size() const;
         size_t get_size() const;
+        std::string get_field_kinds() const;
         void print(const int& indent = 0) const;
         void clear();
 
         bool operator==(const compileBuffer& other) const;
         bool operator!=(const compileBuffer& other) const;
+
+        void appendKey(std::string& key) const;
     };
 
     class compileUnit {
@@ -212,6 +438,8 @@ private:
         std::vector<compileBuffer> buffers;
         counting_type count_type = counting_type::null;
         std::map<std::string, compileUnit>* unitsMap = nullptr;
+        thread_pool* emit_pool = nullptr; // emits ranges of large per_vertex and per_indice buffers, null and nested units emit serially
+        std::string name; // as declared in the format file, names trace spans only
 
         compileUnit() = default;
         compileUnit(std::ifstream& file, size_t& line_num, /*const*/ std::map<std::string, compileUnit>* unitsMap);
@@ -219,19 +447,32 @@ private:
         size_t get_size() const;
         size_t get_entries_count() const;
         size_t get_fields_count() const;
+        bool uses(const value& v) const;
+        bool uses(const counting_type& ct) const;
         void print(const int& indent = 0) const;
         void clear();
 
-        void put(std::ofstream& file, const aiNodeAnim* animation_channel);
-        void put(std::ofstream& file, const aiSkeleton* skeleton);
-        void put(std::ofstream& file, const aiAnimation* animation);
-        void put(std::ofstream& file, const aiMesh* mesh);
-        void put(std::ofstream& file, const aiMesh* mesh, const assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>& mw);
-        void put(std::ofstream& file, const aiScene* scene);
+        void put(std::ostream& file, const aiNodeAnim* animation_channel);
+        void put(std::ostream& file, const aiSkeleton* skeleton);
+        void put(std::ostream& file, const aiAnimation* animation);
+        void put(std::ostream& file, const aiMesh* mesh);
+        void put(std::ostream& file, const aiMesh* mesh, const assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>& mw);
+        void put(std::ostream& file, const aiScene* scene);
+        void put(std::ostream& file, const glb_reader::meshView& mesh);
+
+        // bytes put() would emit for the object, one report line per unit and buffer, nothing is emitted
+        size_t measure(std::ostream& report, const aiNodeAnim* animation_channel, const int& indent = 0);
+        size_t measure(std::ostream& report, const aiSkeleton* skeleton, const int& indent = 0);
+        size_t measure(std::ostream& report, const aiAnimation* animation, const int& indent = 0);
+        size_t measure(std::ostream& report, const aiMesh* mesh, const int& indent = 0);
+        size_t measure(std::ostream& report, const glb_reader::meshView& mesh, const int& indent = 0);
+        size_t measure(std::ostream& report, const aiScene* scene, const int& indent = 0);
 
         bool operator==(const compileUnit& other) const;
         bool operator!=(const compileUnit& other) const;
 
+        void appendKey(std::string& key) const;
+
     private:
         static type extractType(std::string& word);
         static value extractPreambleValue(std::string& word);
@@ -240,6 +481,20 @@ private:
         static bool isFieldValue(type t, std::string& arg, std::vector<compileField>& fields, counting_type& field_count, counting_type& unit_count);
         static bool isConstValue(const type& t, std::string& arg, std::vector<compileField>& fields);
         static bool isOtherUnitValue(const type& t, std::string& arg, std::vector<compileField>& fields, counting_type& count_type, /*const*/ std::map<std::string, compileUnit>& unitsMap);
+
+        void putEntries(std::ostream& file, const compileBuffer& buffer, const aiMesh* mesh, const assimp::meshWeights<int, float, MAX_BONE_INFLUENCE>& mw, const size_t& first, const size_t& last) const;
+        void putEntries(std::ostream& file, const compileBuffer& buffer, const glb_reader::meshView& mesh, const size_t& first, const size_t& last) const;
+        template <typename Emit>
+        void putRanges(std::ostream& file, const compileBuffer& buffer, Emit emit_entries) const;
+        void fillCounts(const aiNodeAnim* animation_channel);
+        void fillCounts(const aiSkeleton* skeleton);
+        void fillCounts(const aiAnimation* animation);
+        void fillCounts(const aiMesh* mesh);
+        void fillCounts(const glb_reader::meshView& mesh);
+        void fillCounts(const aiScene* scene);
+        void countBytes() const;
+        template <typename Same, typename Nested>
+        size_t measureUnit(std::ostream& report, const int& indent, const std::string& object, Same same, Nested nested);
     };
 
     class fileUnit : public compileUnit {
@@ -256,6 +511,41 @@ private:
         std::vector<fileUnit> file_units;
 
         compilationInfo(const std::string& format_file, const bool& debug_messages = false);
+        compilationInfo(const compilationInfo& other); // copy units point to its own units map
+        compilationInfo& operator=(const compilationInfo& other);
+
+        bool uses(const value& v) const;
+        bool uses(const counting_type& ct) const;
+        assimp::importSettings get_import_settings() const;
+        std::string get_cache_key() const; // parsed format as bytes, comments and spacing do not change it
+    };
+
+    class compileSettings {
+    public:
+        assimp::importSettings import;
+        std::ostream* output_stream = nullptr; // outputs are written as frames to this stream instead of files
+        bool native_import = true; // try native_reader before assimp
+        size_t memory_limit = 0; // stream binary ply sources in chunks of this size, 0 reads whole model
+        std::string source_format; // source is an output compiled with this format, empty for model files
+        bool transcode = false; // copy source_format fields column by column instead of rebuilding a scene
+        thread_pool* emit_pool = nullptr; // see compileUnit::emit_pool, shared by every unit of the run
+        std::vector<std::string>* produced_outputs = nullptr; // names of written outputs are appended here
+        size_t* failed_outputs = nullptr; // outputs that ended up with errors and were not written are counted here
+        compile_cache* cache = nullptr; // outputs are restored from here when possible and stored after compiling
+        compile_cache* scene_cache = nullptr; // imported scenes are kept here as scene files, keyed by source bytes and import settings
+        std::function<void(const std::string& name, std::string& data)> output_sink; // takes finished outputs instead of writing them, streamed outputs bypass it
+    };
+
+    class batchTask {
+    public:
+        std::string source;
+        std::string format_file;
+    };
+
+    class batchResult {
+    public:
+        std::string error; // empty if task compiled
+        std::vector<std::string> outputs;
     };
 
 // ========== RUNNING METHODS ==========
@@ -267,28 +557,71 @@ public:
     static void runOnceDebug(const std::vector<std::string>& args);
 #endif // _DEBUG
 
+    // compiles model held in memory, hint is its file extension (e.g. "obj", "glb"), name replaces {file},
+    // throws std::runtime_error if the format file can not be read or parsed
+    static void compileMemory(const void* data, const size_t& size, const std::string& hint, const std::string& format_file, const std::string& name = "memory");
+
 private:
     static void compile(const std::vector<std::string>& args);
-    static void compileFile(const std::string& filename, compilationInfo ci);
-    static void compileScene(const aiScene* scene, fileUnit ci);
+    static bool compileFile(const std::string& filename, compilationInfo ci, const compileSettings& settings);
+    static bool compileFormats(const std::string& filename, const std::vector<compilationInfo>& formats, const std::string& import_overrides, const compileSettings& settings);
+    static bool compileCached(const std::string& filename, const compilationInfo& ci, const compileSettings& settings);
+    static bool cacheable(const compileSettings& settings);
+    static std::string cacheKey(const std::string& filename, const compilationInfo& ci, const compileSettings& settings);
+    static bool keyFiles(const std::string& filename, std::vector<std::string>& files);
+    static bool restoreCached(const std::string& key, const compileSettings& settings);
+    static void compileMemory(const void* data, const size_t& size, const std::string& hint, const std::string& name, compilationInfo ci, const compileSettings& settings);
+    static void compileStdin(const std::string& hint, compilationInfo ci, const compileSettings& settings);
+    static void compileOutput(const std::string& filename, compilationInfo ci, const compileSettings& settings);
+    static void compileTranscoded(const std::string& filename, compilationInfo ci, const compileSettings& settings);
+    static void expandFileName(fileUnit& fu, const std::string& filename);
+    static void applyImportOverrides(assimp::importSettings& import, const std::string& overrides);
+    static void applyFormatImport(compileSettings& settings, const compilationInfo& ci, const std::string& import_overrides);
+    static std::vector<batchTask> readManifest(const std::string& manifest, const std::string& default_format);
+    static std::vector<batchTask> listDirectory(const std::string& directory, const std::string& glob, const std::string& default_format);
+    static std::vector<batchResult> compileBatch(const std::vector<batchTask>& tasks, const std::string& import_overrides, const compileSettings& base, const unsigned int& jobs);
+    static std::vector<batchResult> compilePipelined(const std::vector<batchTask>& tasks, const std::string& import_overrides, const compileSettings& base, const std::array<unsigned int, 3>& stage_jobs);
+    static void parseBatchFormats(const std::vector<batchTask>& tasks, const bool& debug_messages, std::map<std::string, std::unique_ptr<compilationInfo>>& formats, std::map<std::string, std::string>& format_errors);
+    static void checkBatchOutputs(const std::vector<batchTask>& tasks);
+    static void printBatchSummary(const std::vector<batchTask>& tasks, const std::vector<batchResult>& results, const std::chrono::steady_clock::time_point& start, const std::string& workers);
+    static unsigned long long shardHash(const std::string& source);
+    static void parseShard(const std::string& text, unsigned int& shard, unsigned int& shard_count);
+    static std::vector<batchTask> selectShard(const std::vector<batchTask>& tasks, const std::string& root, const unsigned int& shard, const unsigned int& shard_count);
+    static void writeIndex(const std::string& index, const std::string& shard, const std::vector<std::pair<std::string, std::string>>& entries);
+    static void mergeIndexes(const std::string& index, const std::vector<std::string>& partials);
+    static aiScene* importModel(const std::string& filename, const compilationInfo& ci, const compileSettings& settings);
+    static aiScene* importScene(const std::string& filename, const compileSettings& settings);
+    static aiScene* importOutput(const std::string& filename, const compilationInfo& ci, const compileSettings& settings);
+    static std::array<unsigned int, 3> parseStageJobs(const std::string& text);
+    static void compileScene(const aiScene* scene, fileUnit ci, const compileSettings& settings);
+    static void countFailed(const compileSettings& settings, const size_t& failed);
+    static void compileMeshes(const aiScene* scene, std::vector<fileUnit> units, const compileSettings& settings);
+    static bool compileGlb(const std::string& filename, fileUnit fu, const compileSettings& settings);
+    static void dryRun(const std::string& filename, compilationInfo ci, const compileSettings& settings, std::ostream& report);
+    static bool viewProvides(const compileUnit& unit, const glb_reader::meshView& mesh);
+    static size_t parseMemorySize(const std::string& text);
+    static unsigned int parseJobCount(const std::string& text);
+    static bool streamable(const compileUnit& unit);
+    static void compileStreamed(const std::string& filename, fileUnit fu, const compileSettings& settings);
+    static void writeOutput(const std::string& name, const compileSettings& settings, std::function<void(std::ostream&)> emit);
 
 
     template <typename T>
-    static void writeConst(std::ofstream& file, const T& value);
+    static void writeConst(std::ostream& file, const T& value);
 
     template <typename T>
-    static void writeConst(std::ofstream& file, const T& value, const mesh_compiler::type& type);
+    static void writeConst(std::ostream& file, const T& value, const mesh_compiler::type& type);
 };
 
 template<typename T>
-inline void mesh_compiler::writeConst(std::ofstream& file, const T& value)
+inline void mesh_compiler::writeConst(std::ostream& file, const T& value)
 {
     T x = value;
     file.write((char*)&x, sizeof(T));
 }
 
 template<typename T>
-inline void mesh_compiler::writeConst(std::ofstream& file, const T& value, const mesh_compiler::type& type)
+inline void mesh_compiler::writeConst(std::ostream& file, const T& value, const mesh_compiler::type& type)
 {
     switch (type)
     {
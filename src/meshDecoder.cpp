@@ -0,0 +1,292 @@
+#include "meshDecoder.h"
+#include <iostream>
+
+// ========== READER ==========
+
+mesh_decoder::reader::reader(const std::string& filename) : file(filename, std::ios::in | std::ios::binary)
+{
+    if (!file) throw std::runtime_error("could not open file: " + filename);
+    file.seekg(0, std::ios::end);
+    file_size = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+}
+
+size_t mesh_decoder::reader::read(const mesh_compiler::type& type)
+{
+    union {
+        char c;
+        short s;
+        unsigned short us;
+        int i;
+        unsigned int ui;
+        long l;
+        unsigned long ul;
+        long long ll;
+        unsigned long long ull;
+        float f;
+        double d;
+        long double ld;
+    } data;
+
+    size_t siz = mesh_compiler::typeSizesMap[type];
+    if (pos + siz > file_size) throw std::runtime_error("unexpected end of file at byte " + std::to_string(pos));
+    file.read((char*)&data, siz);
+    pos += siz;
+
+    switch (type)
+    {
+    case mesh_compiler::mc_char: return static_cast<size_t>(data.c);
+    case mesh_compiler::mc_short: return static_cast<size_t>(data.s);
+    case mesh_compiler::mc_unsigned_short: return static_cast<size_t>(data.us);
+    case mesh_compiler::mc_int: return static_cast<size_t>(data.i);
+    case mesh_compiler::mc_unsigned_int: return static_cast<size_t>(data.ui);
+    case mesh_compiler::mc_long: return static_cast<size_t>(data.l);
+    case mesh_compiler::mc_unsigned_long: return static_cast<size_t>(data.ul);
+    case mesh_compiler::mc_long_long: return static_cast<size_t>(data.ll);
+    case mesh_compiler::mc_unsigned_long_long: return static_cast<size_t>(data.ull);
+    case mesh_compiler::mc_float: return static_cast<size_t>(data.f);
+    case mesh_compiler::mc_double: return static_cast<size_t>(data.d);
+    case mesh_compiler::mc_long_double: return static_cast<size_t>(data.ld);
+    default:
+        throw std::logic_error("unknown type");
+    }
+}
+
+void mesh_decoder::reader::skip(const size_t& amount)
+{
+    if (pos + amount > file_size) throw std::runtime_error("unexpected end of file at byte " + std::to_string(pos));
+    pos += amount;
+    file.seekg(pos, std::ios::beg);
+}
+
+// ========== BUFFER HINTS ==========
+
+const size_t mesh_decoder::bufferHints::unknown;
+
+size_t mesh_decoder::bufferHints::get_count(const mesh_compiler::compileBuffer& buffer) const
+{
+    if (count != unknown) return count;
+
+    size_t entry_size = buffer.get_entry_size();
+    if (buffer_size != unknown && entry_size != 0) return buffer_size / entry_size;
+
+    if (fields_per_buffer != unknown && !buffer.fields.empty()) return fields_per_buffer / buffer.fields.size();
+
+    return unknown;
+}
+
+// ========== DECODER ==========
+
+mesh_decoder::mesh_decoder(const std::string& format_file) : ci(format_file)
+{
+}
+
+mesh_decoder::unitRecord mesh_decoder::decode(const std::string& output_file) const
+{
+    return decode(output_file, findFileUnit(output_file));
+}
+
+mesh_decoder::unitRecord mesh_decoder::decode(const std::string& output_file, const size_t& file_unit) const
+{
+    if (file_unit >= ci.file_units.size()) throw std::runtime_error("format has no file unit with index: " + std::to_string(file_unit));
+
+    reader r(output_file);
+    unitRecord record;
+    decodeUnit(r, ci.file_units[file_unit], ci.file_units[file_unit].output_file, record);
+    if (r.pos != r.file_size) throw std::runtime_error("file: " + output_file + " has " + std::to_string(r.file_size - r.pos) + " trailing bytes, it does not match format");
+    return record;
+}
+
+size_t mesh_decoder::findFileUnit(const std::string& output_file) const
+{
+    if (ci.file_units.size() == 1) return 0;
+
+    std::string base_filename = output_file.substr(output_file.find_last_of("/\\") + 1);
+    size_t found = ci.file_units.size();
+    for (size_t i = 0; i < ci.file_units.size(); ++i) {
+        const std::string& pattern = ci.file_units[i].output_file;
+        std::string base_pattern = pattern.substr(pattern.find_last_of("/\\") + 1);
+        if (matchesPattern(output_file, pattern) || matchesPattern(base_filename, base_pattern)) {
+            if (found != ci.file_units.size()) throw std::runtime_error("file: " + output_file + " matches more than one file unit");
+            found = i;
+        }
+    }
+    if (found == ci.file_units.size()) throw std::runtime_error("file: " + output_file + " does not match any file unit");
+    return found;
+}
+
+const mesh_compiler::compilationInfo& mesh_decoder::get_compilation_info() const
+{
+    return ci;
+}
+
+// {file}, {scene}, {mesh}, {skeleton}, {animation} and {channel} match any text, * and ? work as usual
+bool mesh_decoder::matchesPattern(const std::string& name, const std::string& pattern)
+{
+    static const std::vector<std::string> placeholders = { "{file}", "{scene}", "{mesh}", "{skeleton}", "{animation}", "{channel}" };
+
+    std::string wildcard = pattern;
+    for (const std::string& p : placeholders) {
+        size_t found = wildcard.find(p);
+        while (found != std::string::npos) {
+            wildcard.replace(found, p.size(), "*");
+            found = wildcard.find(p);
+        }
+    }
+
+    size_t n = 0, w = 0;
+    size_t star = std::string::npos, match = 0;
+    while (n < name.size()) {
+        if (w < wildcard.size() && (wildcard[w] == '?' || wildcard[w] == name[n])) {
+            ++n; ++w;
+        }
+        else if (w < wildcard.size() && wildcard[w] == '*') {
+            star = w++;
+            match = n;
+        }
+        else if (star != std::string::npos) {
+            w = star + 1;
+            n = ++match;
+        }
+        else return false;
+    }
+    while (w < wildcard.size() && wildcard[w] == '*') ++w;
+    return w == wildcard.size();
+}
+
+void mesh_decoder::decodeBufferValue(reader& r, const mesh_compiler::compileField& field, const mesh_compiler::compileBuffer& buffer, bufferHints& hints) const
+{
+    switch (field.vtype)
+    {
+    case mesh_compiler::value::buffer_size:
+        hints.buffer_size = r.read(field.stype);
+        break;
+    case mesh_compiler::value::entry_size: {
+        size_t entry_size = r.read(field.stype);
+        if (entry_size != buffer.get_entry_size()) throw std::runtime_error("entry size at byte " + std::to_string(r.pos) + " does not match format");
+        break;
+    }
+    case mesh_compiler::value::entries_per_buffer:
+        hints.count = r.read(field.stype);
+        break;
+    case mesh_compiler::value::field_size:
+        r.skip(field.get_size() * buffer.fields.size());
+        break;
+    case mesh_compiler::value::fields_per_entry:
+        r.skip(field.get_size());
+        break;
+    case mesh_compiler::value::fields_per_buffer:
+        hints.fields_per_buffer = r.read(field.stype);
+        break;
+    default:
+        throw std::logic_error(std::string("flag could not be handled with this function call, flag: ") + mesh_compiler::valueNamesMap[field.vtype]);
+    }
+}
+
+void mesh_decoder::decodeUnit(reader& r, const mesh_compiler::compileUnit& unit, const std::string& name, unitRecord& record) const
+{
+    record.name = name;
+    record.offset = r.pos;
+
+    std::vector<bufferHints> hints(unit.buffers.size());
+    size_t entries_per_unit = bufferHints::unknown;
+
+    // preamble
+    for (const mesh_compiler::compileField& field : unit.preamble) {
+        switch (field.vtype)
+        {
+        case mesh_compiler::value::constant:
+            r.skip(field.get_size());
+            break;
+        case mesh_compiler::value::other_unit:
+            record.preamble_units.push_back(unitRecord());
+            decodeUnit(r, ci.units.at(field.get_otherUnitName()), field.get_otherUnitName(), record.preamble_units.back());
+            break;
+        case mesh_compiler::value::buffers_per_unit:
+            if (r.read(field.stype) != unit.buffers.size()) throw std::runtime_error("buffer count at byte " + std::to_string(r.pos) + " does not match format");
+            break;
+        case mesh_compiler::value::entries_per_unit:
+            entries_per_unit = r.read(field.stype);
+            break;
+        case mesh_compiler::value::fields_per_unit:
+            r.skip(field.get_size());
+            break;
+        default:
+            for (size_t i = 0; i < unit.buffers.size(); ++i) decodeBufferValue(r, field, unit.buffers[i], hints[i]);
+            break;
+        }
+    }
+
+    // buffers
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        const mesh_compiler::compileBuffer& buffer = unit.buffers[i];
+        record.buffers.push_back(bufferRecord());
+        bufferRecord& br = record.buffers.back();
+
+        // buffer preamble
+        for (const mesh_compiler::compileField& field : buffer.preamble) {
+            if (field.vtype == mesh_compiler::value::constant) r.skip(field.get_size());
+            else if (field.vtype == mesh_compiler::value::other_unit) {
+                record.preamble_units.push_back(unitRecord());
+                decodeUnit(r, ci.units.at(field.get_otherUnitName()), field.get_otherUnitName(), record.preamble_units.back());
+            }
+            else decodeBufferValue(r, field, buffer, hints[i]);
+        }
+
+        // count
+        br.count = hints[i].get_count(buffer);
+        if (br.count == bufferHints::unknown && entries_per_unit != bufferHints::unknown) {
+            size_t rest = entries_per_unit;
+            for (size_t j = 0; j < unit.buffers.size() && rest != bufferHints::unknown; ++j) {
+                if (j == i) continue;
+                size_t c = hints[j].get_count(unit.buffers[j]);
+                rest = (c == bufferHints::unknown || c > rest) ? bufferHints::unknown : rest - c;
+            }
+            br.count = rest;
+        }
+        if (br.count == bufferHints::unknown) throw std::runtime_error("could not determine entry count of buffer " + std::to_string(i) + " of unit: " + name + ", format does not store it");
+
+        // fields
+        br.offset = r.pos;
+        bool nested = false;
+        for (const mesh_compiler::compileField& field : buffer.fields) {
+            if (field.vtype == mesh_compiler::value::other_unit) nested = true;
+        }
+        if (!nested) {
+            br.entry_size = buffer.get_entry_size();
+            r.skip(br.entry_size * br.count);
+        }
+        else {
+            for (size_t j = 0; j < br.count; ++j) {
+                br.entry_offsets.push_back(r.pos);
+                for (const mesh_compiler::compileField& field : buffer.fields) {
+                    if (field.vtype == mesh_compiler::value::other_unit) {
+                        br.units.push_back(unitRecord());
+                        decodeUnit(r, ci.units.at(field.get_otherUnitName()), field.get_otherUnitName(), br.units.back());
+                    }
+                    else r.skip(field.get_size());
+                }
+            }
+        }
+        br.size = r.pos - br.offset;
+    }
+
+    record.size = r.pos - record.offset;
+}
+
+// ========== PRINTING ==========
+
+void mesh_decoder::bufferRecord::print(const int& indent) const
+{
+    for (int i = 0; i < indent; ++i) std::cout << " ";
+    std::cout << "BUFFER: offset: " << offset << ", count: " << count << ", entry size: " << entry_size << ", size: " << size << "\n";
+    for (const unitRecord& u : units) u.print(indent + 2);
+}
+
+void mesh_decoder::unitRecord::print(const int& indent) const
+{
+    for (int i = 0; i < indent; ++i) std::cout << " ";
+    std::cout << "UNIT: " << name << ", offset: " << offset << ", size: " << size << "\n";
+    for (const unitRecord& u : preamble_units) u.print(indent + 2);
+    for (const bufferRecord& b : buffers) b.print(indent + 2);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include "meshCompiler.h"
+
+// walks files produced by mesh_compiler using the same format file they were compiled with
+// and returns locations of all buffers without reading their contents
+class mesh_decoder {
+public:
+    class unitRecord;
+
+    class bufferRecord {
+    public:
+        size_t offset = 0; // first entry (after buffer preamble)
+        size_t count = 0;
+        size_t entry_size = 0; // 0 if entries contain nested units
+        size_t size = 0; // all entries
+        std::vector<unitRecord> units; // nested units in entry order
+        std::vector<size_t> entry_offsets; // start of every entry, only if entries contain nested units
+
+        void print(const int& indent = 0) const;
+    };
+
+    class unitRecord {
+    public:
+        std::string name;
+        size_t offset = 0;
+        size_t size = 0;
+        std::vector<unitRecord> preamble_units;
+        std::vector<bufferRecord> buffers;
+
+        void print(const int& indent = 0) const;
+    };
+
+    mesh_decoder(const std::string& format_file);
+
+    unitRecord decode(const std::string& output_file) const;
+    unitRecord decode(const std::string& output_file, const size_t& file_unit) const;
+
+    size_t findFileUnit(const std::string& output_file) const;
+    const mesh_compiler::compilationInfo& get_compilation_info() const;
+    static bool matchesPattern(const std::string& name, const std::string& pattern);
+
+private:
+    mesh_compiler::compilationInfo ci;
+
+    class reader {
+    public:
+        std::ifstream file;
+        size_t pos = 0;
+        size_t file_size = 0;
+
+        reader(const std::string& filename);
+        size_t read(const mesh_compiler::type& type);
+        void skip(const size_t& amount);
+    };
+
+    class bufferHints {
+    public:
+        static const size_t unknown = static_cast<size_t>(-1);
+        size_t count = unknown;
+        size_t buffer_size = unknown;
+        size_t fields_per_buffer = unknown;
+
+        size_t get_count(const mesh_compiler::compileBuffer& buffer) const;
+    };
+
+    void decodeUnit(reader& r, const mesh_compiler::compileUnit& unit, const std::string& name, unitRecord& record) const;
+    void decodeBufferValue(reader& r, const mesh_compiler::compileField& field, const mesh_compiler::compileBuffer& buffer, bufferHints& hints) const;
+};
@@ -1,6 +1,9 @@
 #pragma once
 #include <fstream>
+#include <istream>
+#include <string>
 #include <vector>
+#include <stdexcept>
 #define allocation_limit 10485760 // 10 MB
 
 namespace mesh_reader {
@@ -9,6 +12,9 @@ namespace mesh_reader {
 
 	template <typename T, typename U>
 	void readBuffer(std::ifstream& file, std::vector<T>& buffer, const U& count);
+
+	// reads one output frame written by mesh compiler with --stdout flag, returns false at end of stream
+	inline bool readFrame(std::istream& stream, std::string& name, std::vector<char>& data);
 }
 
 template<typename T, typename U>
@@ -31,6 +37,29 @@ inline void mesh_reader::readBuffer(std::ifstream& file, std::vector<T>& buffer,
 	file.read((char*)(buffer.data()), count * sizeof(T));
 }
 
+inline bool mesh_reader::readFrame(std::istream& stream, std::string& name, std::vector<char>& data)
+{
+	unsigned int name_size;
+	if (!stream.read((char*)&name_size, sizeof(unsigned int))) return false;
+#ifdef allocation_limit
+	if (name_size > allocation_limit)
+		throw std::runtime_error("allocation limit exceeded");
+#endif // allocation_limit
+	name.resize(name_size);
+	stream.read(&name[0], name_size);
+
+	unsigned long long size = 0;
+	if (!stream.read((char*)&size, sizeof(unsigned long long))) throw std::runtime_error("unexpected end of stream");
+#ifdef allocation_limit
+	if (size > allocation_limit)
+		throw std::runtime_error("allocation limit exceeded");
+#endif // allocation_limit
+	data.resize(size);
+	stream.read(data.data(), size);
+	if (!stream) throw std::runtime_error("unexpected end of stream");
+	return true;
+}
+
 #ifdef allocation_limit
 #undef allocation_limit
 #endif // allocation_limit
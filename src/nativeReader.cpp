@@ -0,0 +1,894 @@
+#include "nativeReader.h"
+#include <assimp/fast_atof.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mappedFile.h"
+#include "plyFormat.h"
+#include "profiler.h"
+
+namespace {
+
+// ========== HELPERS ==========
+
+    // steps that are no-ops or done by the readers themselves, anything else needs assimp
+    const unsigned int handled_steps =
+        aiProcess_Triangulate |
+        aiProcess_JoinIdenticalVertices |
+        aiProcess_SortByPType |
+        aiProcess_RemoveComponent |
+        aiProcess_ValidateDataStructure |
+        aiProcess_FlipUVs |
+        aiProcess_LimitBoneWeights |
+        aiProcess_GenNormals |
+        aiProcess_GenSmoothNormals;
+
+    const size_t min_chunk_size = 1 << 22; // 4 MB per thread
+
+    std::string extensionOf(const std::string& name)
+    {
+        std::string ext = name.substr(name.find_last_of('.') + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext;
+    }
+
+    unsigned int threadCount(const size_t& size)
+    {
+        size_t hw = std::max(1u, std::thread::hardware_concurrency());
+        return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(hw, size / min_chunk_size)));
+    }
+
+    // fn(begin, end) is called on equal parts of [0, count), exceptions are rethrown after all threads finish
+    void parallelFor(const size_t& count, const unsigned int& threads, const std::function<void(size_t, size_t)>& fn)
+    {
+        if (threads <= 1 || count < threads) {
+            fn(0, count);
+            return;
+        }
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors(threads);
+        for (unsigned int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                try {
+                    fn(count * t / threads, count * (t + 1) / threads);
+                }
+                catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& w : workers) w.join();
+        for (std::exception_ptr& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    }
+
+    // splits [begin, end) into at most chunks ranges of whole lines
+    std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end, const unsigned int& chunks)
+    {
+        std::vector<std::pair<const char*, const char*>> ranges;
+        const char* start = begin;
+        for (unsigned int i = 1; i <= chunks && start < end; ++i) {
+            const char* stop = (i == chunks) ? end : begin + (end - begin) * i / chunks;
+            if (stop < start) stop = start;
+            if (stop != end) {
+                const char* nl = static_cast<const char*>(memchr(stop, '\n', end - stop));
+                stop = nl ? nl + 1 : end;
+            }
+            ranges.emplace_back(start, stop);
+            start = stop;
+        }
+        return ranges;
+    }
+
+    // line end points at '\n', unterminated last line is copied so parsers always stop at a readable terminator
+    template <typename F>
+    void forEachLine(const char* begin, const char* end, F fn)
+    {
+        while (begin < end) {
+            const char* nl = static_cast<const char*>(memchr(begin, '\n', end - begin));
+            if (nl == nullptr) {
+                std::string tail(begin, end);
+                fn(tail.c_str(), tail.c_str() + tail.size());
+                return;
+            }
+            fn(begin, nl);
+            begin = nl + 1;
+        }
+    }
+
+    inline const char* skipSpaces(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p;
+    }
+
+    inline const char* skipToken(const char* p, const char* end)
+    {
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+        return p;
+    }
+
+    inline bool isKeyword(const char* p, const char* token_end, const char* keyword)
+    {
+        size_t len = strlen(keyword);
+        return static_cast<size_t>(token_end - p) == len && memcmp(p, keyword, len) == 0;
+    }
+
+    template <typename T>
+    inline const char* parseReal(const char* p, const char* end, T& out)
+    {
+        p = skipSpaces(p, end);
+        if (p >= end) throw std::runtime_error("unexpected end of line");
+        return Assimp::fast_atoreal_move<T>(p, out);
+    }
+
+    aiScene* makeScene(aiMesh* mesh)
+    {
+        aiScene* scene = new aiScene();
+        scene->mNumMeshes = 1;
+        scene->mMeshes = new aiMesh*[1];
+        scene->mMeshes[0] = mesh;
+        scene->mRootNode = new aiNode();
+        scene->mRootNode->mNumMeshes = 1;
+        scene->mRootNode->mMeshes = new unsigned int[1];
+        scene->mRootNode->mMeshes[0] = 0;
+        return scene;
+    }
+
+    void fillFaces(aiMesh* mesh, const std::vector<unsigned int>& triangles, const unsigned int& threads)
+    {
+        mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+        mesh->mNumFaces = static_cast<unsigned int>(triangles.size() / 3);
+        mesh->mFaces = new aiFace[mesh->mNumFaces];
+        parallelFor(mesh->mNumFaces, threads, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                aiFace& face = mesh->mFaces[i];
+                face.mNumIndices = 3;
+                face.mIndices = new unsigned int[3];
+                face.mIndices[0] = triangles[3 * i];
+                face.mIndices[1] = triangles[3 * i + 1];
+                face.mIndices[2] = triangles[3 * i + 2];
+            }
+        });
+    }
+
+    // fan triangulation, same as assimp for convex polygons
+    void triangulate(const unsigned int* indices, const size_t& count, const assimp::importSettings& settings, std::vector<unsigned int>& triangles)
+    {
+        if (count < 3) throw std::runtime_error("points and lines are not supported");
+        if (count > 3 && !(settings.flags & aiProcess_Triangulate)) throw std::runtime_error("polygons need triangulation");
+        for (size_t k = 1; k + 1 < count; ++k) {
+            triangles.push_back(indices[0]);
+            triangles.push_back(indices[k]);
+            triangles.push_back(indices[k + 1]);
+        }
+    }
+
+    void checkGeneratedNormals(const bool& has_normals, const assimp::importSettings& settings)
+    {
+        if (!(settings.flags & (aiProcess_GenNormals | aiProcess_GenSmoothNormals))) return;
+        bool removed = (settings.flags & aiProcess_RemoveComponent) && (settings.removed_components & aiComponent_NORMALS);
+        if (!has_normals || removed) throw std::runtime_error("normals would have to be generated");
+    }
+
+    bool keeps(const assimp::importSettings& settings, const int& component)
+    {
+        return !((settings.flags & aiProcess_RemoveComponent) && (settings.removed_components & component));
+    }
+
+    class meshVertex {
+    public:
+        const aiMesh* mesh;
+        unsigned int index;
+    };
+
+    // -0 and 0 compare equal so they have to hash the same
+    inline void hashFloats(uint64_t& h, const float* values, const int& count)
+    {
+        for (int i = 0; i < count; ++i) {
+            const float f = values[i] + 0.0f;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            h = h * 0x9E3779B97F4A7C15ull ^ bits;
+        }
+    }
+
+    class meshVertexHash {
+    public:
+        size_t operator()(const meshVertex& v) const
+        {
+            uint64_t h = 0;
+            hashFloats(h, &v.mesh->mVertices[v.index].x, 3);
+            if (v.mesh->mNormals) hashFloats(h, &v.mesh->mNormals[v.index].x, 3);
+            if (v.mesh->mTextureCoords[0]) hashFloats(h, &v.mesh->mTextureCoords[0][v.index].x, 3);
+            if (v.mesh->mColors[0]) hashFloats(h, &v.mesh->mColors[0][v.index].r, 4);
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    class meshVertexEqual {
+    public:
+        bool operator()(const meshVertex& a, const meshVertex& b) const
+        {
+            const aiMesh* m = a.mesh;
+            if (m->mVertices[a.index] != m->mVertices[b.index]) return false;
+            if (m->mNormals && m->mNormals[a.index] != m->mNormals[b.index]) return false;
+            if (m->mTextureCoords[0] && m->mTextureCoords[0][a.index] != m->mTextureCoords[0][b.index]) return false;
+            if (m->mColors[0] && m->mColors[0][a.index] != m->mColors[0][b.index]) return false;
+            return true;
+        }
+    };
+
+    template <typename T>
+    void compact(T*& values, const std::vector<unsigned int>& kept)
+    {
+        if (values == nullptr) return;
+        T* compacted = new T[kept.size()];
+        for (size_t i = 0; i < kept.size(); ++i) compacted[i] = values[kept[i]];
+        delete[] values;
+        values = compacted;
+    }
+
+    // join identical vertices done on values like the assimp step: vertices no triangle uses are dropped,
+    // the rest keep their order and merge when every attribute the mesh still has is equal
+    void joinVertices(aiMesh* mesh, std::vector<unsigned int>& triangles)
+    {
+        std::vector<bool> used(mesh->mNumVertices, false);
+        for (const unsigned int& i : triangles) used[i] = true;
+
+        std::unordered_map<meshVertex, unsigned int, meshVertexHash, meshVertexEqual> unique;
+        unique.reserve(mesh->mNumVertices);
+        std::vector<unsigned int> remap(mesh->mNumVertices, 0);
+        std::vector<unsigned int> kept;
+        for (unsigned int v = 0; v < mesh->mNumVertices; ++v) {
+            if (!used[v]) continue;
+            auto found = unique.emplace(meshVertex{ mesh, v }, static_cast<unsigned int>(kept.size()));
+            if (found.second) kept.push_back(v);
+            remap[v] = found.first->second;
+        }
+        if (kept.size() == mesh->mNumVertices) return;
+
+        compact(mesh->mVertices, kept);
+        compact(mesh->mNormals, kept);
+        compact(mesh->mTextureCoords[0], kept);
+        compact(mesh->mColors[0], kept);
+        mesh->mNumVertices = static_cast<unsigned int>(kept.size());
+        for (unsigned int& i : triangles) i = remap[i];
+    }
+
+// ========== OBJ ==========
+
+    class objChunk {
+    public:
+        class relativeIndex {
+        public:
+            size_t slot; // index in corners
+            size_t local_count; // elements of the same kind read before it in this chunk
+        };
+        class objectStart {
+        public:
+            size_t face; // faces read before it in this chunk
+            std::string name;
+        };
+
+        std::vector<float> positions; // x y z
+        std::vector<float> colors; // r g b, only for vertices that have them
+        std::vector<float> texcoords; // u v w
+        std::vector<float> normals; // x y z
+        std::vector<int> corners; // v vt vn, 1 based, 0 if absent, negative if relative
+        std::vector<unsigned int> face_sizes;
+        std::vector<relativeIndex> relative;
+        std::vector<objectStart> objects;
+        unsigned int uv_components = 0;
+        size_t materials = 0;
+
+        void parse(const char* begin, const char* end);
+
+    private:
+        void parseLine(const char* p, const char* end);
+    };
+
+    void objChunk::parse(const char* begin, const char* end)
+    {
+        forEachLine(begin, end, [this](const char* p, const char* e) { parseLine(p, e); });
+    }
+
+    void objChunk::parseLine(const char* p, const char* end)
+    {
+        p = skipSpaces(p, end);
+        if (p >= end || *p == '#') return;
+        const char* token_end = skipToken(p, end);
+
+        if (isKeyword(p, token_end, "v")) {
+            float values[7];
+            int n = 0;
+            p = token_end;
+            while (n < 7 && (p = skipSpaces(p, end)) < end) p = parseReal(p, end, values[n++]);
+            if (n == 3 || n == 6) {
+                positions.insert(positions.end(), values, values + 3);
+                if (n == 6) colors.insert(colors.end(), values + 3, values + 6);
+            }
+            else throw std::runtime_error("vertices with " + std::to_string(n) + " components are not supported");
+        }
+        else if (isKeyword(p, token_end, "vt")) {
+            float uvw[3] = { 0.0f, 0.0f, 0.0f };
+            unsigned int n = 0;
+            p = token_end;
+            while (n < 3 && (p = skipSpaces(p, end)) < end) p = parseReal(p, end, uvw[n++]);
+            if (n == 0) throw std::runtime_error("empty texture coordinate");
+            uv_components = std::max(uv_components, std::max(n, 2u));
+            texcoords.insert(texcoords.end(), uvw, uvw + 3);
+        }
+        else if (isKeyword(p, token_end, "vn")) {
+            float xyz[3];
+            p = token_end;
+            for (int i = 0; i < 3; ++i) p = parseReal(p, end, xyz[i]);
+            normals.insert(normals.end(), xyz, xyz + 3);
+        }
+        else if (isKeyword(p, token_end, "f")) {
+            unsigned int count = 0;
+            p = skipSpaces(token_end, end);
+            while (p < end) {
+                int index[3] = { 0, 0, 0 };
+                index[0] = Assimp::strtol10(p, &p);
+                if (*p == '/') {
+                    ++p;
+                    if (*p != '/') index[1] = Assimp::strtol10(p, &p);
+                    if (*p == '/') {
+                        ++p;
+                        index[2] = Assimp::strtol10(p, &p);
+                    }
+                }
+                if (index[0] == 0) throw std::runtime_error("invalid face index");
+
+                const size_t local_counts[3] = { positions.size() / 3, texcoords.size() / 3, normals.size() / 3 };
+                for (int i = 0; i < 3; ++i) {
+                    if (index[i] < 0) relative.push_back({ corners.size(), local_counts[i] });
+                    corners.push_back(index[i]);
+                }
+                ++count;
+                p = skipSpaces(p, end);
+            }
+            if (count < 3) throw std::runtime_error("points and lines are not supported");
+            face_sizes.push_back(count);
+        }
+        else if (isKeyword(p, token_end, "o") || isKeyword(p, token_end, "g")) {
+            p = skipSpaces(token_end, end);
+            const char* name_end = end;
+            while (name_end > p && (name_end[-1] == ' ' || name_end[-1] == '\t' || name_end[-1] == '\r')) --name_end;
+            objects.push_back({ face_sizes.size(), std::string(p, name_end) });
+        }
+        else if (isKeyword(p, token_end, "usemtl")) {
+            ++materials;
+        }
+        else if (isKeyword(p, token_end, "l") || isKeyword(p, token_end, "p")) {
+            throw std::runtime_error("points and lines are not supported");
+        }
+        // mtllib, s, vp and anything else do not affect the mesh
+    }
+
+    class cornerKey {
+    public:
+        int v, t, n;
+        bool operator==(const cornerKey& other) const { return v == other.v && t == other.t && n == other.n; }
+    };
+
+    class cornerKeyHash {
+    public:
+        size_t operator()(const cornerKey& k) const
+        {
+            uint64_t h = static_cast<uint32_t>(k.v);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(k.t);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(k.n);
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+}
+
+aiScene* native_reader::readObj(const char* data, const size_t& size, const assimp::importSettings& settings)
+{
+    const unsigned int threads = threadCount(size);
+    std::vector<std::pair<const char*, const char*>> ranges = splitLines(data, data + size, threads);
+    std::vector<objChunk> chunks(ranges.size());
+    parallelFor(chunks.size(), static_cast<unsigned int>(chunks.size()), [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) chunks[i].parse(ranges[i].first, ranges[i].second);
+    });
+
+    // one object and one material only, assimp would split anything else into more meshes
+    std::vector<std::pair<size_t, std::string>> object_starts = { { 0, "defaultobject" } };
+    size_t total_faces = 0, materials = 0;
+    unsigned int uv_components = 2;
+    for (const objChunk& c : chunks) {
+        for (const objChunk::objectStart& o : c.objects) object_starts.push_back({ total_faces + o.face, o.name });
+        total_faces += c.face_sizes.size();
+        materials += c.materials;
+        uv_components = std::max(uv_components, c.uv_components);
+    }
+    std::string name;
+    size_t objects_with_faces = 0;
+    for (size_t i = 0; i < object_starts.size(); ++i) {
+        size_t next = i + 1 < object_starts.size() ? object_starts[i + 1].first : total_faces;
+        if (next > object_starts[i].first) {
+            ++objects_with_faces;
+            name = object_starts[i].second;
+        }
+    }
+    if (objects_with_faces > 1) throw std::runtime_error("more than one object");
+    if (objects_with_faces == 0) throw std::runtime_error("no faces");
+    if (materials > 1) throw std::runtime_error("more than one material");
+
+    // global bases of every chunk
+    std::vector<size_t> position_base(chunks.size() + 1, 0), texcoord_base(chunks.size() + 1, 0), normal_base(chunks.size() + 1, 0), corner_base(chunks.size() + 1, 0);
+    size_t colored = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        position_base[i + 1] = position_base[i] + chunks[i].positions.size() / 3;
+        texcoord_base[i + 1] = texcoord_base[i] + chunks[i].texcoords.size() / 3;
+        normal_base[i + 1] = normal_base[i] + chunks[i].normals.size() / 3;
+        corner_base[i + 1] = corner_base[i] + chunks[i].corners.size() / 3;
+        colored += chunks[i].colors.size() / 3;
+    }
+    const size_t counts[3] = { position_base.back(), texcoord_base.back(), normal_base.back() };
+    if (colored != 0 && colored != counts[0]) throw std::runtime_error("only some vertices have colors");
+
+    // resolve corners to 0 based global indices, -1 if absent
+    parallelFor(chunks.size(), static_cast<unsigned int>(chunks.size()), [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; ++c) {
+            objChunk& chunk = chunks[c];
+            for (int& index : chunk.corners) {
+                if (index > 0) index -= 1;
+                else if (index == 0) index = -1;
+            }
+            const size_t* bases[3] = { &position_base[c], &texcoord_base[c], &normal_base[c] };
+            for (const objChunk::relativeIndex& r : chunk.relative) {
+                long long resolved = static_cast<long long>(*bases[r.slot % 3] + r.local_count) + chunk.corners[r.slot];
+                if (resolved < 0) throw std::runtime_error("face index out of range");
+                chunk.corners[r.slot] = static_cast<int>(resolved);
+            }
+            for (size_t i = 0; i < chunk.corners.size(); ++i) {
+                if (chunk.corners[i] >= 0 && static_cast<size_t>(chunk.corners[i]) >= counts[i % 3]) throw std::runtime_error("face index out of range");
+            }
+        }
+    });
+
+    // vertices in order of first use, corners with the same indices are joined here already,
+    // joinVertices then merges the ones whose values match
+    const bool join = (settings.flags & aiProcess_JoinIdenticalVertices) != 0;
+    bool positions_only = true;
+    for (const objChunk& c : chunks) {
+        for (size_t i = 0; i < c.corners.size() && positions_only; i += 3) positions_only = c.corners[i + 1] < 0 && c.corners[i + 2] < 0;
+    }
+    std::vector<int> vertices; // v vt vn per vertex
+    std::vector<unsigned int> corner_vertex(corner_base.back());
+    if (join && positions_only) {
+        std::vector<int> remap(counts[0], -1);
+        size_t k = 0;
+        for (const objChunk& c : chunks) {
+            for (size_t i = 0; i < c.corners.size(); i += 3, ++k) {
+                int& r = remap[c.corners[i]];
+                if (r < 0) {
+                    r = static_cast<int>(vertices.size() / 3);
+                    vertices.insert(vertices.end(), { c.corners[i], -1, -1 });
+                }
+                corner_vertex[k] = static_cast<unsigned int>(r);
+            }
+        }
+    }
+    else if (join) {
+        std::unordered_map<cornerKey, unsigned int, cornerKeyHash> unique;
+        unique.reserve(counts[0]);
+        size_t k = 0;
+        for (const objChunk& c : chunks) {
+            for (size_t i = 0; i < c.corners.size(); i += 3, ++k) {
+                auto found = unique.emplace(cornerKey{ c.corners[i], c.corners[i + 1], c.corners[i + 2] }, static_cast<unsigned int>(vertices.size() / 3));
+                if (found.second) vertices.insert(vertices.end(), c.corners.begin() + i, c.corners.begin() + i + 3);
+                corner_vertex[k] = found.first->second;
+            }
+        }
+    }
+    else {
+        vertices.reserve(corner_vertex.size() * 3);
+        for (const objChunk& c : chunks) vertices.insert(vertices.end(), c.corners.begin(), c.corners.end());
+        for (size_t k = 0; k < corner_vertex.size(); ++k) corner_vertex[k] = static_cast<unsigned int>(k);
+    }
+
+    bool has_texcoords = false, has_normals = false;
+    for (size_t i = 0; i < vertices.size(); i += 3) {
+        has_texcoords = has_texcoords || vertices[i + 1] >= 0;
+        has_normals = has_normals || vertices[i + 2] >= 0;
+    }
+    checkGeneratedNormals(has_normals, settings);
+
+    // triangles
+    std::vector<std::vector<unsigned int>> chunk_triangles(chunks.size());
+    parallelFor(chunks.size(), static_cast<unsigned int>(chunks.size()), [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; ++c) {
+            const unsigned int* corner = corner_vertex.data() + corner_base[c];
+            for (unsigned int face_size : chunks[c].face_sizes) {
+                triangulate(corner, face_size, settings, chunk_triangles[c]);
+                corner += face_size;
+            }
+        }
+    });
+    std::vector<unsigned int> triangles;
+    for (std::vector<unsigned int>& t : chunk_triangles) {
+        triangles.insert(triangles.end(), t.begin(), t.end());
+        std::vector<unsigned int>().swap(t);
+    }
+
+    // flatten per chunk attributes
+    std::vector<float> positions, colors, texcoords, normals;
+    for (objChunk& c : chunks) {
+        positions.insert(positions.end(), c.positions.begin(), c.positions.end());
+        colors.insert(colors.end(), c.colors.begin(), c.colors.end());
+        texcoords.insert(texcoords.end(), c.texcoords.begin(), c.texcoords.end());
+        normals.insert(normals.end(), c.normals.begin(), c.normals.end());
+        c = objChunk();
+    }
+
+    std::unique_ptr<aiMesh> mesh(new aiMesh());
+    mesh->mName.Set(name);
+    mesh->mNumVertices = static_cast<unsigned int>(vertices.size() / 3);
+    mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+    if (has_normals && keeps(settings, aiComponent_NORMALS)) mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+    if (has_texcoords && keeps(settings, aiComponent_TEXCOORDS)) {
+        mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+        mesh->mNumUVComponents[0] = uv_components;
+    }
+    if (colored != 0 && keeps(settings, aiComponent_COLORS)) mesh->mColors[0] = new aiColor4D[mesh->mNumVertices];
+    const bool flip = (settings.flags & aiProcess_FlipUVs) != 0;
+
+    parallelFor(mesh->mNumVertices, threads, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            const int v = vertices[3 * i], t = vertices[3 * i + 1], n = vertices[3 * i + 2];
+            mesh->mVertices[i].Set(positions[3 * v], positions[3 * v + 1], positions[3 * v + 2]);
+            if (mesh->mNormals) {
+                if (n >= 0) mesh->mNormals[i].Set(normals[3 * n], normals[3 * n + 1], normals[3 * n + 2]);
+                else mesh->mNormals[i].Set(0, 0, 0);
+            }
+            if (mesh->mTextureCoords[0]) {
+                if (t >= 0) mesh->mTextureCoords[0][i].Set(texcoords[3 * t], flip ? 1.0f - texcoords[3 * t + 1] : texcoords[3 * t + 1], texcoords[3 * t + 2]);
+                else mesh->mTextureCoords[0][i].Set(0, 0, 0);
+            }
+            if (mesh->mColors[0]) mesh->mColors[0][i] = aiColor4D(colors[3 * v], colors[3 * v + 1], colors[3 * v + 2], 1.0f);
+        }
+    });
+    if (join) joinVertices(mesh.get(), triangles);
+    fillFaces(mesh.get(), triangles, threads);
+
+    return makeScene(mesh.release());
+}
+
+// ========== PLY ==========
+
+namespace {
+
+    class plyBinaryReader {
+    public:
+        const char* p;
+        const char* end;
+        bool swap;
+
+        double read(const ply_format::type& type)
+        {
+            double v = peek(p, type);
+            p += ply_format::typeSize(type);
+            return v;
+        }
+
+        void skip(const size_t& amount)
+        {
+            need(amount);
+            p += amount;
+        }
+
+        void need(const size_t& amount) const
+        {
+            if (static_cast<size_t>(end - p) < amount) throw std::runtime_error("unexpected end of file");
+        }
+
+        // list length, checked against what is left of the file before anything is sized by it
+        size_t readCount(const ply_format::type& count_type, const ply_format::type& value_type)
+        {
+            const double count = read(count_type);
+            const size_t value_size = ply_format::typeSize(value_type);
+            if (!(count >= 0) || count > static_cast<double>(end - p) / value_size) throw std::runtime_error("unexpected end of file");
+            return static_cast<size_t>(count);
+        }
+
+        double peek(const char* at, const ply_format::type& type) const
+        {
+            if (static_cast<size_t>(end - at) < ply_format::typeSize(type)) throw std::runtime_error("unexpected end of file");
+            return ply_format::readValue(at, type, swap);
+        }
+    };
+
+    class plyVertices {
+    public:
+        std::vector<float> positions, normals, texcoords, colors;
+        std::vector<ply_format::slot> slots; // per vertex property
+        bool has[ply_format::none] = {};
+
+        plyVertices(const ply_format::element& element);
+        void store(const size_t& vertex, const size_t& property, const double& value, const ply_format::type& type);
+    };
+
+    plyVertices::plyVertices(const ply_format::element& element)
+    {
+        for (const ply_format::property& p : element.properties) {
+            slots.push_back(p.list ? ply_format::none : ply_format::getSlot(p.name));
+            if (slots.back() != ply_format::none) has[slots.back()] = true;
+        }
+        if (!has[ply_format::x] || !has[ply_format::y] || !has[ply_format::z]) throw std::runtime_error("ply vertices have no positions");
+        positions.resize(element.count * 3);
+        if (has[ply_format::nx] || has[ply_format::ny] || has[ply_format::nz]) normals.resize(element.count * 3);
+        if (has[ply_format::u] || has[ply_format::v]) texcoords.resize(element.count * 2);
+        if (has[ply_format::r] || has[ply_format::g] || has[ply_format::b] || has[ply_format::a]) colors.resize(element.count * 4, 1.0f);
+    }
+
+    inline void plyVertices::store(const size_t& vertex, const size_t& property, const double& value, const ply_format::type& type)
+    {
+        const ply_format::slot slot = slots[property];
+        if (slot <= ply_format::z) positions[3 * vertex + slot - ply_format::x] = static_cast<float>(value);
+        else if (slot <= ply_format::nz) normals[3 * vertex + slot - ply_format::nx] = static_cast<float>(value);
+        else if (slot <= ply_format::v) texcoords[2 * vertex + slot - ply_format::u] = static_cast<float>(value);
+        else if (slot <= ply_format::a) colors[4 * vertex + slot - ply_format::r] = static_cast<float>(value / ply_format::typeMax(type));
+    }
+}
+
+aiScene* native_reader::readPly(const char* data, const size_t& size, const assimp::importSettings& settings)
+{
+    ply_format::header header(data, size);
+    const unsigned int threads = threadCount(size);
+
+    const ply_format::element* vertex_element = nullptr;
+    const ply_format::element* face_element = nullptr;
+    for (const ply_format::element& e : header.elements) {
+        if (e.name == "vertex") vertex_element = &e;
+        else if (e.name == "face") face_element = &e;
+    }
+    if (vertex_element == nullptr) throw std::runtime_error("ply file has no vertices");
+    if (face_element == nullptr || face_element->count == 0) throw std::runtime_error("point clouds are not supported");
+
+    plyVertices vertices(*vertex_element);
+    std::vector<unsigned int> triangles;
+    std::vector<unsigned int> face;
+    const unsigned int vertex_count = static_cast<unsigned int>(vertex_element->count);
+    auto addFace = [&](std::vector<unsigned int>& out) {
+        for (unsigned int i : face) {
+            if (i >= vertex_count) throw std::runtime_error("face index out of range");
+        }
+        triangulate(face.data(), face.size(), settings, out);
+    };
+
+    if (header.format != ply_format::header::encoding::ascii) {
+        plyBinaryReader r{ data + header.body_offset, data + size, header.needsSwap() };
+
+        for (const ply_format::element& element : header.elements) {
+            const size_t stride = element.get_stride();
+            if (&element == vertex_element && stride != 0) {
+                // fixed size vertices are decoded in parallel
+                r.need(stride * element.count);
+                const char* base = r.p;
+                parallelFor(element.count, threads, [&](size_t b, size_t e) {
+                    for (size_t v = b; v < e; ++v) {
+                        const char* q = base + v * stride;
+                        for (size_t i = 0; i < element.properties.size(); ++i) {
+                            const ply_format::type type = element.properties[i].value_type;
+                            vertices.store(v, i, r.peek(q, type), type);
+                            q += ply_format::typeSize(type);
+                        }
+                    }
+                });
+                r.p += stride * element.count;
+            }
+            else if (&element == vertex_element || &element == face_element) {
+                for (size_t item = 0; item < element.count; ++item) {
+                    for (size_t i = 0; i < element.properties.size(); ++i) {
+                        const ply_format::property& prop = element.properties[i];
+                        if (!prop.list) {
+                            if (&element == vertex_element) vertices.store(item, i, r.read(prop.value_type), prop.value_type);
+                            else r.skip(ply_format::typeSize(prop.value_type));
+                            continue;
+                        }
+                        size_t n = r.readCount(prop.count_type, prop.value_type);
+                        if (&element == face_element && prop.isFaceIndices()) {
+                            face.resize(n);
+                            for (size_t j = 0; j < n; ++j) face[j] = static_cast<unsigned int>(r.read(prop.value_type));
+                            addFace(triangles);
+                        }
+                        else r.skip(n * ply_format::typeSize(prop.value_type));
+                    }
+                }
+            }
+            else if (stride != 0) r.skip(stride * element.count);
+            else {
+                for (size_t item = 0; item < element.count; ++item) {
+                    for (const ply_format::property& prop : element.properties) {
+                        if (prop.list) r.skip(r.readCount(prop.count_type, prop.value_type) * ply_format::typeSize(prop.value_type));
+                        else r.skip(ply_format::typeSize(prop.value_type));
+                    }
+                }
+            }
+        }
+    }
+    else {
+        // every element item is one line, lines are counted per chunk first so chunks know which items they hold
+        std::vector<size_t> first_line(header.elements.size() + 1, 0);
+        for (size_t i = 0; i < header.elements.size(); ++i) first_line[i + 1] = first_line[i] + header.elements[i].count;
+
+        std::vector<std::pair<const char*, const char*>> ranges = splitLines(data + header.body_offset, data + size, threads);
+        std::vector<size_t> chunk_lines(ranges.size() + 1, 0);
+        parallelFor(ranges.size(), static_cast<unsigned int>(ranges.size()), [&](size_t b, size_t e) {
+            for (size_t c = b; c < e; ++c) {
+                size_t lines = 0;
+                forEachLine(ranges[c].first, ranges[c].second, [&](const char* p, const char* end) {
+                    if (skipSpaces(p, end) < end) ++lines;
+                });
+                chunk_lines[c + 1] = lines;
+            }
+        });
+        for (size_t c = 0; c < ranges.size(); ++c) chunk_lines[c + 1] += chunk_lines[c];
+        if (chunk_lines.back() < first_line.back()) throw std::runtime_error("unexpected end of file");
+
+        std::vector<std::vector<unsigned int>> chunk_triangles(ranges.size());
+        parallelFor(ranges.size(), static_cast<unsigned int>(ranges.size()), [&](size_t b, size_t e) {
+            std::vector<unsigned int> local_face;
+            std::vector<double> values;
+            for (size_t c = b; c < e; ++c) {
+                size_t line = chunk_lines[c];
+                size_t element = 0;
+                forEachLine(ranges[c].first, ranges[c].second, [&](const char* p, const char* end) {
+                    p = skipSpaces(p, end);
+                    if (p >= end) return;
+                    while (element < header.elements.size() && line >= first_line[element + 1]) ++element;
+                    if (element >= header.elements.size()) return;
+                    const size_t item = line++ - first_line[element];
+
+                    const ply_format::element& el = header.elements[element];
+                    if (&el != vertex_element && &el != face_element) return;
+                    for (size_t i = 0; i < el.properties.size(); ++i) {
+                        const ply_format::property& prop = el.properties[i];
+                        double value;
+                        p = parseReal(p, end, value);
+                        if (!prop.list) {
+                            if (&el == vertex_element) vertices.store(item, i, value, prop.value_type);
+                            continue;
+                        }
+                        // every value takes at least one character of the line
+                        if (!(value >= 0) || value > static_cast<double>(end - p)) throw std::runtime_error("list longer than its line");
+                        size_t n = static_cast<size_t>(value);
+                        values.resize(n);
+                        for (size_t j = 0; j < n; ++j) p = parseReal(p, end, values[j]);
+                        if (&el == face_element && prop.isFaceIndices()) {
+                            for (double index : values) {
+                                if (index < 0 || index >= vertex_count) throw std::runtime_error("face index out of range");
+                            }
+                            local_face.assign(values.begin(), values.end());
+                            triangulate(local_face.data(), local_face.size(), settings, chunk_triangles[c]);
+                        }
+                    }
+                });
+            }
+        });
+        for (std::vector<unsigned int>& t : chunk_triangles) {
+            triangles.insert(triangles.end(), t.begin(), t.end());
+            std::vector<unsigned int>().swap(t);
+        }
+    }
+
+    checkGeneratedNormals(!vertices.normals.empty(), settings);
+
+    std::unique_ptr<aiMesh> mesh(new aiMesh());
+    mesh->mNumVertices = vertex_count;
+    mesh->mVertices = new aiVector3D[vertex_count];
+    if (!vertices.normals.empty() && keeps(settings, aiComponent_NORMALS)) mesh->mNormals = new aiVector3D[vertex_count];
+    if (!vertices.texcoords.empty() && keeps(settings, aiComponent_TEXCOORDS)) {
+        mesh->mTextureCoords[0] = new aiVector3D[vertex_count];
+        mesh->mNumUVComponents[0] = 2;
+    }
+    if (!vertices.colors.empty() && keeps(settings, aiComponent_COLORS)) mesh->mColors[0] = new aiColor4D[vertex_count];
+    const bool flip = (settings.flags & aiProcess_FlipUVs) != 0;
+
+    parallelFor(vertex_count, threads, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            mesh->mVertices[i].Set(vertices.positions[3 * i], vertices.positions[3 * i + 1], vertices.positions[3 * i + 2]);
+            if (mesh->mNormals) mesh->mNormals[i].Set(vertices.normals[3 * i], vertices.normals[3 * i + 1], vertices.normals[3 * i + 2]);
+            if (mesh->mTextureCoords[0]) mesh->mTextureCoords[0][i].Set(vertices.texcoords[2 * i], flip ? 1.0f - vertices.texcoords[2 * i + 1] : vertices.texcoords[2 * i + 1], 0.0f);
+            if (mesh->mColors[0]) mesh->mColors[0][i] = aiColor4D(vertices.colors[4 * i], vertices.colors[4 * i + 1], vertices.colors[4 * i + 2], vertices.colors[4 * i + 3]);
+        }
+    });
+    if (settings.flags & aiProcess_JoinIdenticalVertices) joinVertices(mesh.get(), triangles);
+    fillFaces(mesh.get(), triangles, threads);
+
+    return makeScene(mesh.release());
+}
+
+// ========== ENTRY POINTS ==========
+
+namespace {
+
+    aiScene* readNative(const std::string& ext, const char* data, const size_t& size, const assimp::importSettings& settings)
+    {
+        if (ext == "obj") return native_reader::readObj(data, size, settings);
+        return native_reader::readPly(data, size, settings);
+    }
+
+    bool supportsExtension(const std::string& ext, const assimp::importSettings& settings)
+    {
+        return (ext == "obj" || ext == "ply") && (settings.flags & ~handled_steps) == 0;
+    }
+}
+
+bool native_reader::supports(const std::string& pFile, const assimp::importSettings& settings)
+{
+    return supportsExtension(extensionOf(pFile), settings);
+}
+
+bool native_reader::readFile(const std::string& pFile, std::function<void(const aiScene*)> process_scene, const assimp::importSettings& settings)
+{
+    std::unique_ptr<aiScene> scene(native_reader::importFile(pFile, settings));
+    if (!scene) return false;
+    process_scene(scene.get());
+    return true;
+}
+
+aiScene* native_reader::importFile(const std::string& pFile, const assimp::importSettings& settings)
+{
+    if (!supports(pFile, settings)) return nullptr;
+
+    std::unique_ptr<aiScene> scene;
+    profiler::scope import(profiler::phase::import, "native reader");
+    import.set_source(pFile);
+    const auto start{ std::chrono::steady_clock::now() };
+    try {
+        mapped_file file(pFile);
+        scene.reset(readNative(extensionOf(pFile), file.data(), file.size(), settings));
+    }
+    catch (std::exception& e) {
+        if (settings.report_time) std::cout << "native reader declined " << pFile << ": " << e.what() << "\n";
+        return nullptr;
+    }
+    const auto end{ std::chrono::steady_clock::now() };
+    import.stop();
+    if (settings.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (native reader)\n";
+    }
+    return scene.release();
+}
+
+bool native_reader::readMemory(const void* pBuffer, const size_t& pLength, const std::string& pHint, std::function<void(const aiScene*)> process_scene, const assimp::importSettings& settings)
+{
+    const std::string ext = extensionOf(pHint);
+    if (!supportsExtension(ext, settings)) return false;
+
+    std::unique_ptr<aiScene> scene;
+    profiler::scope import(profiler::phase::import, "native reader");
+    import.set_source(pHint);
+    const auto start{ std::chrono::steady_clock::now() };
+    try {
+        scene.reset(readNative(ext, static_cast<const char*>(pBuffer), pLength, settings));
+    }
+    catch (std::exception& e) {
+        if (settings.report_time) std::cout << "native reader declined memory buffer: " << e.what() << "\n";
+        return false;
+    }
+    const auto end{ std::chrono::steady_clock::now() };
+    import.stop();
+    if (settings.report_time) {
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << "import time: " << elapsed_seconds.count() << " s (native reader, memory buffer)\n";
+    }
+
+    process_scene(scene.get());
+    return true;
+}
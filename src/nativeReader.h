@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <functional>
+
+#include <assimp/scene.h>
+#include "assimpReader.h"
+
+// multithreaded obj and ply readers for big scanned meshes
+// they build the same single triangulated mesh scene assimp would and decline anything else,
+// declined files are expected to be read with assimp instead
+namespace native_reader {
+
+    // extension is handled and every requested post processing step can be honored
+    bool supports(const std::string& pFile, const assimp::importSettings& settings);
+
+    // returns false without calling process_scene if the file was declined
+    bool readFile(const std::string& pFile, std::function<void(const aiScene*)> process_scene, const assimp::importSettings& settings);
+
+    // caller owns returned scene, nullptr if the file was declined
+    aiScene* importFile(const std::string& pFile, const assimp::importSettings& settings);
+
+    // pHint is the file extension of the data in memory
+    bool readMemory(const void* pBuffer, const size_t& pLength, const std::string& pHint, std::function<void(const aiScene*)> process_scene, const assimp::importSettings& settings);
+
+    // throw std::runtime_error with the reason if data can not be read natively
+    aiScene* readObj(const char* data, const size_t& size, const assimp::importSettings& settings);
+    aiScene* readPly(const char* data, const size_t& size, const assimp::importSettings& settings);
+}
@@ -0,0 +1,530 @@
+#include "outputImporter.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include "mappedFile.h"
+
+namespace {
+
+    // vectors hold one element per buffer entry and grow to the biggest buffer that writes them
+    template <typename T>
+    void grow(std::vector<T>& v, const size_t& count, const T& fill = T())
+    {
+        if (v.size() < count) v.resize(count, fill);
+    }
+
+    template <typename T>
+    T& entry(std::vector<T>& v, const size_t& count, const size_t& j, const T& fill = T())
+    {
+        grow(v, count, fill);
+        return v[j];
+    }
+
+    unsigned int suffix(const std::vector<char>& data, const size_t& i)
+    {
+        return i < data.size() ? static_cast<unsigned char>(data[i]) : 0;
+    }
+
+    void fillName(std::string& name, const std::string& prefix, const size_t& i)
+    {
+        if (name.empty()) name = prefix + std::to_string(i);
+    }
+
+    template <typename T>
+    double load(const char* at)
+    {
+        T x;
+        memcpy(&x, at, sizeof(T));
+        return static_cast<double>(x);
+    }
+}
+
+// visit(entry, field, at, nested): nested is set for other_unit fields, at points to stored value otherwise
+template <typename Visitor>
+void output_importer::forEachField(const char* data, const mesh_compiler::compileBuffer& buffer, const mesh_decoder::bufferRecord& br, Visitor visit)
+{
+    std::vector<size_t> sizes;
+    for (const mesh_compiler::compileField& field : buffer.fields) sizes.push_back(field.get_size());
+
+    if (br.entry_offsets.empty()) {
+        for (size_t j = 0; j < br.count; ++j) {
+            const char* at = data + br.offset + j * br.entry_size;
+            for (size_t f = 0; f < buffer.fields.size(); ++f) {
+                visit(j, buffer.fields[f], at, nullptr);
+                at += sizes[f];
+            }
+        }
+        return;
+    }
+
+    size_t unit = 0;
+    for (size_t j = 0; j < br.count; ++j) {
+        const char* at = data + br.entry_offsets[j];
+        for (size_t f = 0; f < buffer.fields.size(); ++f) {
+            if (buffer.fields[f].vtype == mesh_compiler::value::other_unit) {
+                const mesh_decoder::unitRecord& nested = br.units[unit++];
+                visit(j, buffer.fields[f], data + nested.offset, &nested);
+                at = data + nested.offset + nested.size;
+            }
+            else {
+                visit(j, buffer.fields[f], at, nullptr);
+                at += sizes[f];
+            }
+        }
+    }
+}
+
+// ========== IMPORTER ==========
+
+output_importer::output_importer(const std::string& format_file) : decoder(format_file)
+{
+}
+
+aiScene* output_importer::readFile(const std::string& output_file) const
+{
+    const mesh_compiler::compilationInfo& ci = decoder.get_compilation_info();
+    const size_t file_unit = decoder.findFileUnit(output_file);
+    const mesh_compiler::fileUnit& fu = ci.file_units[file_unit];
+    const mesh_decoder::unitRecord record = decoder.decode(output_file, file_unit);
+    mapped_file file(output_file);
+    const char* data = file.data();
+
+    sceneData scene;
+    scene.name = placeholderValue(output_file, fu.output_file, "{scene}");
+    if (scene.name.empty()) {
+        std::string base_filename = output_file.substr(output_file.find_last_of("/\\") + 1);
+        scene.name = base_filename.substr(0, base_filename.find_last_of('.'));
+    }
+
+    switch (fu.count_type)
+    {
+    case mesh_compiler::counting_type::per_scene:
+        readScene(data, fu, record, scene);
+        break;
+    case mesh_compiler::counting_type::per_mesh:
+        scene.meshes.resize(1);
+        readMesh(data, fu, record, scene.meshes[0]);
+        scene.meshes[0].name = placeholderValue(output_file, fu.output_file, "{mesh}");
+        break;
+    case mesh_compiler::counting_type::per_skeleton:
+        scene.skeletons.resize(1);
+        readSkeleton(data, fu, record, scene.skeletons[0]);
+        scene.skeletons[0].name = placeholderValue(output_file, fu.output_file, "{skeleton}");
+        break;
+    case mesh_compiler::counting_type::per_animation:
+        scene.animations.resize(1);
+        readAnimation(data, fu, record, scene.animations[0]);
+        scene.animations[0].name = placeholderValue(output_file, fu.output_file, "{animation}");
+        break;
+    case mesh_compiler::counting_type::per_animation_channel:
+        scene.animations.resize(1);
+        scene.animations[0].channels.resize(1);
+        readChannel(data, fu, record, scene.animations[0].channels[0]);
+        scene.animations[0].name = placeholderValue(output_file, fu.output_file, "{animation}");
+        scene.animations[0].channels[0].name = placeholderValue(output_file, fu.output_file, "{channel}");
+        break;
+    default:
+        throw std::runtime_error("file unit: " + fu.output_file + " does not hold scene objects");
+    }
+
+    for (size_t i = 0; i < scene.meshes.size(); ++i) fillName(scene.meshes[i].name, "mesh_", i);
+    for (size_t i = 0; i < scene.skeletons.size(); ++i) fillName(scene.skeletons[i].name, "skeleton_", i);
+    for (size_t i = 0; i < scene.animations.size(); ++i) {
+        fillName(scene.animations[i].name, "animation_", i);
+        for (size_t j = 0; j < scene.animations[i].channels.size(); ++j) fillName(scene.animations[i].channels[j].name, "channel_", j);
+    }
+    return scene.build();
+}
+
+void output_importer::readFile(const std::string& output_file, std::function<void(const aiScene*)> process_scene) const
+{
+    std::unique_ptr<aiScene> scene(readFile(output_file));
+    process_scene(scene.get());
+}
+
+void output_importer::checkProvides(const mesh_compiler::compilationInfo& target) const
+{
+    std::vector<std::pair<mesh_compiler::value, int>> stored = storedValues(decoder.get_compilation_info());
+    for (const std::pair<mesh_compiler::value, int>& v : storedValues(target)) {
+        if (std::find(stored.begin(), stored.end(), v) != stored.end()) continue;
+        std::string what = mesh_compiler::valueNamesMap[v.first];
+        if (v.second >= 0) what += " " + std::to_string(v.second);
+        throw std::runtime_error("source format does not store " + what + " which target format uses");
+    }
+}
+
+std::string output_importer::placeholderValue(const std::string& filename, const std::string& pattern, const std::string& placeholder)
+{
+    std::string base_filename = filename.substr(filename.find_last_of("/\\") + 1);
+    std::string base_pattern = pattern.substr(pattern.find_last_of("/\\") + 1);
+    size_t found = base_pattern.find(placeholder);
+    if (found == std::string::npos) return "";
+
+    // only literal text around placeholder can be stripped
+    std::string prefix = base_pattern.substr(0, found);
+    std::string suffix = base_pattern.substr(found + placeholder.size());
+    if (prefix.find_first_of("{*?") != std::string::npos || suffix.find_first_of("{*?") != std::string::npos) return "";
+    if (base_filename.size() < prefix.size() + suffix.size()) return "";
+    if (base_filename.compare(0, prefix.size(), prefix) != 0) return "";
+    if (base_filename.compare(base_filename.size() - suffix.size(), suffix.size(), suffix) != 0) return "";
+    return base_filename.substr(prefix.size(), base_filename.size() - prefix.size() - suffix.size());
+}
+
+// ========== DECODED VALUES ==========
+
+double output_importer::readNumber(const char* at, const mesh_compiler::type& type)
+{
+    switch (type)
+    {
+    case mesh_compiler::mc_char: return load<char>(at);
+    case mesh_compiler::mc_short: return load<short>(at);
+    case mesh_compiler::mc_unsigned_short: return load<unsigned short>(at);
+    case mesh_compiler::mc_int: return load<int>(at);
+    case mesh_compiler::mc_unsigned_int: return load<unsigned int>(at);
+    case mesh_compiler::mc_long: return load<long>(at);
+    case mesh_compiler::mc_unsigned_long: return load<unsigned long>(at);
+    case mesh_compiler::mc_long_long: return load<long long>(at);
+    case mesh_compiler::mc_unsigned_long_long: return load<unsigned long long>(at);
+    case mesh_compiler::mc_float: return load<float>(at);
+    case mesh_compiler::mc_double: return load<double>(at);
+    case mesh_compiler::mc_long_double: return load<long double>(at);
+    default:
+        throw std::logic_error("unknown type");
+    }
+}
+
+// uv and vertex color keep their channel, bone influences need both ids and weights to be rebuilt
+std::vector<std::pair<mesh_compiler::value, int>> output_importer::storedValues(const mesh_compiler::compilationInfo& ci)
+{
+    std::vector<std::pair<mesh_compiler::value, int>> out;
+    auto collect = [&](const mesh_compiler::compileUnit& unit) {
+        for (const mesh_compiler::compileBuffer& buffer : unit.buffers) {
+            for (const mesh_compiler::compileField& field : buffer.fields) {
+                if (field.vtype == mesh_compiler::value::constant || field.vtype == mesh_compiler::value::other_unit) continue;
+                int channel = -1;
+                if (field.vtype == mesh_compiler::value::uv || field.vtype == mesh_compiler::value::vertex_color) channel = suffix(field.data, 0);
+                std::pair<mesh_compiler::value, int> v(field.vtype, channel);
+                if (std::find(out.begin(), out.end(), v) == out.end()) out.push_back(v);
+            }
+        }
+    };
+    for (const auto& unit : ci.units) collect(unit.second);
+    for (const mesh_compiler::fileUnit& fu : ci.file_units) collect(fu);
+
+    std::pair<mesh_compiler::value, int> ids(mesh_compiler::value::bone_id, -1), weights(mesh_compiler::value::bone_weight, -1);
+    bool has_ids = std::find(out.begin(), out.end(), ids) != out.end();
+    bool has_weights = std::find(out.begin(), out.end(), weights) != out.end();
+    if (has_ids != has_weights) {
+        out.erase(std::remove(out.begin(), out.end(), ids), out.end());
+        out.erase(std::remove(out.begin(), out.end(), weights), out.end());
+    }
+    return out;
+}
+
+const mesh_compiler::compileUnit& output_importer::nestedUnit(const mesh_decoder::unitRecord& record) const
+{
+    return decoder.get_compilation_info().units.at(record.name);
+}
+
+// nested units in preambles describe the same object as the unit they are in
+
+void output_importer::readMesh(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, meshData& mesh) const
+{
+    for (const mesh_decoder::unitRecord& nested : record.preamble_units) readMesh(data, nestedUnit(nested), nested, mesh);
+
+    static const std::array<int, MAX_BONE_INFLUENCE> no_ids = [] { std::array<int, MAX_BONE_INFLUENCE> a; a.fill(-1); return a; }();
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        const mesh_compiler::compileBuffer& buffer = unit.buffers[i];
+        const size_t count = record.buffers[i].count;
+        if (buffer.count_type == mesh_compiler::counting_type::per_vertex) mesh.vertex_count = std::max(mesh.vertex_count, count);
+        else if (buffer.count_type == mesh_compiler::counting_type::per_indice) mesh.face_count = std::max(mesh.face_count, count);
+        else if (buffer.count_type == mesh_compiler::counting_type::per_mesh_bone) mesh.bone_count = std::max(mesh.bone_count, count);
+
+        forEachField(data, buffer, record.buffers[i], [&](const size_t& j, const mesh_compiler::compileField& field, const char* at, const mesh_decoder::unitRecord*) {
+            const unsigned int a = suffix(field.data, 0);
+            const unsigned int b = suffix(field.data, 1);
+            switch (field.vtype)
+            {
+            case mesh_compiler::value::indice:
+                entry(mesh.faces, count, j)[a] = static_cast<unsigned int>(readNumber(at, field.stype));
+                mesh.corners = std::max(mesh.corners, a + 1);
+                break;
+            case mesh_compiler::value::vertex:
+                entry(mesh.positions, count, j)[a] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::normal:
+                entry(mesh.normals, count, j)[a] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::tangent:
+                entry(mesh.tangents, count, j)[a] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::bitangent:
+                entry(mesh.bitangents, count, j)[a] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::uv:
+                entry(mesh.uvs[a], count, j)[b] = static_cast<ai_real>(readNumber(at, field.stype));
+                mesh.uv_components[a] = std::max(mesh.uv_components[a], b + 1);
+                break;
+            case mesh_compiler::value::vertex_color:
+                entry(mesh.colors[a], count, j, aiColor4D(0, 0, 0, 1))[b] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::bone_id:
+                entry(mesh.bone_ids, count, j, no_ids)[a] = static_cast<int>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::bone_weight:
+                entry(mesh.bone_weights, count, j)[a] = static_cast<float>(readNumber(at, field.stype));
+                break;
+            default:
+                break;
+            }
+        });
+    }
+}
+
+void output_importer::readSkeleton(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, skeletonData& skeleton) const
+{
+    for (const mesh_decoder::unitRecord& nested : record.preamble_units) readSkeleton(data, nestedUnit(nested), nested, skeleton);
+
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        const size_t count = record.buffers[i].count;
+        grow(skeleton.bones, count);
+        forEachField(data, unit.buffers[i], record.buffers[i], [&](const size_t& j, const mesh_compiler::compileField& field, const char* at, const mesh_decoder::unitRecord*) {
+            if (field.vtype != mesh_compiler::value::offset_matrix) return;
+            skeleton.bones[j][suffix(field.data, 0)][suffix(field.data, 1)] = static_cast<ai_real>(readNumber(at, field.stype));
+        });
+    }
+}
+
+void output_importer::readChannel(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, channelData& channel) const
+{
+    for (const mesh_decoder::unitRecord& nested : record.preamble_units) readChannel(data, nestedUnit(nested), nested, channel);
+
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        const mesh_compiler::compileBuffer& buffer = unit.buffers[i];
+        const size_t count = record.buffers[i].count;
+        if (buffer.count_type == mesh_compiler::counting_type::per_position_keyframe) grow(channel.positions, count);
+        else if (buffer.count_type == mesh_compiler::counting_type::per_rotation_keyframe) grow(channel.rotations, count);
+        else if (buffer.count_type == mesh_compiler::counting_type::per_scale_keyframe) grow(channel.scalings, count);
+
+        forEachField(data, buffer, record.buffers[i], [&](const size_t& j, const mesh_compiler::compileField& field, const char* at, const mesh_decoder::unitRecord*) {
+            const unsigned int a = suffix(field.data, 0);
+            switch (field.vtype)
+            {
+            case mesh_compiler::value::position_key:
+                channel.positions[j].mValue[a] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::rotation_key: {
+                aiQuaternion& q = channel.rotations[j].mValue;
+                ai_real v = static_cast<ai_real>(readNumber(at, field.stype));
+                if (a == 0) q.x = v;
+                else if (a == 1) q.y = v;
+                else if (a == 2) q.z = v;
+                else q.w = v;
+                break;
+            }
+            case mesh_compiler::value::scale_key:
+                channel.scalings[j].mValue[a] = static_cast<ai_real>(readNumber(at, field.stype));
+                break;
+            case mesh_compiler::value::position_key_timestamp:
+                channel.positions[j].mTime = readNumber(at, field.stype);
+                break;
+            case mesh_compiler::value::rotation_key_timestamp:
+                channel.rotations[j].mTime = readNumber(at, field.stype);
+                break;
+            case mesh_compiler::value::scale_key_timestamp:
+                channel.scalings[j].mTime = readNumber(at, field.stype);
+                break;
+            default:
+                break;
+            }
+        });
+    }
+}
+
+void output_importer::readAnimation(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, animationData& animation) const
+{
+    for (const mesh_decoder::unitRecord& nested : record.preamble_units) readAnimation(data, nestedUnit(nested), nested, animation);
+
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        const size_t count = record.buffers[i].count;
+        grow(animation.channels, count);
+        forEachField(data, unit.buffers[i], record.buffers[i], [&](const size_t& j, const mesh_compiler::compileField& field, const char* at, const mesh_decoder::unitRecord* nested) {
+            if (nested != nullptr) readChannel(data, nestedUnit(*nested), *nested, animation.channels[j]);
+            else if (field.vtype == mesh_compiler::value::duration) animation.duration = readNumber(at, field.stype);
+            else if (field.vtype == mesh_compiler::value::ticks_per_second) animation.ticks_per_second = readNumber(at, field.stype);
+        });
+    }
+}
+
+void output_importer::readScene(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, sceneData& scene) const
+{
+    for (const mesh_decoder::unitRecord& nested : record.preamble_units) readScene(data, nestedUnit(nested), nested, scene);
+
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        const mesh_compiler::compileBuffer& buffer = unit.buffers[i];
+        const size_t count = record.buffers[i].count;
+        forEachField(data, buffer, record.buffers[i], [&](const size_t& j, const mesh_compiler::compileField&, const char*, const mesh_decoder::unitRecord* nested) {
+            if (nested == nullptr) return;
+            const mesh_compiler::compileUnit& object = nestedUnit(*nested);
+            switch (buffer.count_type)
+            {
+            case mesh_compiler::counting_type::per_mesh:
+                readMesh(data, object, *nested, entry(scene.meshes, count, j));
+                break;
+            case mesh_compiler::counting_type::per_skeleton:
+                readSkeleton(data, object, *nested, entry(scene.skeletons, count, j));
+                break;
+            case mesh_compiler::counting_type::per_animation:
+                readAnimation(data, object, *nested, entry(scene.animations, count, j));
+                break;
+            default:
+                break;
+            }
+        });
+    }
+}
+
+// ========== SCENE BUILDING ==========
+
+aiMesh* output_importer::meshData::build() const
+{
+    std::unique_ptr<aiMesh> mesh(new aiMesh());
+    mesh->mName = aiString(name);
+    mesh->mNumVertices = static_cast<unsigned int>(vertex_count);
+
+    auto copy = [&](const std::vector<aiVector3D>& src) -> aiVector3D* {
+        if (src.empty()) return nullptr;
+        aiVector3D* dst = new aiVector3D[vertex_count];
+        std::copy(src.begin(), src.begin() + std::min(src.size(), vertex_count), dst);
+        return dst;
+    };
+    mesh->mVertices = copy(positions);
+    mesh->mNormals = copy(normals);
+    mesh->mTangents = copy(tangents);
+    mesh->mBitangents = copy(bitangents);
+    for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+        mesh->mTextureCoords[c] = copy(uvs[c]);
+        if (mesh->mTextureCoords[c] != nullptr) mesh->mNumUVComponents[c] = uv_components[c];
+    }
+    for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+        if (colors[c].empty()) continue;
+        mesh->mColors[c] = new aiColor4D[vertex_count];
+        std::fill(mesh->mColors[c], mesh->mColors[c] + vertex_count, aiColor4D(0, 0, 0, 1));
+        std::copy(colors[c].begin(), colors[c].begin() + std::min(colors[c].size(), vertex_count), mesh->mColors[c]);
+    }
+
+    // faces
+    if (corners != 0) {
+        mesh->mPrimitiveTypes = corners == 1 ? aiPrimitiveType_POINT : corners == 2 ? aiPrimitiveType_LINE : aiPrimitiveType_TRIANGLE;
+        mesh->mFaces = new aiFace[face_count];
+        mesh->mNumFaces = static_cast<unsigned int>(face_count);
+        for (size_t i = 0; i < face_count; ++i) {
+            aiFace& face = mesh->mFaces[i];
+            face.mNumIndices = corners;
+            face.mIndices = new unsigned int[corners]();
+            if (i < faces.size()) std::copy(faces[i].begin(), faces[i].begin() + corners, face.mIndices);
+        }
+    }
+
+    // bones, offset matrices and names are not stored in mesh units,
+    // ids come from the file so they are held to the declared bone count, or without one to one bone per influence
+    const size_t max_bones = bone_count != 0 ? bone_count : bone_ids.size() * MAX_BONE_INFLUENCE;
+    std::vector<std::vector<aiVertexWeight>> weights;
+    for (size_t v = 0; v < std::min(bone_ids.size(), bone_weights.size()); ++v) {
+        for (unsigned int s = 0; s < MAX_BONE_INFLUENCE; ++s) {
+            int id = bone_ids[v][s];
+            float weight = bone_weights[v][s];
+            if (id < 0 || weight <= 0.0f) continue;
+            if (static_cast<size_t>(id) >= max_bones) throw std::runtime_error("bone id out of range: " + std::to_string(id));
+            if (static_cast<size_t>(id) >= weights.size()) weights.resize(id + 1);
+            weights[id].push_back(aiVertexWeight(static_cast<unsigned int>(v), weight));
+        }
+    }
+    size_t bones = std::max(bone_count, weights.size());
+    if (bones != 0) {
+        mesh->mBones = new aiBone*[bones];
+        for (size_t b = 0; b < bones; ++b) {
+            aiBone* bone = new aiBone();
+            mesh->mBones[b] = bone;
+            mesh->mNumBones = static_cast<unsigned int>(b + 1);
+            bone->mName = aiString("bone_" + std::to_string(b));
+            if (b >= weights.size() || weights[b].empty()) continue;
+            bone->mNumWeights = static_cast<unsigned int>(weights[b].size());
+            bone->mWeights = new aiVertexWeight[bone->mNumWeights];
+            std::copy(weights[b].begin(), weights[b].end(), bone->mWeights);
+        }
+    }
+    return mesh.release();
+}
+
+aiSkeleton* output_importer::skeletonData::build() const
+{
+    aiSkeleton* skeleton = new aiSkeleton();
+    skeleton->mName = aiString(name);
+    skeleton->mNumBones = static_cast<unsigned int>(bones.size());
+    skeleton->mBones = new aiSkeletonBone*[bones.size()];
+    for (size_t i = 0; i < bones.size(); ++i) {
+        skeleton->mBones[i] = new aiSkeletonBone();
+        skeleton->mBones[i]->mOffsetMatrix = bones[i];
+    }
+    return skeleton;
+}
+
+aiNodeAnim* output_importer::channelData::build() const
+{
+    aiNodeAnim* channel = new aiNodeAnim();
+    channel->mNodeName = aiString(name);
+    channel->mNumPositionKeys = static_cast<unsigned int>(positions.size());
+    channel->mPositionKeys = new aiVectorKey[positions.size()];
+    std::copy(positions.begin(), positions.end(), channel->mPositionKeys);
+    channel->mNumRotationKeys = static_cast<unsigned int>(rotations.size());
+    channel->mRotationKeys = new aiQuatKey[rotations.size()];
+    std::copy(rotations.begin(), rotations.end(), channel->mRotationKeys);
+    channel->mNumScalingKeys = static_cast<unsigned int>(scalings.size());
+    channel->mScalingKeys = new aiVectorKey[scalings.size()];
+    std::copy(scalings.begin(), scalings.end(), channel->mScalingKeys);
+    return channel;
+}
+
+aiAnimation* output_importer::animationData::build() const
+{
+    std::unique_ptr<aiAnimation> animation(new aiAnimation());
+    animation->mName = aiString(name);
+    animation->mDuration = duration;
+    animation->mTicksPerSecond = ticks_per_second;
+    animation->mChannels = new aiNodeAnim*[channels.size()];
+    for (size_t i = 0; i < channels.size(); ++i) {
+        animation->mChannels[i] = channels[i].build();
+        animation->mNumChannels = static_cast<unsigned int>(i + 1);
+    }
+    return animation.release();
+}
+
+aiScene* output_importer::sceneData::build() const
+{
+    std::unique_ptr<aiScene> scene(new aiScene());
+    scene->mName = aiString(name);
+
+    scene->mMeshes = new aiMesh*[meshes.size()];
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        scene->mMeshes[i] = meshes[i].build();
+        scene->mNumMeshes = static_cast<unsigned int>(i + 1);
+    }
+    scene->mSkeletons = new aiSkeleton*[skeletons.size()];
+    for (size_t i = 0; i < skeletons.size(); ++i) {
+        scene->mSkeletons[i] = skeletons[i].build();
+        scene->mNumSkeletons = static_cast<unsigned int>(i + 1);
+    }
+    scene->mAnimations = new aiAnimation*[animations.size()];
+    for (size_t i = 0; i < animations.size(); ++i) {
+        scene->mAnimations[i] = animations[i].build();
+        scene->mNumAnimations = static_cast<unsigned int>(i + 1);
+    }
+
+    // flat hierarchy, every mesh hangs from root
+    scene->mRootNode = new aiNode(name);
+    scene->mRootNode->mNumMeshes = scene->mNumMeshes;
+    scene->mRootNode->mMeshes = new unsigned int[scene->mNumMeshes];
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) scene->mRootNode->mMeshes[i] = i;
+    return scene.release();
+}
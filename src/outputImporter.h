@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <functional>
+
+#include <assimp/scene.h>
+#include "meshDecoder.h"
+
+// rebuilds aiScene from files produced by mesh_compiler using the same format file they were compiled with,
+// only values stored by that format come back, names are recovered from output file name placeholders
+// when possible and generated otherwise, node hierarchy and materials are not stored so they are not rebuilt
+class output_importer {
+public:
+    output_importer(const std::string& format_file);
+
+    // caller owns returned scene
+    aiScene* readFile(const std::string& output_file) const;
+    void readFile(const std::string& output_file, std::function<void(const aiScene*)> process_scene) const;
+
+    // throws std::runtime_error if target uses values this format does not store
+    void checkProvides(const mesh_compiler::compilationInfo& target) const;
+
+    // text that replaced placeholder in pattern to produce filename, empty if it can not be told
+    static std::string placeholderValue(const std::string& filename, const std::string& pattern, const std::string& placeholder);
+
+private:
+    mesh_decoder decoder;
+
+    class meshData {
+    public:
+        std::string name;
+        size_t vertex_count = 0;
+        size_t face_count = 0;
+        size_t bone_count = 0;
+        unsigned int corners = 0;
+        std::vector<aiVector3D> positions;
+        std::vector<aiVector3D> normals;
+        std::vector<aiVector3D> tangents;
+        std::vector<aiVector3D> bitangents;
+        std::array<std::vector<aiVector3D>, AI_MAX_NUMBER_OF_TEXTURECOORDS> uvs;
+        std::array<unsigned int, AI_MAX_NUMBER_OF_TEXTURECOORDS> uv_components = {};
+        std::array<std::vector<aiColor4D>, AI_MAX_NUMBER_OF_COLOR_SETS> colors;
+        std::vector<std::array<unsigned int, 3>> faces;
+        std::vector<std::array<int, MAX_BONE_INFLUENCE>> bone_ids;
+        std::vector<std::array<float, MAX_BONE_INFLUENCE>> bone_weights;
+
+        aiMesh* build() const;
+    };
+
+    class skeletonData {
+    public:
+        std::string name;
+        std::vector<aiMatrix4x4> bones;
+
+        aiSkeleton* build() const;
+    };
+
+    class channelData {
+    public:
+        std::string name;
+        std::vector<aiVectorKey> positions;
+        std::vector<aiQuatKey> rotations;
+        std::vector<aiVectorKey> scalings;
+
+        aiNodeAnim* build() const;
+    };
+
+    class animationData {
+    public:
+        std::string name;
+        double duration = 0.0;
+        double ticks_per_second = 0.0;
+        std::vector<channelData> channels;
+
+        aiAnimation* build() const;
+    };
+
+    class sceneData {
+    public:
+        std::string name;
+        std::vector<meshData> meshes;
+        std::vector<skeletonData> skeletons;
+        std::vector<animationData> animations;
+
+        aiScene* build() const;
+    };
+
+    static double readNumber(const char* at, const mesh_compiler::type& type);
+    template <typename Visitor>
+    static void forEachField(const char* data, const mesh_compiler::compileBuffer& buffer, const mesh_decoder::bufferRecord& br, Visitor visit);
+    static std::vector<std::pair<mesh_compiler::value, int>> storedValues(const mesh_compiler::compilationInfo& ci);
+
+    const mesh_compiler::compileUnit& nestedUnit(const mesh_decoder::unitRecord& record) const;
+    void readMesh(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, meshData& mesh) const;
+    void readSkeleton(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, skeletonData& skeleton) const;
+    void readChannel(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, channelData& channel) const;
+    void readAnimation(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, animationData& animation) const;
+    void readScene(const char* data, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& record, sceneData& scene) const;
+};
@@ -0,0 +1,143 @@
+#include "perfCounters.h"
+#include <atomic>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace {
+
+    std::atomic<bool> counting{ false };
+
+#ifdef __linux__
+    // one group per thread so all counters cover the same instructions, cycles leads the group
+    class threadCounters {
+    public:
+        int fds[perf_counters::counter_count] = { -1, -1, -1, -1 };
+        bool opened = false;
+        int error = 0;
+
+        threadCounters()
+        {
+            static const unsigned long long configs[perf_counters::counter_count] = {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+            for (int c = 0; c < perf_counters::counter_count; ++c) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[c];
+                attr.disabled = c == 0 ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                fds[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, c == 0 ? -1 : fds[0], 0));
+                if (fds[c] < 0) {
+                    error = errno;
+                    return;
+                }
+            }
+            if (ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0) {
+                error = errno;
+                return;
+            }
+            opened = true;
+        }
+
+        ~threadCounters()
+        {
+            for (const int& fd : fds) {
+                if (fd >= 0) close(fd);
+            }
+        }
+
+        bool read(perf_counters::values& out) const
+        {
+            if (!opened) return false;
+            uint64_t data[1 + perf_counters::counter_count];
+            if (::read(fds[0], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[0] != perf_counters::counter_count) return false;
+            for (int c = 0; c < perf_counters::counter_count; ++c) out.v[c] = data[1 + c];
+            return true;
+        }
+    };
+
+    threadCounters& localCounters()
+    {
+        thread_local threadCounters local;
+        return local;
+    }
+#endif
+}
+
+perf_counters::values& perf_counters::values::operator+=(const values& other)
+{
+    for (int c = 0; c < counter_count; ++c) v[c] += other.v[c];
+    return *this;
+}
+
+perf_counters::values perf_counters::values::operator-(const values& other) const
+{
+    values difference;
+    for (int c = 0; c < counter_count; ++c) difference.v[c] = v[c] - other.v[c];
+    return difference;
+}
+
+bool perf_counters::values::empty() const
+{
+    for (int c = 0; c < counter_count; ++c) {
+        if (v[c] != 0) return false;
+    }
+    return true;
+}
+
+bool perf_counters::enable(std::string& reason)
+{
+#ifdef __linux__
+    const threadCounters& local = localCounters();
+    if (!local.opened) {
+        reason = std::strerror(local.error);
+        if (local.error == EACCES || local.error == EPERM) reason += ", see /proc/sys/kernel/perf_event_paranoid";
+        return false;
+    }
+    counting = true;
+    return true;
+#else
+    reason = "only available on linux";
+    return false;
+#endif
+}
+
+bool perf_counters::enabled()
+{
+    return counting.load(std::memory_order_relaxed);
+}
+
+bool perf_counters::read(values& out)
+{
+    if (!enabled()) return false;
+#ifdef __linux__
+    return localCounters().read(out);
+#else
+    return false;
+#endif
+}
+
+const char* perf_counters::name(const counter& c)
+{
+    switch (c) {
+    case cycles: return "cycles";
+    case instructions: return "instructions";
+    case cache_misses: return "cache misses";
+    case branch_misses: return "branch misses";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+// hardware counters of the calling thread through linux perf_event_open, user space only,
+// off until enable() succeeds, each thread opens its own counters on first read
+class perf_counters {
+public:
+    enum counter {
+        cycles,
+        instructions,
+        cache_misses,
+        branch_misses,
+        counter_count
+    };
+
+    class values {
+    public:
+        unsigned long long v[counter_count] = {};
+
+        values& operator+=(const values& other);
+        values operator-(const values& other) const;
+        bool empty() const;
+    };
+
+    perf_counters() = delete;
+
+    // false with the reason when counters can not be opened: other systems, containers, perf_event_paranoid
+    static bool enable(std::string& reason);
+    static bool enabled();
+
+    static bool read(values& out); // false if disabled or this thread could not open its counters
+    static const char* name(const counter& c);
+};
@@ -0,0 +1,241 @@
+#include "plyFormat.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+    const std::unordered_map<std::string, ply_format::type> typesMap = {
+        {"char", ply_format::type::int8}, {"int8", ply_format::type::int8},
+        {"uchar", ply_format::type::uint8}, {"uint8", ply_format::type::uint8},
+        {"short", ply_format::type::int16}, {"int16", ply_format::type::int16},
+        {"ushort", ply_format::type::uint16}, {"uint16", ply_format::type::uint16},
+        {"int", ply_format::type::int32}, {"int32", ply_format::type::int32},
+        {"uint", ply_format::type::uint32}, {"uint32", ply_format::type::uint32},
+        {"float", ply_format::type::float32}, {"float32", ply_format::type::float32},
+        {"double", ply_format::type::float64}, {"float64", ply_format::type::float64}
+    };
+
+    const std::unordered_map<std::string, ply_format::slot> slotsMap = {
+        {"x", ply_format::x}, {"y", ply_format::y}, {"z", ply_format::z},
+        {"nx", ply_format::nx}, {"ny", ply_format::ny}, {"nz", ply_format::nz},
+        {"u", ply_format::u}, {"s", ply_format::u}, {"texture_u", ply_format::u}, {"texture_s", ply_format::u},
+        {"v", ply_format::v}, {"t", ply_format::v}, {"texture_v", ply_format::v}, {"texture_t", ply_format::v},
+        {"red", ply_format::r}, {"r", ply_format::r}, {"diffuse_red", ply_format::r},
+        {"green", ply_format::g}, {"g", ply_format::g}, {"diffuse_green", ply_format::g},
+        {"blue", ply_format::b}, {"b", ply_format::b}, {"diffuse_blue", ply_format::b},
+        {"alpha", ply_format::a}, {"a", ply_format::a}
+    };
+
+    ply_format::type parseType(const std::string& name)
+    {
+        auto found = typesMap.find(name);
+        if (found == typesMap.end()) throw std::runtime_error("unknown ply type: " + name);
+        return found->second;
+    }
+}
+
+bool ply_format::property::isFaceIndices() const
+{
+    return list && (name == "vertex_indices" || name == "vertex_index");
+}
+
+size_t ply_format::element::get_stride() const
+{
+    size_t stride = 0;
+    for (const property& p : properties) {
+        if (p.list) return 0;
+        stride += typeSize(p.value_type);
+    }
+    return stride;
+}
+
+ply_format::header::header(const char* data, const size_t& size)
+{
+    const char* p = data;
+    const char* end = data + size;
+    bool first = true;
+    while (true) {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (nl == nullptr) throw std::runtime_error("unterminated ply header");
+        std::istringstream line(std::string(p, nl));
+        p = nl + 1;
+
+        std::string keyword;
+        line >> keyword;
+        if (first) {
+            if (keyword != "ply") throw std::runtime_error("missing ply magic");
+            first = false;
+        }
+        else if (keyword == "format") {
+            std::string f;
+            line >> f;
+            if (f == "ascii") format = encoding::ascii;
+            else if (f == "binary_little_endian") format = encoding::binary_little_endian;
+            else if (f == "binary_big_endian") format = encoding::binary_big_endian;
+            else throw std::runtime_error("unknown ply format: " + f);
+        }
+        else if (keyword == "element") {
+            elements.push_back(element());
+            line >> elements.back().name >> elements.back().count;
+        }
+        else if (keyword == "property") {
+            if (elements.empty()) throw std::runtime_error("ply property outside of element");
+            property prop;
+            std::string t;
+            line >> t;
+            if (t == "list") {
+                std::string count_type;
+                line >> count_type >> t;
+                prop.list = true;
+                prop.count_type = parseType(count_type);
+            }
+            prop.value_type = parseType(t);
+            line >> prop.name;
+            elements.back().properties.push_back(prop);
+        }
+        else if (keyword == "end_header") break;
+        // comment, obj_info
+    }
+    body_offset = p - data;
+}
+
+const ply_format::element* ply_format::header::find(const std::string& name) const
+{
+    for (const element& e : elements) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+bool ply_format::header::needsSwap() const
+{
+    const uint16_t probe = 1;
+    const bool little_endian_host = *reinterpret_cast<const unsigned char*>(&probe) == 1;
+    return format != encoding::ascii && little_endian_host != (format == encoding::binary_little_endian);
+}
+
+ply_format::chunkReader::chunkReader(const std::string& filename, const size_t& buffer_size) :
+    file(filename, std::ios::in | std::ios::binary), hdr(loadHeader(file)), buffer(std::max<size_t>(buffer_size, 1))
+{
+    if (hdr.format == header::encoding::ascii) throw std::runtime_error("ply file: " + filename + " is not binary");
+}
+
+ply_format::header ply_format::chunkReader::loadHeader(std::ifstream& file)
+{
+    if (!file) throw std::runtime_error("could not open file");
+    std::string text;
+    std::string line;
+    while (std::getline(file, line)) {
+        text += line + '\n';
+        if (line == "end_header" || line == "end_header\r") return header(text.data(), text.size());
+        if (text.size() > (1 << 20)) break;
+    }
+    throw std::runtime_error("unterminated ply header");
+}
+
+const ply_format::header& ply_format::chunkReader::get_header() const
+{
+    return hdr;
+}
+
+void ply_format::chunkReader::seekElement(const std::string& name)
+{
+    seek(hdr.body_offset);
+    const bool swap = hdr.needsSwap();
+    for (const element& e : hdr.elements) {
+        if (e.name == name) return;
+        const size_t stride = e.get_stride();
+        if (stride != 0) {
+            seek(buffer_offset + begin + stride * e.count);
+            continue;
+        }
+        // list elements have to be walked
+        for (size_t item = 0; item < e.count; ++item) {
+            for (const property& p : e.properties) {
+                size_t n = 1;
+                if (p.list) n = static_cast<size_t>(readValue(need(typeSize(p.count_type)), p.count_type, swap));
+                need(n * typeSize(p.value_type));
+            }
+        }
+    }
+    throw std::runtime_error("ply file has no element: " + name);
+}
+
+const char* ply_format::chunkReader::need(const size_t& amount)
+{
+    if (end - begin < amount) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        buffer_offset += begin;
+        end -= begin;
+        begin = 0;
+        if (buffer.size() < amount) throw std::runtime_error("ply data larger than memory limit: " + std::to_string(amount) + " bytes");
+        file.read(buffer.data() + end, buffer.size() - end);
+        end += static_cast<size_t>(file.gcount());
+        if (end < amount) throw std::runtime_error("unexpected end of file");
+    }
+    const char* p = buffer.data() + begin;
+    begin += amount;
+    return p;
+}
+
+void ply_format::chunkReader::seek(const size_t& offset)
+{
+    file.clear();
+    file.seekg(offset);
+    buffer_offset = offset;
+    begin = end = 0;
+}
+
+size_t ply_format::typeSize(const type& t)
+{
+    switch (t)
+    {
+    case type::int8: case type::uint8: return 1;
+    case type::int16: case type::uint16: return 2;
+    case type::int32: case type::uint32: case type::float32: return 4;
+    default: return 8;
+    }
+}
+
+double ply_format::typeMax(const type& t)
+{
+    switch (t)
+    {
+    case type::int8: return 127.0;
+    case type::uint8: return 255.0;
+    case type::int16: return 32767.0;
+    case type::uint16: return 65535.0;
+    case type::int32: return 2147483647.0;
+    case type::uint32: return 4294967295.0;
+    default: return 1.0;
+    }
+}
+
+ply_format::slot ply_format::getSlot(const std::string& property_name)
+{
+    auto found = slotsMap.find(property_name);
+    return found == slotsMap.end() ? none : found->second;
+}
+
+double ply_format::readValue(const char* at, const type& t, const bool& swap)
+{
+    unsigned char bytes[8];
+    const size_t siz = typeSize(t);
+    memcpy(bytes, at, siz);
+    if (swap) std::reverse(bytes, bytes + siz);
+    switch (t)
+    {
+    case type::int8: { int8_t v; memcpy(&v, bytes, 1); return v; }
+    case type::uint8: { uint8_t v; memcpy(&v, bytes, 1); return v; }
+    case type::int16: { int16_t v; memcpy(&v, bytes, 2); return v; }
+    case type::uint16: { uint16_t v; memcpy(&v, bytes, 2); return v; }
+    case type::int32: { int32_t v; memcpy(&v, bytes, 4); return v; }
+    case type::uint32: { uint32_t v; memcpy(&v, bytes, 4); return v; }
+    case type::float32: { float v; memcpy(&v, bytes, 4); return v; }
+    default: { double v; memcpy(&v, bytes, 8); return v; }
+    }
+}
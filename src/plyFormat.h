@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+
+// ply header and value layout shared by readers of ply files
+namespace ply_format {
+
+    enum class type { int8, uint8, int16, uint16, int32, uint32, float32, float64 };
+
+    // vertex property targets
+    enum slot { x, y, z, nx, ny, nz, u, v, r, g, b, a, none };
+
+    class property {
+    public:
+        std::string name;
+        type value_type = type::float32;
+        bool list = false;
+        type count_type = type::uint8;
+
+        bool isFaceIndices() const;
+    };
+
+    class element {
+    public:
+        std::string name;
+        size_t count = 0;
+        std::vector<property> properties;
+
+        size_t get_stride() const; // 0 if element has list properties
+    };
+
+    class header {
+    public:
+        enum class encoding { ascii, binary_little_endian, binary_big_endian };
+        encoding format = encoding::ascii;
+        std::vector<element> elements;
+        size_t body_offset = 0;
+
+        // data has to contain whole header, body may follow
+        header(const char* data, const size_t& size);
+
+        const element* find(const std::string& name) const;
+        bool needsSwap() const; // binary body byte order differs from this machine
+    };
+
+    // binary body access through one buffer of fixed size, for files larger than memory
+    class chunkReader {
+    public:
+        chunkReader(const std::string& filename, const size_t& buffer_size);
+
+        const header& get_header() const;
+        void seekElement(const std::string& name);
+        const char* need(const size_t& amount); // amount contiguous bytes from current position, advances past them, never more than buffer_size
+
+    private:
+        std::ifstream file;
+        header hdr;
+        std::vector<char> buffer;
+        size_t buffer_offset = 0; // file offset of buffer front
+        size_t begin = 0;
+        size_t end = 0;
+
+        void seek(const size_t& offset);
+        static header loadHeader(std::ifstream& file);
+    };
+
+    size_t typeSize(const type& t);
+    double typeMax(const type& t); // colors stored as integers are normalized by it
+    slot getSlot(const std::string& property_name);
+    double readValue(const char* at, const type& t, const bool& swap);
+}
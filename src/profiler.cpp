@@ -0,0 +1,245 @@
+#include "profiler.h"
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+    std::atomic<bool> profiling{ false };
+    std::mutex records_mutex;
+    std::vector<profiler::record> records; // first measured first
+    std::map<std::pair<profiler::phase, std::string>, size_t> record_index;
+    size_t outputs = 0; // labels of emission and write records
+
+    profiler::record emptyRecord(const profiler::phase& p, const std::string& label)
+    {
+        profiler::record r{};
+        r.p = p;
+        r.label = label;
+        return r;
+    }
+}
+
+const size_t profiler::max_outputs = 1000;
+const std::string profiler::other_outputs = "other outputs";
+
+profiler::scope::scope(const phase& p, const std::string& label) : running(profiling.load(std::memory_order_relaxed)), p(p), trace("phase", name(p))
+{
+    if (!label.empty()) trace.arg("label", label);
+    if (!running) return;
+    this->label = label;
+    cpu_start = threadCpuSeconds();
+    counting = perf_counters::read(counters_start);
+    tracking = alloc_tracker::enabled();
+    if (tracking) memory_start = alloc_tracker::begin();
+    start = std::chrono::steady_clock::now();
+}
+
+profiler::scope::~scope()
+{
+    stop();
+}
+
+// measurements are taken before anything here allocates, the trace span ends last
+void profiler::scope::stop()
+{
+    if (running) {
+        running = false;
+        const std::chrono::duration<double> wall{ std::chrono::steady_clock::now() - start };
+        const double cpu = threadCpuSeconds() - cpu_start;
+        perf_counters::values counters;
+        if (counting && perf_counters::read(counters)) counters = counters - counters_start;
+        else counters = perf_counters::values();
+        const alloc_tracker::usage memory = tracking ? alloc_tracker::end(memory_start) : alloc_tracker::usage();
+
+        record r = emptyRecord(p, label);
+        r.calls = 1;
+        r.wall = wall.count();
+        r.cpu = cpu;
+        r.bytes = bytes;
+        r.counters = counters;
+        r.allocations = memory.allocations;
+        r.allocated_bytes = memory.allocated;
+        r.peak_bytes = memory.peak;
+        if (tracking) r.resident_bytes = alloc_tracker::residentBytes();
+        add(r);
+    }
+    trace.stop();
+}
+
+void profiler::scope::set_bytes(const unsigned long long& bytes)
+{
+    this->bytes = bytes;
+}
+
+void profiler::scope::set_source(const std::string& path)
+{
+    trace.arg("source", path);
+}
+
+void profiler::enable()
+{
+    profiling = true;
+}
+
+void profiler::disable()
+{
+    profiling = false;
+    std::lock_guard<std::mutex> lock(records_mutex);
+    records.clear();
+    record_index.clear();
+    outputs = 0;
+}
+
+bool profiler::enabled()
+{
+    return profiling.load(std::memory_order_relaxed);
+}
+
+void profiler::add(const phase& p, const std::string& label, const double& wall_seconds, const double& cpu_seconds, const unsigned long long& bytes,
+    const perf_counters::values& counters)
+{
+    record r = emptyRecord(p, label);
+    r.calls = 1;
+    r.wall = wall_seconds;
+    r.cpu = cpu_seconds;
+    r.bytes = bytes;
+    r.counters = counters;
+    add(r);
+}
+
+void profiler::add(const record& r)
+{
+    std::lock_guard<std::mutex> lock(records_mutex);
+    std::string label = r.label;
+    if ((r.p == phase::emission || r.p == phase::write) && label != other_outputs
+        && record_index.count({ phase::emission, label }) == 0 && record_index.count({ phase::write, label }) == 0) {
+        if (outputs < max_outputs) ++outputs;
+        else label = other_outputs;
+    }
+    auto found = record_index.find({ r.p, label });
+    if (found == record_index.end()) {
+        found = record_index.emplace(std::make_pair(r.p, label), records.size()).first;
+        records.push_back(emptyRecord(r.p, label));
+    }
+    record& total = records[found->second];
+    total.calls += r.calls;
+    total.wall += r.wall;
+    total.cpu += r.cpu;
+    total.bytes += r.bytes;
+    total.counters += r.counters;
+    total.allocations += r.allocations;
+    total.allocated_bytes += r.allocated_bytes;
+    total.peak_bytes = std::max(total.peak_bytes, r.peak_bytes);
+    total.resident_bytes = std::max(total.resident_bytes, r.resident_bytes);
+}
+
+// phase totals, import sources, post processing steps and buffer field kinds by name, then every output with its throughput
+void profiler::print(std::ostream& out)
+{
+    auto print_counters = [&](const char* indent, const perf_counters::values& counters) {
+        if (counters.empty()) return;
+        out << "profile: " << indent << "counters:";
+        for (int c = 0; c < perf_counters::counter_count; ++c) {
+            out << (c == 0 ? " " : ", ") << counters.v[c] << " " << perf_counters::name(static_cast<perf_counters::counter>(c));
+        }
+        if (counters.v[perf_counters::cycles] != 0) out << ", ipc " << static_cast<double>(counters.v[perf_counters::instructions]) / counters.v[perf_counters::cycles];
+        out << "\n";
+    };
+    auto mebibytes = [](const unsigned long long& bytes) { return bytes / (1024.0 * 1024.0); };
+    auto print_memory = [&](const char* indent, const record& r) {
+        if (r.allocations == 0 && r.resident_bytes == 0) return;
+        out << "profile: " << indent << "memory: " << r.allocations << " allocations, " << mebibytes(r.allocated_bytes) << " MiB allocated, peak "
+            << mebibytes(r.peak_bytes) << " MiB, resident " << mebibytes(r.resident_bytes) << " MiB\n";
+    };
+
+    std::lock_guard<std::mutex> lock(records_mutex);
+    for (const phase& p : { phase::format_parse, phase::import, phase::post_process, phase::weights, phase::fields, phase::emission, phase::write }) {
+        record total;
+        for (const record& r : records) {
+            if (r.p != p) continue;
+            total.calls += r.calls;
+            total.wall += r.wall;
+            total.cpu += r.cpu;
+            total.counters += r.counters;
+            total.allocations += r.allocations;
+            total.allocated_bytes += r.allocated_bytes;
+            total.peak_bytes = std::max(total.peak_bytes, r.peak_bytes);
+            total.resident_bytes = std::max(total.resident_bytes, r.resident_bytes);
+        }
+        if (total.calls == 0) continue;
+        out << "profile: " << name(p) << ": " << total.calls << " calls, wall " << total.wall << " s, cpu " << total.cpu << " s\n";
+        print_counters("  ", total.counters);
+        print_memory("  ", total);
+        if (p != phase::import && p != phase::post_process && p != phase::fields) continue;
+        for (const record& r : records) {
+            if (r.p != p) continue;
+            out << "profile:     " << r.label << ": " << r.calls << " calls, wall " << r.wall << " s, cpu " << r.cpu << " s\n";
+            print_counters("      ", r.counters);
+            print_memory("      ", r);
+        }
+    }
+
+    for (const record& w : records) {
+        if (w.p != phase::write) continue;
+        auto emission = record_index.find({ phase::emission, w.label });
+        const double emission_wall = emission == record_index.end() ? 0.0 : records[emission->second].wall;
+        const double seconds = emission_wall + w.wall;
+        out << "profile: output " << w.label << ": " << w.bytes << " bytes, emission " << emission_wall << " s, write " << w.wall << " s, "
+            << (seconds > 0.0 ? w.bytes / seconds / (1024.0 * 1024.0) : 0.0) << " MiB/s\n";
+    }
+
+    if (alloc_tracker::enabled()) {
+        const alloc_tracker::usage heap = alloc_tracker::process();
+        out << "profile: heap: " << heap.allocations << " allocations, " << mebibytes(heap.allocated) << " MiB allocated, peak " << mebibytes(heap.peak) << " MiB live\n";
+#ifdef _WIN32
+        // the assimp dll allocates through its own runtime, see allocTracker.h
+        out << "profile: heap: allocations of the assimp dll are not counted on this platform, import memory above is only the compiler's own, "
+            << "resident covers both\n";
+#endif
+    }
+}
+
+double profiler::threadCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0.0;
+    const unsigned long long k = (static_cast<unsigned long long>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    const unsigned long long u = (static_cast<unsigned long long>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return (k + u) * 1e-7; // 100 ns ticks
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+std::vector<profiler::record> profiler::get_records()
+{
+    std::lock_guard<std::mutex> lock(records_mutex);
+    return records;
+}
+
+const char* profiler::name(const phase& p)
+{
+    switch (p) {
+    case phase::format_parse: return "format parse";
+    case phase::import: return "import";
+    case phase::post_process: return "post process";
+    case phase::weights: return "weights";
+    case phase::fields: return "fields";
+    case phase::emission: return "emission";
+    case phase::write: return "write";
+    }
+    return "unknown";
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include "tracer.h"
+#include "perfCounters.h"
+#include "allocTracker.h"
+
+// wall and cpu time spent in each compile phase, off until enable() so a scope costs one branch,
+// once enabled a scope reads both clocks twice and takes a lock, cpu time is of the measuring thread only
+// so emission spread over range threads shows its wall time but undercounts its cpu time
+class profiler {
+public:
+    enum class phase {
+        format_parse,
+        import,
+        post_process, // assimp post processing steps, part of import
+        weights, // bone weights gathered per mesh, part of emission
+        fields, // entries of one mesh buffer labeled by field kinds, part of emission, summed over range threads
+        emission,
+        write
+    };
+
+    // totals of one phase and label
+    class record {
+    public:
+        phase p;
+        std::string label;
+        size_t calls = 0;
+        double wall = 0.0;
+        double cpu = 0.0;
+        unsigned long long bytes = 0;
+        perf_counters::values counters; // empty unless hardware counters are enabled
+        // zero unless allocations are tracked, peaks are the largest of any call
+        unsigned long long allocations = 0;
+        unsigned long long allocated_bytes = 0;
+        unsigned long long peak_bytes = 0;
+        unsigned long long resident_bytes = 0; // sampled when a call ends
+    };
+
+    // measures from construction until stop() or destruction, label names the source, step or output,
+    // also a trace span named after the phase while tracing
+    class scope {
+    public:
+        scope(const phase& p, const std::string& label = "");
+        scope(const scope& other) = delete;
+        ~scope();
+
+        void stop();
+        void set_bytes(const unsigned long long& bytes);
+        void set_source(const std::string& path); // trace only, profile totals stay per label
+
+    private:
+        bool running;
+        phase p;
+        std::string label;
+        unsigned long long bytes = 0;
+        std::chrono::steady_clock::time_point start;
+        double cpu_start = 0.0;
+        bool counting = false;
+        perf_counters::values counters_start;
+        bool tracking = false;
+        alloc_tracker::mark memory_start;
+        tracer::span trace;
+    };
+
+    // emission and write are recorded per output, so batches stay bounded past max_outputs outputs by adding the rest up under one label
+    static const size_t max_outputs;
+    static const std::string other_outputs;
+
+    profiler() = delete;
+
+    static void enable();
+    static void disable(); // also drops every record, once no scope is running
+    static bool enabled();
+
+    // for times measured elsewhere, e.g. assimp post processing steps
+    static void add(const phase& p, const std::string& label, const double& wall_seconds, const double& cpu_seconds, const unsigned long long& bytes = 0,
+        const perf_counters::values& counters = perf_counters::values());
+    static void add(const record& r); // merged into the record of the same phase and label
+    static void print(std::ostream& out);
+    static std::vector<record> get_records(); // in order of first measurement
+    static const char* name(const phase& p);
+
+    static double threadCpuSeconds();
+};
@@ -0,0 +1,350 @@
+#include "sceneFile.h"
+#include <stdexcept>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include "mappedFile.h"
+
+const unsigned int scene_file::version = 1;
+
+namespace {
+
+    const char magic[4] = { 'M', 'C', 'S', 'N' };
+    const size_t alignment = 16;
+
+    // sizes of structs stored as raw arrays, a file written by a build with other sizes can not be read
+    const unsigned int layout[] = {
+        sizeof(ai_real), sizeof(aiVector3D), sizeof(aiColor4D), sizeof(aiMatrix4x4),
+        sizeof(aiVertexWeight), sizeof(aiVectorKey), sizeof(aiQuatKey)
+    };
+
+    class writer {
+    public:
+        std::ostream& file;
+        size_t pos = 0;
+
+        writer(std::ostream& file) : file(file) {}
+
+        void bytes(const void* data, const size_t& size)
+        {
+            file.write(static_cast<const char*>(data), size);
+            pos += size;
+        }
+
+        template <typename T>
+        void value(const T& v) { bytes(&v, sizeof(T)); }
+
+        void string(const aiString& s)
+        {
+            value<unsigned int>(s.length);
+            bytes(s.data, s.length);
+        }
+
+        template <typename T>
+        void array(const T* data, const size_t& count)
+        {
+            static const char zeros[alignment] = {};
+            bytes(zeros, (alignment - pos % alignment) % alignment);
+            bytes(data, count * sizeof(T));
+        }
+    };
+
+    class reader {
+    public:
+        const char* data;
+        size_t size;
+        size_t pos = 0;
+
+        reader(const char* data, const size_t& size) : data(data), size(size) {}
+
+        const char* take(const size_t& count)
+        {
+            if (count > size - pos) throw std::runtime_error("scene file is truncated");
+            const char* at = data + pos;
+            pos += count;
+            return at;
+        }
+
+        template <typename T>
+        T value()
+        {
+            T v;
+            memcpy(&v, take(sizeof(T)), sizeof(T));
+            return v;
+        }
+
+        // length of a list that follows, every element takes at least min_size bytes
+        // so a damaged count fails here instead of in an allocation of its size
+        unsigned int count(const size_t& min_size)
+        {
+            const unsigned int n = value<unsigned int>();
+            if (n > (size - pos) / min_size) throw std::runtime_error("scene file is truncated");
+            return n;
+        }
+
+        aiString string()
+        {
+            const unsigned int length = value<unsigned int>();
+            if (length >= MAXLEN) throw std::runtime_error("scene file holds too long name");
+            aiString s;
+            s.length = length;
+            memcpy(s.data, take(length), length);
+            s.data[length] = '\0';
+            return s;
+        }
+
+        // nullptr for empty arrays like assimp leaves them
+        template <typename T>
+        T* array(const size_t& count)
+        {
+            take((alignment - pos % alignment) % alignment);
+            if (count > (size - pos) / sizeof(T)) throw std::runtime_error("scene file is truncated");
+            if (count == 0) return nullptr;
+            T* dst = new T[count];
+            memcpy(static_cast<void*>(dst), take(count * sizeof(T)), count * sizeof(T));
+            return dst;
+        }
+    };
+
+    void writeMesh(writer& w, const aiMesh* mesh)
+    {
+        w.string(mesh->mName);
+        w.value<unsigned int>(mesh->mPrimitiveTypes);
+        w.value<unsigned int>(mesh->mNumVertices);
+        w.value<unsigned int>(mesh->mNumFaces);
+
+        // bit per optional stream
+        unsigned int present = 0;
+        if (mesh->mNormals != nullptr) present |= 1u << 0;
+        if (mesh->mTangents != nullptr) present |= 1u << 1;
+        if (mesh->mBitangents != nullptr) present |= 1u << 2;
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+            if (mesh->mTextureCoords[c] != nullptr) present |= 1u << (3 + c);
+        }
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+            if (mesh->mColors[c] != nullptr) present |= 1u << (3 + AI_MAX_NUMBER_OF_TEXTURECOORDS + c);
+        }
+        w.value(present);
+
+        w.array(mesh->mVertices, mesh->mNumVertices);
+        if (mesh->mNormals != nullptr) w.array(mesh->mNormals, mesh->mNumVertices);
+        if (mesh->mTangents != nullptr) w.array(mesh->mTangents, mesh->mNumVertices);
+        if (mesh->mBitangents != nullptr) w.array(mesh->mBitangents, mesh->mNumVertices);
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+            if (mesh->mTextureCoords[c] == nullptr) continue;
+            w.value<unsigned int>(mesh->mNumUVComponents[c]);
+            w.array(mesh->mTextureCoords[c], mesh->mNumVertices);
+        }
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+            if (mesh->mColors[c] != nullptr) w.array(mesh->mColors[c], mesh->mNumVertices);
+        }
+
+        // faces as index counts followed by all indices
+        std::vector<unsigned int> counts(mesh->mNumFaces);
+        std::vector<unsigned int> indices;
+        for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+            counts[i] = mesh->mFaces[i].mNumIndices;
+            indices.insert(indices.end(), mesh->mFaces[i].mIndices, mesh->mFaces[i].mIndices + counts[i]);
+        }
+        w.array(counts.data(), counts.size());
+        w.value<unsigned long long>(indices.size());
+        w.array(indices.data(), indices.size());
+
+        w.value<unsigned int>(mesh->mNumBones);
+        for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+            const aiBone* bone = mesh->mBones[b];
+            w.string(bone->mName);
+            w.value(bone->mOffsetMatrix);
+            w.value<unsigned int>(bone->mNumWeights);
+            w.array(bone->mWeights, bone->mNumWeights);
+        }
+    }
+
+    aiMesh* readMesh(reader& r)
+    {
+        std::unique_ptr<aiMesh> mesh(new aiMesh());
+        mesh->mName = r.string();
+        mesh->mPrimitiveTypes = r.value<unsigned int>();
+        mesh->mNumVertices = r.value<unsigned int>();
+        const unsigned int faces = r.value<unsigned int>();
+        const unsigned int present = r.value<unsigned int>();
+
+        mesh->mVertices = r.array<aiVector3D>(mesh->mNumVertices);
+        if (present & (1u << 0)) mesh->mNormals = r.array<aiVector3D>(mesh->mNumVertices);
+        if (present & (1u << 1)) mesh->mTangents = r.array<aiVector3D>(mesh->mNumVertices);
+        if (present & (1u << 2)) mesh->mBitangents = r.array<aiVector3D>(mesh->mNumVertices);
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+            if (!(present & (1u << (3 + c)))) continue;
+            mesh->mNumUVComponents[c] = r.value<unsigned int>();
+            mesh->mTextureCoords[c] = r.array<aiVector3D>(mesh->mNumVertices);
+        }
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+            if (present & (1u << (3 + AI_MAX_NUMBER_OF_TEXTURECOORDS + c))) mesh->mColors[c] = r.array<aiColor4D>(mesh->mNumVertices);
+        }
+
+        std::unique_ptr<unsigned int[]> counts(r.array<unsigned int>(faces));
+        const unsigned long long index_count = r.value<unsigned long long>();
+        std::unique_ptr<unsigned int[]> indices(r.array<unsigned int>(index_count));
+        if (faces != 0) {
+            mesh->mFaces = new aiFace[faces];
+            mesh->mNumFaces = faces;
+            unsigned long long at = 0;
+            for (unsigned int i = 0; i < faces; ++i) {
+                aiFace& face = mesh->mFaces[i];
+                if (counts[i] > index_count - at) throw std::runtime_error("scene file has faces with more indices than stored");
+                face.mNumIndices = counts[i];
+                face.mIndices = new unsigned int[counts[i]];
+                memcpy(face.mIndices, indices.get() + at, counts[i] * sizeof(unsigned int));
+                at += counts[i];
+            }
+        }
+
+        const unsigned int bones = r.count(sizeof(unsigned int) + sizeof(aiMatrix4x4) + sizeof(unsigned int));
+        if (bones != 0) {
+            mesh->mBones = new aiBone*[bones];
+            for (unsigned int b = 0; b < bones; ++b) {
+                aiBone* bone = new aiBone();
+                mesh->mBones[b] = bone;
+                mesh->mNumBones = b + 1;
+                bone->mName = r.string();
+                bone->mOffsetMatrix = r.value<aiMatrix4x4>();
+                bone->mNumWeights = r.value<unsigned int>();
+                bone->mWeights = r.array<aiVertexWeight>(bone->mNumWeights);
+            }
+        }
+        return mesh.release();
+    }
+
+    void writeSkeleton(writer& w, const aiSkeleton* skeleton)
+    {
+        w.string(skeleton->mName);
+        w.value<unsigned int>(skeleton->mNumBones);
+        for (unsigned int b = 0; b < skeleton->mNumBones; ++b) {
+            const aiSkeletonBone* bone = skeleton->mBones[b];
+            w.value<int>(bone->mParent);
+            w.value(bone->mOffsetMatrix);
+            w.value(bone->mLocalMatrix);
+            w.value<unsigned int>(bone->mNumnWeights);
+            w.array(bone->mWeights, bone->mNumnWeights);
+        }
+    }
+
+    aiSkeleton* readSkeleton(reader& r)
+    {
+        std::unique_ptr<aiSkeleton> skeleton(new aiSkeleton());
+        skeleton->mName = r.string();
+        const unsigned int bones = r.count(sizeof(int) + 2 * sizeof(aiMatrix4x4) + sizeof(unsigned int));
+        skeleton->mBones = new aiSkeletonBone*[bones];
+        for (unsigned int b = 0; b < bones; ++b) {
+            aiSkeletonBone* bone = new aiSkeletonBone();
+            skeleton->mBones[b] = bone;
+            skeleton->mNumBones = b + 1;
+            bone->mParent = r.value<int>();
+            bone->mOffsetMatrix = r.value<aiMatrix4x4>();
+            bone->mLocalMatrix = r.value<aiMatrix4x4>();
+            bone->mNumnWeights = r.value<unsigned int>();
+            bone->mWeights = r.array<aiVertexWeight>(bone->mNumnWeights);
+        }
+        return skeleton.release();
+    }
+
+    void writeAnimation(writer& w, const aiAnimation* animation)
+    {
+        w.string(animation->mName);
+        w.value(animation->mDuration);
+        w.value(animation->mTicksPerSecond);
+        w.value<unsigned int>(animation->mNumChannels);
+        for (unsigned int c = 0; c < animation->mNumChannels; ++c) {
+            const aiNodeAnim* channel = animation->mChannels[c];
+            w.string(channel->mNodeName);
+            w.value<unsigned int>(channel->mNumPositionKeys);
+            w.array(channel->mPositionKeys, channel->mNumPositionKeys);
+            w.value<unsigned int>(channel->mNumRotationKeys);
+            w.array(channel->mRotationKeys, channel->mNumRotationKeys);
+            w.value<unsigned int>(channel->mNumScalingKeys);
+            w.array(channel->mScalingKeys, channel->mNumScalingKeys);
+        }
+    }
+
+    aiAnimation* readAnimation(reader& r)
+    {
+        std::unique_ptr<aiAnimation> animation(new aiAnimation());
+        animation->mName = r.string();
+        animation->mDuration = r.value<double>();
+        animation->mTicksPerSecond = r.value<double>();
+        const unsigned int channels = r.count(sizeof(unsigned int) * 4);
+        animation->mChannels = new aiNodeAnim*[channels];
+        for (unsigned int c = 0; c < channels; ++c) {
+            aiNodeAnim* channel = new aiNodeAnim();
+            animation->mChannels[c] = channel;
+            animation->mNumChannels = c + 1;
+            channel->mNodeName = r.string();
+            channel->mNumPositionKeys = r.value<unsigned int>();
+            channel->mPositionKeys = r.array<aiVectorKey>(channel->mNumPositionKeys);
+            channel->mNumRotationKeys = r.value<unsigned int>();
+            channel->mRotationKeys = r.array<aiQuatKey>(channel->mNumRotationKeys);
+            channel->mNumScalingKeys = r.value<unsigned int>();
+            channel->mScalingKeys = r.array<aiVectorKey>(channel->mNumScalingKeys);
+        }
+        return animation.release();
+    }
+}
+
+void scene_file::write(std::ostream& file, const aiScene* scene)
+{
+    writer w(file);
+    w.bytes(magic, sizeof(magic));
+    w.value(version);
+    w.bytes(layout, sizeof(layout));
+
+    w.string(scene->mName);
+    w.value<unsigned int>(scene->mNumMeshes);
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) writeMesh(w, scene->mMeshes[i]);
+    w.value<unsigned int>(scene->mNumSkeletons);
+    for (unsigned int i = 0; i < scene->mNumSkeletons; ++i) writeSkeleton(w, scene->mSkeletons[i]);
+    w.value<unsigned int>(scene->mNumAnimations);
+    for (unsigned int i = 0; i < scene->mNumAnimations; ++i) writeAnimation(w, scene->mAnimations[i]);
+}
+
+aiScene* scene_file::read(const char* data, const size_t& size)
+{
+    reader r(data, size);
+    if (memcmp(r.take(sizeof(magic)), magic, sizeof(magic)) != 0) throw std::runtime_error("not a scene file");
+    if (r.value<unsigned int>() != version) throw std::runtime_error("scene file of other version");
+    if (memcmp(r.take(sizeof(layout)), layout, sizeof(layout)) != 0) throw std::runtime_error("scene file written by build with other struct layout");
+
+    std::unique_ptr<aiScene> scene(new aiScene());
+    scene->mName = r.string();
+
+    const unsigned int meshes = r.count(sizeof(unsigned int) * 5);
+    scene->mMeshes = new aiMesh*[meshes];
+    for (unsigned int i = 0; i < meshes; ++i) {
+        scene->mMeshes[i] = readMesh(r);
+        scene->mNumMeshes = i + 1;
+    }
+    const unsigned int skeletons = r.count(sizeof(unsigned int) * 2);
+    scene->mSkeletons = new aiSkeleton*[skeletons];
+    for (unsigned int i = 0; i < skeletons; ++i) {
+        scene->mSkeletons[i] = readSkeleton(r);
+        scene->mNumSkeletons = i + 1;
+    }
+    const unsigned int animations = r.count(sizeof(unsigned int) + 2 * sizeof(double) + sizeof(unsigned int));
+    scene->mAnimations = new aiAnimation*[animations];
+    for (unsigned int i = 0; i < animations; ++i) {
+        scene->mAnimations[i] = readAnimation(r);
+        scene->mNumAnimations = i + 1;
+    }
+
+    // flat hierarchy, every mesh hangs from root
+    scene->mRootNode = new aiNode(scene->mName.C_Str());
+    scene->mRootNode->mNumMeshes = scene->mNumMeshes;
+    scene->mRootNode->mMeshes = new unsigned int[scene->mNumMeshes];
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) scene->mRootNode->mMeshes[i] = i;
+    return scene.release();
+}
+
+aiScene* scene_file::readFile(const std::string& filename)
+{
+    mapped_file file(filename);
+    return read(file.data(), file.size());
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <ostream>
+
+#include <assimp/scene.h>
+
+// binary snapshot of the parts of an imported aiScene mesh_compiler reads: meshes with bones, skeletons
+// and animations, arrays are stored as they lie in memory at 16 byte aligned offsets so reading one back
+// is bounds checks and copies straight out of the mapped file, node hierarchy and materials are not kept
+namespace scene_file {
+
+    // bumped whenever layout changes, files of other versions are rejected
+    extern const unsigned int version;
+
+    void write(std::ostream& file, const aiScene* scene);
+
+    // caller owns returned scene, throws std::runtime_error if data is not a scene file of this version and build
+    aiScene* read(const char* data, const size_t& size);
+    aiScene* readFile(const std::string& filename);
+}
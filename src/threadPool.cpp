@@ -0,0 +1,120 @@
+#include "threadPool.h"
+
+thread_pool::thread_pool(const unsigned int& threads)
+{
+    unsigned int n = threads == 0 ? 1 : threads;
+    for (unsigned int i = 0; i < n; ++i) queues.emplace_back(new queue());
+    for (unsigned int i = 0; i < n; ++i) workers.emplace_back(&thread_pool::work, this, i);
+}
+
+thread_pool::~thread_pool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+    // counted before it is pushed, a stealing worker may run it right away
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++queued;
+        ++pending;
+    }
+    queue& q = *queues[next_queue++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void thread_pool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+}
+
+void thread_pool::run(const size_t& count, const std::function<void(size_t)>& task)
+{
+    std::mutex group_mutex;
+    std::condition_variable group_done;
+    size_t left = count;
+    for (size_t i = 0; i < count; ++i) {
+        submit([&, i]() {
+            try {
+                task(i);
+            }
+            catch (...) {
+                // same as submit, the task reports its own errors
+            }
+            std::lock_guard<std::mutex> lock(group_mutex);
+            if (--left == 0) group_done.notify_all();
+        });
+    }
+    std::unique_lock<std::mutex> lock(group_mutex);
+    group_done.wait(lock, [&] { return left == 0; });
+}
+
+unsigned int thread_pool::size() const
+{
+    return static_cast<unsigned int>(workers.size());
+}
+
+unsigned int thread_pool::defaultSize()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+bool thread_pool::take(const unsigned int& worker, std::function<void()>& task)
+{
+    const size_t n = queues.size();
+    for (size_t i = 0; i < n; ++i) {
+        queue& q = *queues[(worker + i) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        if (i == 0) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void thread_pool::work(const unsigned int& worker)
+{
+    std::function<void()> task;
+    while (true) {
+        if (take(worker, task)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --queued;
+            }
+            try {
+                task();
+            }
+            catch (...) {
+                // tasks report their own errors, pool only has to survive them
+            }
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return stopping || queued != 0; });
+        if (stopping && queued == 0) return;
+    }
+}
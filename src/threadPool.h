@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+// fixed set of workers each with own task queue, workers take newest task from own queue
+// and steal oldest task from the others when it runs dry, tasks are expected to handle their own errors
+class thread_pool {
+public:
+    thread_pool(const unsigned int& threads);
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool(thread_pool&& other) = delete;
+    ~thread_pool(); // finishes submitted tasks
+
+    void submit(std::function<void()> task);
+    void wait(); // blocks until every submitted task finished
+    // task(0) ... task(count - 1) on the workers, blocks until those finished, unlike wait() it does not wait
+    // for tasks of other threads sharing the pool, must not be called from a task
+    void run(const size_t& count, const std::function<void(size_t)>& task);
+    unsigned int size() const;
+
+    // hardware concurrency, at least 1
+    static unsigned int defaultSize();
+
+private:
+    class queue {
+    public:
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned int> next_queue{ 0 };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    size_t queued = 0; // waiting in queues
+    size_t pending = 0; // submitted and not finished
+    bool stopping = false;
+
+    bool take(const unsigned int& worker, std::function<void()>& task);
+    void work(const unsigned int& worker);
+};
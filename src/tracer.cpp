@@ -0,0 +1,148 @@
+#include "tracer.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "compileStats.h"
+
+namespace {
+
+    class event {
+    public:
+        const char* category;
+        std::string name;
+        std::string args;
+        long long start; // nanoseconds since enable()
+        long long duration;
+    };
+
+    // one per thread that stopped a span, outlives its thread so write() still finds the events,
+    // the lock is only ever contended by write()
+    class threadBuffer {
+    public:
+        size_t tid = 0;
+        std::string name;
+        std::mutex mutex;
+        std::vector<event> events;
+    };
+
+    std::atomic<bool> tracing{ false };
+    std::chrono::steady_clock::time_point epoch;
+    std::thread::id main_thread;
+    std::mutex buffers_mutex;
+    std::vector<std::unique_ptr<threadBuffer>> buffers; // in order of first span
+
+    threadBuffer& localBuffer()
+    {
+        thread_local threadBuffer* local = nullptr;
+        if (local == nullptr) {
+            std::lock_guard<std::mutex> lock(buffers_mutex);
+            buffers.emplace_back(new threadBuffer());
+            local = buffers.back().get();
+            local->tid = buffers.size();
+            local->name = std::this_thread::get_id() == main_thread ? "main" : "worker " + std::to_string(local->tid);
+        }
+        return *local;
+    }
+
+    long long sinceEpoch(const std::chrono::steady_clock::time_point& time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count();
+    }
+}
+
+tracer::span::span(const char* category, const std::string& name) : running(tracing.load(std::memory_order_relaxed))
+{
+    if (!running) return;
+    this->category = category;
+    this->name = name;
+    start = std::chrono::steady_clock::now();
+}
+
+tracer::span::~span()
+{
+    stop();
+}
+
+void tracer::span::arg(const char* key, const char* value)
+{
+    if (!running) return;
+    if (!args.empty()) args += ", ";
+    args += compile_stats::quoted(key) + ": " + compile_stats::quoted(value);
+}
+
+void tracer::span::arg(const char* key, const std::string& value)
+{
+    arg(key, value.c_str());
+}
+
+void tracer::span::arg(const char* key, const unsigned long long& value)
+{
+    if (!running) return;
+    if (!args.empty()) args += ", ";
+    args += compile_stats::quoted(key) + ": " + std::to_string(value);
+}
+
+void tracer::span::stop()
+{
+    if (!running) return;
+    running = false;
+    const long long begin = sinceEpoch(start);
+    const long long end = sinceEpoch(std::chrono::steady_clock::now());
+    threadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back(event{ category, std::move(name), std::move(args), begin, end - begin });
+}
+
+void tracer::enable()
+{
+    epoch = std::chrono::steady_clock::now();
+    main_thread = std::this_thread::get_id();
+    tracing = true;
+}
+
+// buffers stay, threads of an earlier run may still hold theirs
+void tracer::disable()
+{
+    tracing = false;
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (const std::unique_ptr<threadBuffer>& buffer : buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+bool tracer::enabled()
+{
+    return tracing.load(std::memory_order_relaxed);
+}
+
+// json object format, timestamps in microseconds, every thread gets a name so idle workers still show up
+void tracer::write(const std::string& path)
+{
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    if (!out) throw std::runtime_error("cannot open file: " + path);
+    out << std::fixed << std::setprecision(3);
+
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    out << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for (const std::unique_ptr<threadBuffer>& buffer : buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        if (buffer->events.empty()) continue; // emptied by disable(), a thread of an earlier run
+        out << (first ? "\n" : ",\n") << "{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+            << ", \"args\": { \"name\": " << compile_stats::quoted(buffer->name) << " } }";
+        first = false;
+        for (const event& e : buffer->events) {
+            out << ",\n{ \"name\": " << compile_stats::quoted(e.name) << ", \"cat\": " << compile_stats::quoted(e.category) << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid
+                << ", \"ts\": " << e.start / 1000.0 << ", \"dur\": " << e.duration / 1000.0 << ", \"args\": { " << e.args << " } }";
+        }
+    }
+    out << "\n] }\n";
+    out.close();
+    if (!out) throw std::runtime_error("could not write trace: " + path);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <chrono>
+
+// chrome trace event spans for chrome://tracing and Perfetto, off until enable() so a span costs one branch,
+// once enabled a span reads the clock twice and appends one event to a buffer owned by its thread,
+// buffers are only gathered by write() so worker threads never wait on each other
+class tracer {
+public:
+    // complete event from construction until stop() or destruction, spans of one thread nest
+    class span {
+    public:
+        span(const char* category, const std::string& name);
+        span(const span& other) = delete;
+        ~span();
+
+        void arg(const char* key, const char* value);
+        void arg(const char* key, const std::string& value);
+        void arg(const char* key, const unsigned long long& value);
+        void stop();
+
+    private:
+        bool running;
+        const char* category = nullptr;
+        std::string name;
+        std::string args; // json members, already quoted
+        std::chrono::steady_clock::time_point start;
+    };
+
+    tracer() = delete;
+
+    static void enable();
+    static void disable(); // also drops every event, once no span is running
+    static bool enabled();
+
+    static void write(const std::string& path); // every span stopped so far
+};
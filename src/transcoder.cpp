@@ -0,0 +1,227 @@
+#include "transcoder.h"
+#include <cstring>
+#include "outputImporter.h"
+
+namespace {
+
+    // same conversion writeConst does when value is compiled straight from a scene
+    template <typename S, typename T>
+    void convertColumn(const char* src, const size_t& src_stride, char* dst, const size_t& dst_stride, const size_t& count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            S s;
+            memcpy(&s, src + i * src_stride, sizeof(S));
+            T t = static_cast<T>(s);
+            memcpy(dst + i * dst_stride, &t, sizeof(T));
+        }
+    }
+
+    template <typename S>
+    void copyColumn(const char* src, const size_t& src_stride, char* dst, const size_t& dst_stride, const size_t& count)
+    {
+        if (src_stride == sizeof(S) && dst_stride == sizeof(S)) {
+            memcpy(dst, src, count * sizeof(S));
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) memcpy(dst + i * dst_stride, src + i * src_stride, sizeof(S));
+    }
+}
+
+// ========== KERNELS ==========
+
+template <typename S>
+transcoder::kernel transcoder::kernelFrom(const mesh_compiler::type& to)
+{
+    switch (to)
+    {
+    case mesh_compiler::mc_char: return convertColumn<S, char>;
+    case mesh_compiler::mc_short: return convertColumn<S, short>;
+    case mesh_compiler::mc_unsigned_short: return convertColumn<S, unsigned short>;
+    case mesh_compiler::mc_int: return convertColumn<S, int>;
+    case mesh_compiler::mc_unsigned_int: return convertColumn<S, unsigned int>;
+    case mesh_compiler::mc_long: return convertColumn<S, long>;
+    case mesh_compiler::mc_unsigned_long: return convertColumn<S, unsigned long>;
+    case mesh_compiler::mc_long_long: return convertColumn<S, long long>;
+    case mesh_compiler::mc_unsigned_long_long: return convertColumn<S, unsigned long long>;
+    case mesh_compiler::mc_float: return convertColumn<S, float>;
+    case mesh_compiler::mc_double: return convertColumn<S, double>;
+    case mesh_compiler::mc_long_double: return convertColumn<S, long double>;
+    default:
+        throw std::logic_error("unknown type");
+    }
+}
+
+transcoder::kernel transcoder::kernelFor(const mesh_compiler::type& from, const mesh_compiler::type& to)
+{
+    if (from == to) {
+        switch (mesh_compiler::typeSizesMap[from])
+        {
+        case 1: return copyColumn<char>;
+        case 2: return copyColumn<short>;
+        case 4: return copyColumn<int>;
+        case 8: return copyColumn<long long>;
+        default: break; // long double has no plain integer of its size
+        }
+    }
+
+    switch (from)
+    {
+    case mesh_compiler::mc_char: return kernelFrom<char>(to);
+    case mesh_compiler::mc_short: return kernelFrom<short>(to);
+    case mesh_compiler::mc_unsigned_short: return kernelFrom<unsigned short>(to);
+    case mesh_compiler::mc_int: return kernelFrom<int>(to);
+    case mesh_compiler::mc_unsigned_int: return kernelFrom<unsigned int>(to);
+    case mesh_compiler::mc_long: return kernelFrom<long>(to);
+    case mesh_compiler::mc_unsigned_long: return kernelFrom<unsigned long>(to);
+    case mesh_compiler::mc_long_long: return kernelFrom<long long>(to);
+    case mesh_compiler::mc_unsigned_long_long: return kernelFrom<unsigned long long>(to);
+    case mesh_compiler::mc_float: return kernelFrom<float>(to);
+    case mesh_compiler::mc_double: return kernelFrom<double>(to);
+    case mesh_compiler::mc_long_double: return kernelFrom<long double>(to);
+    default:
+        throw std::logic_error("unknown type");
+    }
+}
+
+// ========== TRANSCODER ==========
+
+transcoder::transcoder(const std::string& source_format, const std::string& output_file) :
+    decoder(source_format), output_file(output_file), file_unit(decoder.findFileUnit(output_file)),
+    record(decoder.decode(output_file, file_unit)), source_file(output_file)
+{
+    const mesh_compiler::fileUnit& fu = decoder.get_compilation_info().file_units[file_unit];
+    for (const mesh_decoder::bufferRecord& br : record.buffers) {
+        if (!br.units.empty()) throw std::runtime_error("transcoding needs source format without nested units in buffer entries, use --from instead");
+    }
+    if (fu.count_type == mesh_compiler::counting_type::null) throw std::runtime_error("file unit: " + fu.output_file + " does not hold scene objects");
+}
+
+transcoder::plan transcoder::map(const mesh_compiler::fileUnit& target) const
+{
+    const mesh_compiler::fileUnit& source = decoder.get_compilation_info().file_units[file_unit];
+    if (target.count_type != source.count_type) {
+        throw std::runtime_error(std::string("can not transcode ") + mesh_compiler::countingTypeNamesMap[source.count_type] + " file unit into " + mesh_compiler::countingTypeNamesMap[target.count_type] + " file unit, use --from instead");
+    }
+    if (hasNestedUnits(target)) throw std::runtime_error("transcoding needs target format without nested units, use --from instead");
+
+    plan p;
+    for (const mesh_compiler::compileBuffer& buffer : target.buffers) {
+        p.buffers.push_back(bufferPlan());
+        bufferPlan& bp = p.buffers.back();
+        bp.count = static_cast<size_t>(-1);
+        bp.entry_size = buffer.get_entry_size();
+
+        size_t offset = 0;
+        for (const mesh_compiler::compileField& field : buffer.fields) {
+            column c;
+            c.field = &field;
+            c.target_offset = offset;
+            offset += field.get_size();
+            if (field.vtype != mesh_compiler::value::constant) {
+                findColumn(field, buffer.count_type, source, record, c, bp.count);
+                if (c.source == nullptr) {
+                    throw std::runtime_error(std::string("source format does not store ") + mesh_compiler::valueNamesMap[field.vtype] + " in " + mesh_compiler::countingTypeNamesMap[buffer.count_type] + " buffer");
+                }
+            }
+            bp.columns.push_back(c);
+        }
+
+        // buffers of constants only take entry count from any source buffer counted the same way
+        if (bp.count == static_cast<size_t>(-1)) findCount(buffer.count_type, source, record, bp.count);
+        if (bp.count == static_cast<size_t>(-1)) {
+            throw std::runtime_error(std::string("source format has no ") + mesh_compiler::countingTypeNamesMap[buffer.count_type] + " buffer to take entry count from");
+        }
+    }
+    return p;
+}
+
+// nested units in source preamble describe the same object, their buffers are searched too
+void transcoder::findColumn(const mesh_compiler::compileField& field, const mesh_compiler::counting_type& count_type, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& rec, column& c, size_t& count) const
+{
+    for (size_t i = 0; i < unit.buffers.size() && c.source == nullptr; ++i) {
+        const mesh_compiler::compileBuffer& buffer = unit.buffers[i];
+        if (buffer.count_type != count_type) continue;
+
+        size_t offset = 0;
+        for (const mesh_compiler::compileField& sf : buffer.fields) {
+            if (sf.vtype == field.vtype && sf.data == field.data) {
+                c.source = &rec.buffers[i];
+                c.source_offset = offset;
+                c.convert = kernelFor(sf.stype, field.stype);
+                count = rec.buffers[i].count;
+                return;
+            }
+            offset += sf.get_size();
+        }
+    }
+    for (const mesh_decoder::unitRecord& nested : rec.preamble_units) {
+        if (c.source != nullptr) return;
+        findColumn(field, count_type, decoder.get_compilation_info().units.at(nested.name), nested, c, count);
+    }
+}
+
+bool transcoder::hasNestedUnits(const mesh_compiler::compileUnit& unit)
+{
+    for (const mesh_compiler::compileField& field : unit.preamble) {
+        if (field.vtype == mesh_compiler::value::other_unit) return true;
+    }
+    for (const mesh_compiler::compileBuffer& buffer : unit.buffers) {
+        for (const mesh_compiler::compileField& field : buffer.preamble) {
+            if (field.vtype == mesh_compiler::value::other_unit) return true;
+        }
+        for (const mesh_compiler::compileField& field : buffer.fields) {
+            if (field.vtype == mesh_compiler::value::other_unit) return true;
+        }
+    }
+    return false;
+}
+
+bool transcoder::findCount(const mesh_compiler::counting_type& count_type, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& rec, size_t& count) const
+{
+    for (size_t i = 0; i < unit.buffers.size(); ++i) {
+        if (unit.buffers[i].count_type != count_type) continue;
+        count = rec.buffers[i].count;
+        return true;
+    }
+    for (const mesh_decoder::unitRecord& nested : rec.preamble_units) {
+        if (findCount(count_type, decoder.get_compilation_info().units.at(nested.name), nested, count)) return true;
+    }
+    return false;
+}
+
+void transcoder::put(std::ostream& file, mesh_compiler::fileUnit& target, const plan& p) const
+{
+    for (size_t i = 0; i < target.buffers.size(); ++i) target.buffers[i].count = p.buffers[i].count;
+
+    // preamble
+    for (const mesh_compiler::compileField& field : target.preamble) field.put(file, target);
+
+    // buffers
+    std::vector<char> entries;
+    for (size_t i = 0; i < target.buffers.size(); ++i) {
+        const mesh_compiler::compileBuffer& buffer = target.buffers[i];
+        const bufferPlan& bp = p.buffers[i];
+
+        // buffer preamble
+        for (const mesh_compiler::compileField& field : buffer.preamble) field.put(file, buffer);
+
+        // fields
+        entries.resize(bp.count * bp.entry_size);
+        for (const column& c : bp.columns) {
+            char* dst = entries.data() + c.target_offset;
+            if (c.source == nullptr) {
+                for (size_t j = 0; j < bp.count; ++j) memcpy(dst + j * bp.entry_size, c.field->data.data(), c.field->get_size());
+            }
+            else c.convert(source_file.data() + c.source->offset + c.source_offset, c.source->entry_size, dst, bp.entry_size, bp.count);
+        }
+        file.write(entries.data(), entries.size());
+    }
+}
+
+std::string transcoder::objectName(const std::string& placeholder) const
+{
+    std::string name = output_importer::placeholderValue(output_file, decoder.get_compilation_info().file_units[file_unit].output_file, placeholder);
+    if (!name.empty()) return name;
+    std::string base_filename = output_file.substr(output_file.find_last_of("/\\") + 1);
+    return base_filename.substr(0, base_filename.find_last_of('.'));
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "meshDecoder.h"
+#include "mappedFile.h"
+
+// copies fields of an output compiled with one format into the layout of another format,
+// fields are matched by value and suffixes and converted column by column, no aiScene is built
+class transcoder {
+public:
+    // converts count values of one type to another, src and dst advance by their strides
+    typedef void (*kernel)(const char* src, const size_t& src_stride, char* dst, const size_t& dst_stride, const size_t& count);
+
+    // one target field and where its values come from
+    class column {
+    public:
+        const mesh_compiler::compileField* field = nullptr;
+        const mesh_decoder::bufferRecord* source = nullptr; // nullptr for constants
+        size_t source_offset = 0; // within source entry
+        size_t target_offset = 0; // within target entry
+        kernel convert = nullptr;
+    };
+
+    class bufferPlan {
+    public:
+        size_t count = 0;
+        size_t entry_size = 0;
+        std::vector<column> columns;
+    };
+
+    class plan {
+    public:
+        std::vector<bufferPlan> buffers;
+    };
+
+    transcoder(const std::string& source_format, const std::string& output_file);
+    transcoder(const transcoder& other) = delete;
+
+    // throws std::runtime_error if target can not be filled from source
+    plan map(const mesh_compiler::fileUnit& target) const;
+    void put(std::ostream& file, mesh_compiler::fileUnit& target, const plan& p) const;
+
+    // object name placeholder stood for when source was compiled, source file name if it can not be told
+    std::string objectName(const std::string& placeholder) const;
+
+    static kernel kernelFor(const mesh_compiler::type& from, const mesh_compiler::type& to);
+
+private:
+    mesh_decoder decoder;
+    std::string output_file;
+    size_t file_unit;
+    mesh_decoder::unitRecord record;
+    mapped_file source_file;
+
+    template <typename S>
+    static kernel kernelFrom(const mesh_compiler::type& to);
+
+    static bool hasNestedUnits(const mesh_compiler::compileUnit& unit);
+    void findColumn(const mesh_compiler::compileField& field, const mesh_compiler::counting_type& count_type, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& rec, column& c, size_t& count) const;
+    bool findCount(const mesh_compiler::counting_type& count_type, const mesh_compiler::compileUnit& unit, const mesh_decoder::unitRecord& rec, size_t& count) const;
+};
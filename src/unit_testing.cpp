@@ -1,6 +1,11 @@
 #ifdef _DEBUG
 #include "unit_testing.h"
 #include <sstream>
+#include <filesystem>
+#include "assimpReader.h"
+#include "threadPool.h"
+#include "perfCounters.h"
+#include "allocTracker.h"
 
 unit_testing::failedTestException::failedTestException(
 	const std::string& test_name, const std::string& fail_reason) :
@@ -30,6 +35,376 @@ void unit_testing::formatInterpreterFailTest::run(const run_mode& mode)
 	}
 }
 
+unit_testing::meshDecoderTest::meshDecoderTest(
+	const std::string& name, const std::string& input_file, const std::string& format_file, const std::vector<size_t>& expected_counts) :
+	test(name), call_arguments({ input_file, format_file }), expected_counts(expected_counts) {}
+
+void unit_testing::meshDecoderTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) std::cout << name << " skipped\n";
+	else if (mode == run_mode::debug) mesh_compiler::runOnceDebug(call_arguments);
+	else {
+		mesh_compiler::runOnce(call_arguments);
+
+		mesh_decoder::unitRecord record = mesh_decoder(call_arguments[1]).decode("./unit-tests/mesh-compiler/out.mesh");
+		std::remove("./unit-tests/mesh-compiler/out.mesh");
+
+		if (bufferCounts(record) != expected_counts) throw failedTestException(name, "decoded buffer counts differ from expected");
+
+		std::cout << name << " passed\n";
+	}
+}
+
+unit_testing::emitRangesTest::emitRangesTest(
+	const std::string& name, const std::string& format_file, const unsigned int& vertex_count) :
+	test(name), format_file(format_file), vertex_count(vertex_count) {}
+
+void unit_testing::emitRangesTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	aiMesh mesh;
+	fillStrip(mesh, vertex_count);
+
+	mesh_compiler::compilationInfo ci(format_file);
+	mesh_compiler::fileUnit fu = ci.file_units[0];
+	std::ostringstream serial(std::ios::out | std::ios::binary);
+	fu.put(serial, &mesh);
+
+	thread_pool pool(4);
+	fu.emit_pool = &pool;
+	std::ostringstream parallel(std::ios::out | std::ios::binary);
+	fu.put(parallel, &mesh);
+
+	if (serial.str().empty()) throw failedTestException(name, "nothing was emitted");
+	if (serial.str() != parallel.str()) throw failedTestException(name, "parallel emission differs from serial emission");
+	std::cout << name << " passed\n";
+}
+
+unit_testing::measureTest::measureTest(
+	const std::string& name, const std::string& format_file, const unsigned int& vertex_count) :
+	test(name), format_file(format_file), vertex_count(vertex_count) {}
+
+void unit_testing::measureTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	aiMesh mesh;
+	fillStrip(mesh, vertex_count);
+
+	mesh_compiler::compilationInfo ci(format_file);
+	mesh_compiler::fileUnit fu = ci.file_units[0];
+	std::ostringstream report;
+	const size_t measured = fu.measure(report, &mesh);
+	std::ostringstream emitted(std::ios::out | std::ios::binary);
+	fu.put(emitted, &mesh);
+
+	if (measured != emitted.str().size()) throw failedTestException(name, "measured " + std::to_string(measured) + " bytes, emitted " + std::to_string(emitted.str().size()) + " bytes");
+	std::cout << name << " passed\n";
+}
+
+unit_testing::importSettingsTest::importSettingsTest(
+	const std::string& name, const std::string& format_file, const std::string& overrides, const unsigned int& expected_flags, const int& expected_removed_components) :
+	test(name), format_file(format_file), overrides(overrides), expected_flags(expected_flags), expected_removed_components(expected_removed_components) {}
+
+void unit_testing::importSettingsTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	mesh_compiler::compilationInfo ci(format_file);
+	mesh_compiler::compileSettings settings;
+	mesh_compiler::applyFormatImport(settings, ci, overrides);
+
+	if (settings.import.flags != expected_flags) throw failedTestException(name, "post processing flags differ from expected");
+	if (settings.import.removed_components != expected_removed_components) throw failedTestException(name, "removed components differ from expected");
+	std::cout << name << " passed\n";
+}
+
+void unit_testing::fillStrip(aiMesh& mesh, const unsigned int& vertex_count)
+{
+	mesh.mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+	mesh.mNumVertices = vertex_count;
+	mesh.mVertices = new aiVector3D[vertex_count];
+	mesh.mNormals = new aiVector3D[vertex_count];
+	for (unsigned int i = 0; i < vertex_count; ++i) {
+		mesh.mVertices[i] = aiVector3D(static_cast<float>(i), 0.5f * i, -1.0f * i);
+		mesh.mNormals[i] = aiVector3D(0.0f, 1.0f, static_cast<float>(i % 7));
+	}
+	mesh.mNumFaces = vertex_count - 2;
+	mesh.mFaces = new aiFace[mesh.mNumFaces];
+	for (unsigned int i = 0; i < mesh.mNumFaces; ++i) {
+		mesh.mFaces[i].mNumIndices = 3;
+		mesh.mFaces[i].mIndices = new unsigned int[3]{ i, i + 1, i + 2 };
+	}
+}
+
+std::vector<size_t> unit_testing::bufferCounts(const mesh_decoder::unitRecord& record)
+{
+	std::vector<size_t> counts;
+	std::vector<const mesh_decoder::unitRecord*> stack = { &record };
+	while (!stack.empty()) {
+		const mesh_decoder::unitRecord* u = stack.back();
+		stack.pop_back();
+		for (const mesh_decoder::bufferRecord& b : u->buffers) counts.push_back(b.count);
+		for (auto it = u->preamble_units.rbegin(); it != u->preamble_units.rend(); ++it) stack.push_back(&(*it));
+	}
+	return counts;
+}
+
+void unit_testing::checkOutputs(const std::string& test_name, const std::vector<expectedOutput>& outputs)
+{
+	std::string failure;
+	for (const expectedOutput& o : outputs) {
+		if (!std::filesystem::exists(o.file)) failure = "missing output: " + o.file;
+		else if (o.format_file.empty()) {
+			std::ifstream file(o.file, std::ios::in | std::ios::binary);
+			const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			for (const std::string& part : o.contents) {
+				if (text.find(part) == std::string::npos) {
+					failure = o.file + " lacks: " + part;
+					break;
+				}
+			}
+		}
+		else {
+			try {
+				if (bufferCounts(mesh_decoder(o.format_file).decode(o.file)) != o.counts) failure = "decoded buffer counts of " + o.file + " differ from expected";
+			}
+			catch (std::exception& e) {
+				failure = "could not decode " + o.file + ": " + e.what();
+			}
+		}
+		if (!failure.empty()) break;
+	}
+	removeOutputs(outputs);
+	if (!failure.empty()) throw failedTestException(test_name, failure);
+}
+
+void unit_testing::removeOutputs(const std::vector<expectedOutput>& outputs)
+{
+	std::error_code ec;
+	for (const expectedOutput& o : outputs) std::filesystem::remove(o.file, ec);
+}
+
+unit_testing::memoryCompileTest::memoryCompileTest(
+	const std::string& name, const std::string& input_file, const std::string& hint, const std::string& format_file, const std::string& source_name, const std::vector<expectedOutput>& outputs) :
+	test(name), input_file(input_file), hint(hint), format_file(format_file), source_name(source_name), outputs(outputs) {}
+
+void unit_testing::memoryCompileTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	std::ifstream file(input_file, std::ios::in | std::ios::binary);
+	if (!file) throw std::runtime_error("could not open file: " + input_file);
+	std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	removeOutputs(outputs);
+	mesh_compiler::compileMemory(data.data(), data.size(), hint, format_file, source_name);
+	checkOutputs(name, outputs);
+	std::cout << name << " passed\n";
+}
+
+unit_testing::stdoutFramesTest::stdoutFramesTest(
+	const std::string& name, const std::vector<std::string>& call_arguments, const std::vector<expectedOutput>& outputs) :
+	test(name), call_arguments(call_arguments), outputs(outputs) {}
+
+void unit_testing::stdoutFramesTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) std::cout << name << " skipped\n";
+	else if (mode == run_mode::debug) mesh_compiler::runOnceDebug(call_arguments);
+	else {
+		removeOutputs(outputs);
+		std::streambuf* oldCoutStreamBuf = std::cout.rdbuf();
+		std::stringstream strCout(std::ios::in | std::ios::out | std::ios::binary);
+		std::cout.rdbuf(strCout.rdbuf());
+		mesh_compiler::runOnce(call_arguments);
+		std::cout.rdbuf(oldCoutStreamBuf);
+
+		for (const expectedOutput& o : outputs) {
+			if (std::filesystem::exists(o.file)) {
+				removeOutputs(outputs);
+				throw failedTestException(name, "output was written to a file: " + o.file);
+			}
+		}
+
+		std::string frame_name;
+		std::vector<char> data;
+		size_t frames = 0;
+		while (mesh_reader::readFrame(strCout, frame_name, data)) {
+			if (frames == outputs.size() || frame_name != outputs[frames].file) {
+				removeOutputs(outputs);
+				throw failedTestException(name, "unexpected frame: " + frame_name);
+			}
+			std::ofstream file(frame_name, std::ios::out | std::ios::binary);
+			file.write(data.data(), data.size());
+			++frames;
+		}
+		if (frames != outputs.size()) {
+			removeOutputs(outputs);
+			throw failedTestException(name, "expected " + std::to_string(outputs.size()) + " frames, got " + std::to_string(frames));
+		}
+		checkOutputs(name, outputs);
+		std::cout << name << " passed\n";
+	}
+}
+
+unit_testing::programOutputTest::programOutputTest(
+	const std::string& name, const std::vector<std::vector<std::string>>& runs, const std::vector<std::string>& expected_lines,
+	const std::vector<expectedOutput>& outputs, const std::vector<std::string>& scratch, const std::vector<std::string>& absent) :
+	test(name), runs(runs), expected_lines(expected_lines), outputs(outputs), scratch(scratch), absent(absent) {}
+
+void unit_testing::programOutputTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	auto clean = [&]() {
+		std::error_code ec;
+		removeOutputs(outputs);
+		for (const std::string& path : scratch) std::filesystem::remove_all(path, ec);
+		for (const std::string& path : absent) std::filesystem::remove_all(path, ec);
+	};
+	clean();
+
+	if (mode == run_mode::debug) {
+		for (const std::vector<std::string>& call_arguments : runs) mesh_compiler::runOnceDebug(call_arguments);
+		clean();
+		return;
+	}
+
+	std::streambuf* oldCoutStreamBuf = std::cout.rdbuf();
+	std::stringstream strCout;
+	for (const std::vector<std::string>& call_arguments : runs) {
+		strCout.str("");
+		std::cout.rdbuf(strCout.rdbuf());
+		mesh_compiler::runOnce(call_arguments);
+		std::cout.rdbuf(oldCoutStreamBuf);
+	}
+
+	const std::string printed = strCout.str();
+	for (const std::string& line : expected_lines) {
+		if (printed.find(line) == std::string::npos) {
+			clean();
+			throw failedTestException(name, "program output lacks: " + line);
+		}
+	}
+	for (const std::string& path : absent) {
+		if (std::filesystem::exists(path)) {
+			clean();
+			throw failedTestException(name, "unexpected file: " + path);
+		}
+	}
+	checkOutputs(name, outputs);
+	clean();
+	std::cout << name << " passed\n";
+}
+
+unit_testing::importerReuseTest::importerReuseTest(
+	const std::string& name, const std::vector<std::string>& call_arguments, const size_t& inputs, const std::vector<expectedOutput>& outputs) :
+	test(name), call_arguments(call_arguments), inputs(inputs), outputs(outputs) {}
+
+void unit_testing::importerReuseTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+	removeOutputs(outputs);
+	if (mode == run_mode::debug) {
+		mesh_compiler::runOnceDebug(call_arguments);
+		removeOutputs(outputs);
+		return;
+	}
+
+	// stats add up over the whole process, only the difference belongs to this run
+	const assimp::importerStats before = assimp::getImporterStats();
+	std::streambuf* oldCoutStreamBuf = std::cout.rdbuf();
+	std::stringstream strCout;
+	std::cout.rdbuf(strCout.rdbuf());
+	mesh_compiler::runOnce(call_arguments);
+	std::cout.rdbuf(oldCoutStreamBuf);
+	const assimp::importerStats after = assimp::getImporterStats();
+
+	checkOutputs(name, outputs);
+	if (after.created - before.created != 1) throw failedTestException(name, "expected one importer, " + std::to_string(after.created - before.created) + " were created");
+	if (after.reused - before.reused != inputs - 1) throw failedTestException(name, "importer was reused " + std::to_string(after.reused - before.reused) + " times");
+	std::cout << name << " passed\n";
+}
+
+unit_testing::perfCountersTest::perfCountersTest(const std::string& name) : test(name) {}
+
+void unit_testing::perfCountersTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	std::string reason;
+	perf_counters::values before, after;
+	if (!perf_counters::enable(reason)) {
+		if (reason.empty()) throw failedTestException(name, "counters are unavailable without a reason");
+		if (perf_counters::read(before)) throw failedTestException(name, "counters were read while unavailable");
+		std::cout << name << " passed (counters unavailable: " << reason << ")\n";
+		return;
+	}
+
+	if (!perf_counters::read(before)) throw failedTestException(name, "enabled counters could not be read");
+	volatile unsigned long long sum = 0;
+	for (unsigned long long i = 0; i < 1000000; ++i) sum = sum + i;
+	if (!perf_counters::read(after)) throw failedTestException(name, "enabled counters could not be read");
+
+	const perf_counters::values counted = after - before;
+	if (counted.v[perf_counters::instructions] < 1000000) throw failedTestException(name, "a million loop iterations counted "
+		+ std::to_string(counted.v[perf_counters::instructions]) + " instructions");
+	std::cout << name << " passed\n";
+}
+
+unit_testing::allocTrackerTest::allocTrackerTest(const std::string& name, const size_t& block_size) : test(name), block_size(block_size) {}
+
+void unit_testing::allocTrackerTest::run(const run_mode& mode)
+{
+	if (mode == run_mode::skip) {
+		std::cout << name << " skipped\n";
+		return;
+	}
+
+	alloc_tracker::enable();
+	const alloc_tracker::usage process_before = alloc_tracker::process();
+	const alloc_tracker::mark outer = alloc_tracker::begin();
+	{
+		std::vector<char> block(block_size, 1);
+		volatile char last = block.back();
+		(void)last;
+	}
+	const alloc_tracker::mark inner = alloc_tracker::begin();
+	const alloc_tracker::usage nothing = alloc_tracker::end(inner);
+	const alloc_tracker::usage measured = alloc_tracker::end(outer);
+	const alloc_tracker::usage process_after = alloc_tracker::process();
+
+	if (measured.allocations < 1 || measured.allocated < block_size) throw failedTestException(name, std::to_string(measured.allocated) + " bytes in "
+		+ std::to_string(measured.allocations) + " allocations measured for a block of " + std::to_string(block_size) + " bytes");
+	if (measured.peak < block_size) throw failedTestException(name, "peak of " + std::to_string(measured.peak) + " bytes is below the block size");
+	if (nothing.allocations != 0 || nothing.peak != 0) throw failedTestException(name, "a measurement after the block was freed counted it");
+	if (process_after.allocated - process_before.allocated < block_size) throw failedTestException(name, "process counters missed the block");
+	std::cout << name << " passed\n";
+}
+
 unit_testing::programRunTest::programRunTest(
 	const std::string& name, const std::vector<std::string>& call_arguments, const std::string& expected_response) :
 	test(name), call_arguments(call_arguments), expected(expected_response) {}
@@ -318,6 +693,244 @@ void unit_testing::run()
 	).run(mode);
 	
 
+	// ========== DECODER TESTS ==========
+
+	meshDecoderTest(
+		"mesh-decoder-test-1-1",
+		"./unit-tests/mesh-compiler/1/test.obj",
+		"./unit-tests/mesh-compiler/1/1.format",
+		{ 5, 5 }
+	).run(mode);
+
+	meshDecoderTest(
+		"mesh-decoder-test-1-2",
+		"./unit-tests/mesh-compiler/1/test.obj",
+		"./unit-tests/mesh-compiler/1/2.format",
+		{ 5, 5 }
+	).run(mode);
+
+	meshDecoderTest(
+		"mesh-decoder-test-1-3",
+		"./unit-tests/mesh-compiler/1/test.obj",
+		"./unit-tests/mesh-compiler/1/3.format",
+		{ 5, 5 }
+	).run(mode);
+
+	// ========== PARALLEL EMISSION TESTS ==========
+
+	emitRangesTest(
+		"emit-ranges-test-1",
+		"./unit-tests/mesh-compiler/2/1.format",
+		100000
+	).run(mode);
+
+	// ========== MEASURE TESTS ==========
+
+	measureTest(
+		"measure-test-1",
+		"./unit-tests/mesh-compiler/2/2.format",
+		100
+	).run(mode);
+
+	// ========== IMPORT SETTINGS TESTS ==========
+
+	const int unread_components = aiComponent_TEXTURES | aiComponent_LIGHTS | aiComponent_CAMERAS | aiComponent_MATERIALS | aiComponent_COLORS | aiComponent_BONEWEIGHTS | aiComponent_ANIMATIONS;
+
+	importSettingsTest(
+		"import-settings-test-1",
+		"./unit-tests/mesh-compiler/1/1.format",
+		"",
+		aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_JoinIdenticalVertices | aiProcess_RemoveComponent,
+		unread_components | aiComponent_TANGENTS_AND_BITANGENTS | aiComponent_TEXCOORDS
+	).run(mode);
+
+	importSettingsTest(
+		"import-settings-test-2",
+		"./unit-tests/mesh-compiler/3/1.format",
+		"",
+		aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_JoinIdenticalVertices | aiProcess_CalcTangentSpace | aiProcess_RemoveComponent,
+		unread_components
+	).run(mode);
+
+	importSettingsTest(
+		"import-settings-test-3",
+		"./unit-tests/mesh-compiler/1/1.format",
+		"-join,+flip_uvs",
+		aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_FlipUVs | aiProcess_RemoveComponent,
+		unread_components | aiComponent_TANGENTS_AND_BITANGENTS | aiComponent_TEXCOORDS
+	).run(mode);
+
+	importSettingsTest(
+		"import-settings-test-4",
+		"./unit-tests/mesh-compiler/1/1.format",
+		"default,-tangents",
+		aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_JoinIdenticalVertices,
+		0
+	).run(mode);
+
+	// ========== MEMORY COMPILE TESTS ==========
+
+	const std::string format_1 = "./unit-tests/program-run/1.format";
+	const std::string quad = "./unit-tests/program-run/models/quad.ply";
+
+	memoryCompileTest(
+		"memory-compile-test-1",
+		quad,
+		"ply",
+		format_1,
+		"memory-quad",
+		{ { "./unit-tests/program-run/memory-quad.mesh", format_1, { 4, 2 } } }
+	).run(mode);
+
+	// ========== STDOUT FRAMES TESTS ==========
+
+	stdoutFramesTest(
+		"stdout-frames-test-1",
+		{ quad, format_1, "--stdout" },
+		{ { "unit-tests/program-run/quad.mesh", format_1, { 4, 2 } } }
+	).run(mode);
+
+	// ========== PROGRAM OUTPUT TESTS ==========
+
+	const std::string format_2 = "./unit-tests/program-run/2.format";
+	const expectedOutput quad_1 = { "./unit-tests/program-run/quad.mesh", format_1, { 4, 2 } };
+	const expectedOutput quad_2 = { "./unit-tests/program-run/quad-2.mesh", format_2, { 2, 4 } };
+	const expectedOutput tri_1 = { "./unit-tests/program-run/tri.mesh", format_1, { 3, 1 } };
+
+	programOutputTest(
+		"program-output-test-1",
+		{ { quad, format_1, "-d" } },
+		{ " s (native reader)" },
+		{ quad_1 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-2",
+		{ { "./unit-tests/program-run/binary/quad.ply", format_1, "--memory-limit", "16", "-d" } },
+		{ "(16 byte chunks)" },
+		{ quad_1 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-3",
+		{ { quad, format_1 }, { "./unit-tests/program-run/quad.mesh", format_2, "--from", format_1 } },
+		{},
+		{ quad_1, quad_2 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-4",
+		{ { quad, format_1 }, { "./unit-tests/program-run/quad.mesh", format_2, "--transcode", format_1, "-d" } },
+		{ "transcode time: " },
+		{ quad_1, quad_2 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-5",
+		{ { "./unit-tests/program-run/manifest.txt", format_1, "--batch", "--jobs", "2" } },
+		{ "batch: compiled 2 out of 2 files" },
+		{ quad_1, tri_1 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-6",
+		{ { "./unit-tests/program-run/models", format_1, "--batch", "--glob", "*.ply", "--pipeline", "1,2,1" } },
+		{ "batch: compiled 2 out of 2 files", "on 1+2+1 pipeline threads" },
+		{ quad_1, tri_1 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-7",
+		{
+			{ "./unit-tests/program-run/models", format_1, "--batch", "--glob", "*.ply", "--shard", "0/2", "--index", "./unit-tests/program-run/0.index" },
+			{ "./unit-tests/program-run/models", format_1, "--batch", "--glob", "*.ply", "--shard", "1/2", "--index", "./unit-tests/program-run/1.index" },
+			{ "--merge", "./unit-tests/program-run/all.index", "./unit-tests/program-run/0.index", "./unit-tests/program-run/1.index" }
+		},
+		{ "merged 2 indexes into ./unit-tests/program-run/all.index: 2 outputs" },
+		{ quad_1, tri_1, { "./unit-tests/program-run/all.index", "", {}, { "quad.ply\tunit-tests/program-run/quad.mesh\n", "tri.ply\tunit-tests/program-run/tri.mesh\n" } } },
+		{ "./unit-tests/program-run/0.index", "./unit-tests/program-run/1.index" }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-8",
+		{ { quad, format_1, "--cache", "./unit-tests/program-run/cache", "-d" }, { quad, format_1, "--cache", "./unit-tests/program-run/cache", "-d" } },
+		{ "cache hit: ", "cache: 1 hits, 0 misses, 0 stores" },
+		{ quad_1 },
+		{ "./unit-tests/program-run/cache" }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-9",
+		{ { quad, format_1, "--scene-cache", "./unit-tests/program-run/scenes", "-d" }, { quad, format_2, "--scene-cache", "./unit-tests/program-run/scenes", "-d" } },
+		{ "(scene cache)" },
+		{ quad_2 },
+		{ "./unit-tests/program-run/scenes", "./unit-tests/program-run/quad.mesh" }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-10",
+		{ { quad, format_1, "-f", format_2, "-d" } },
+		{ "(2 file units)" },
+		{ quad_1, quad_2 }
+	).run(mode);
+
+	importerReuseTest(
+		"importer-reuse-test-1",
+		{ "./unit-tests/program-run/manifest.txt", format_1, "--batch", "--jobs", "1", "--no-native" },
+		2,
+		{ quad_1, tri_1 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-11",
+		{ { quad, format_1, "--profile" } },
+		{ "profile: format parse: 1 calls", "profile: fields: 2 calls", "profile: output unit-tests/program-run/quad.mesh: 84 bytes" },
+		{ quad_1 }
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-12",
+		{ { quad, format_1, "--stats-json", "./unit-tests/program-run/stats.json" } },
+		{},
+		{
+			quad_1,
+			{
+				"./unit-tests/program-run/stats.json", "", {},
+				{ "\"vertices\": 4, \"faces\": 2, \"indices\": 6", "\"per_vertex\": 52", "{ \"path\": \"unit-tests/program-run/quad.mesh\", \"bytes\": 84" }
+			}
+		}
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-13",
+		{ { quad, format_1, "--trace", "./unit-tests/program-run/trace.json" } },
+		{},
+		{
+			quad_1,
+			{
+				"./unit-tests/program-run/trace.json", "", {},
+				{ "\"traceEvents\": [", "\"name\": \"format parse\", \"cat\": \"phase\"", "\"name\": \"write\", \"cat\": \"phase\"", "\"label\": \"unit-tests/program-run/quad.mesh\"" }
+			}
+		}
+	).run(mode);
+
+	programOutputTest(
+		"program-output-test-14",
+		{ { quad, format_1, "--dry-run" } },
+		{ "dry run: unit-tests/program-run/quad.mesh: 84 bytes", "buffer per_vertex: 4 entries of 12 bytes, preamble 4 bytes, 52 bytes", "dry run: 1 outputs, 84 bytes" },
+		{},
+		{},
+		{ quad_1.file }
+	).run(mode);
+
+	// ========== PERF COUNTERS TESTS ==========
+
+	perfCountersTest("perf-counters-test-1").run(mode);
+
+	// ========== ALLOC TRACKER TESTS ==========
+
+	allocTrackerTest("alloc-tracker-test-1", 1 << 20).run(mode);
+
 	// ========== PROGRAM RUN TESTS ==========
 
 	programRunTest(
@@ -352,8 +965,14 @@ void unit_testing::run()
 
 	programRunTest(
 		"program-run-test-6",
-		{ "file.fbx", "f.format", "-f", "f1.format"},
-		"format file specified more than once\n"
+		{ "file.fbx", "f.format", "-f", "f.format"},
+		"format file specified more than once: f.format\n"
+	).run(mode);
+
+	programRunTest(
+		"program-run-test-7",
+		{ "out.mesh", "f.format", "--inspect", "--inspect"},
+		"--inspect flag specified more than once\n"
 	).run(mode);
 
 	std::cout << "ALL TESTS PASSED\n";
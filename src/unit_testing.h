@@ -5,6 +5,7 @@
 #include <iostream>
 #include "meshReader.h"
 #include "meshCompiler.h"
+#include "meshDecoder.h"
 
 class unit_testing
 {
@@ -114,6 +115,115 @@ public:
         void run(const run_mode& mode = run_mode::run) override;
     };
 
+    // file a test expects to find, decoded with format_file when one is given
+    class expectedOutput {
+    public:
+        std::string file;
+        std::string format_file; // empty if the file only has to exist
+        std::vector<size_t> counts; // buffer counts in file order
+        std::vector<std::string> contents; // text the file has to contain, only checked without a format file
+    };
+
+    class meshDecoderTest : public test {
+    public:
+        std::vector<std::string> call_arguments;
+        std::vector<size_t> expected_counts;
+        meshDecoderTest(const std::string& name, const std::string& input_file, const std::string& format_file, const std::vector<size_t>& expected_counts);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // compiles a generated mesh with and without an emission pool, outputs have to be byte identical
+    class emitRangesTest : public test {
+    public:
+        std::string format_file;
+        unsigned int vertex_count;
+        emitRangesTest(const std::string& name, const std::string& format_file, const unsigned int& vertex_count);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // size measure() reports for a generated mesh has to match what put() emits
+    class measureTest : public test {
+    public:
+        std::string format_file;
+        unsigned int vertex_count;
+        measureTest(const std::string& name, const std::string& format_file, const unsigned int& vertex_count);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // import settings a format file derives, with --pp overrides applied on top
+    class importSettingsTest : public test {
+    public:
+        std::string format_file;
+        std::string overrides;
+        unsigned int expected_flags;
+        int expected_removed_components;
+        importSettingsTest(const std::string& name, const std::string& format_file, const std::string& overrides, const unsigned int& expected_flags, const int& expected_removed_components);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // compiles a model file read into memory, source_name replaces {file} in output names
+    class memoryCompileTest : public test {
+    public:
+        std::string input_file;
+        std::string hint;
+        std::string format_file;
+        std::string source_name;
+        std::vector<expectedOutput> outputs;
+        memoryCompileTest(const std::string& name, const std::string& input_file, const std::string& hint, const std::string& format_file, const std::string& source_name, const std::vector<expectedOutput>& outputs);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // runs the program with --stdout, every frame has to name the next expected output and nothing may be written to files,
+    // frames are then saved under their names and checked like outputs
+    class stdoutFramesTest : public test {
+    public:
+        std::vector<std::string> call_arguments;
+        std::vector<expectedOutput> outputs;
+        stdoutFramesTest(const std::string& name, const std::vector<std::string>& call_arguments, const std::vector<expectedOutput>& outputs);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // runs the program once per argument list, what the last run printed has to contain every expected line
+    // and absent paths must not exist afterwards, outputs, scratch and absent paths are removed before and after
+    class programOutputTest : public test {
+    public:
+        std::vector<std::vector<std::string>> runs;
+        std::vector<std::string> expected_lines;
+        std::vector<expectedOutput> outputs;
+        std::vector<std::string> scratch;
+        std::vector<std::string> absent;
+        programOutputTest(const std::string& name, const std::vector<std::vector<std::string>>& runs, const std::vector<std::string>& expected_lines,
+            const std::vector<expectedOutput>& outputs, const std::vector<std::string>& scratch = {}, const std::vector<std::string>& absent = {});
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // a batch imported through assimp on one worker builds one importer and reuses it for every later input
+    class importerReuseTest : public test {
+    public:
+        std::vector<std::string> call_arguments;
+        size_t inputs;
+        std::vector<expectedOutput> outputs;
+        importerReuseTest(const std::string& name, const std::vector<std::string>& call_arguments, const size_t& inputs, const std::vector<expectedOutput>& outputs);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // counters of the calling thread have to count work done between two reads,
+    // where they can not be opened enable() has to give a reason and read() has to fail
+    class perfCountersTest : public test {
+    public:
+        perfCountersTest(const std::string& name);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
+    // a measured block has to show up in the counters of its measurement and of the process,
+    // enables tracking for the rest of the process
+    class allocTrackerTest : public test {
+    public:
+        size_t block_size;
+        allocTrackerTest(const std::string& name, const size_t& block_size);
+        void run(const run_mode& mode = run_mode::run) override;
+    };
+
     class programRunTest : public test {
     public:
         std::vector<std::string> call_arguments;
@@ -122,6 +232,15 @@ public:
         void run(const run_mode& mode = run_mode::run);
     };
 
+    // triangle strip with positions and normals, distinct values everywhere so misplaced data shows up
+    static void fillStrip(aiMesh& mesh, const unsigned int& vertex_count);
+
+    // counts of every buffer in file order, preamble units before the buffers of their unit
+    static std::vector<size_t> bufferCounts(const mesh_decoder::unitRecord& record);
+    // throws failedTestException for the first output that is missing or decodes differently, removes all of them either way
+    static void checkOutputs(const std::string& test_name, const std::vector<expectedOutput>& outputs);
+    static void removeOutputs(const std::vector<expectedOutput>& outputs);
+
     static void run();
 };
 